@@ -5,6 +5,43 @@
 #include <ArduinoJson.h>
 #include <sys/time.h>  // gettimeofday()
 
+// Compile-time signal switches. Setting one to 0 removes that signal's
+// serialisation and send code; pair with the OTEL_LOG_* / OTEL_SPAN /
+// OTEL_METRIC_* macros so call sites disappear too.
+#ifndef OTEL_ENABLE_TRACES
+#define OTEL_ENABLE_TRACES 1
+#endif
+#ifndef OTEL_ENABLE_LOGS
+#define OTEL_ENABLE_LOGS 1
+#endif
+#ifndef OTEL_ENABLE_METRICS
+#define OTEL_ENABLE_METRICS 1
+#endif
+
+// Code that an interrupt handler may reach (flash can be unavailable on ESP)
+#if defined(ESP32) || defined(ESP8266)
+  #define OTEL_ISR_ATTR IRAM_ATTR
+#else
+  #define OTEL_ISR_ATTR
+#endif
+
+// OTel SDK limits (named after the spec's environment variables). Longer
+// string values are truncated and attributes/events past the count are
+// dropped (and reported as dropped*Count), keeping each record bounded.
+#ifndef OTEL_ATTRIBUTE_VALUE_LENGTH_LIMIT
+#define OTEL_ATTRIBUTE_VALUE_LENGTH_LIMIT 256
+#endif
+#ifndef OTEL_ATTRIBUTE_COUNT_LIMIT
+#define OTEL_ATTRIBUTE_COUNT_LIMIT 32
+#endif
+#ifndef OTEL_SPAN_EVENT_COUNT_LIMIT
+#define OTEL_SPAN_EVENT_COUNT_LIMIT 16
+#endif
+// Not a spec limit: log bodies are strings too and get the same treatment
+#ifndef OTEL_LOG_BODY_LENGTH_LIMIT
+#define OTEL_LOG_BODY_LENGTH_LIMIT 1024
+#endif
+
 // This header provides:
 //  - Time helpers (nowUnixNano/Millis)
 //  - OTLP JSON KeyValue serializers (string/double/int) using ArduinoJson v7 APIs
@@ -49,6 +86,28 @@ inline String u64ToString(uint64_t v) {
   return String(p);
 }
 
+/** Truncate to at most maxBytes without splitting a UTF-8 sequence. */
+inline void truncateUtf8(String& s, size_t maxBytes) {
+  if (s.length() <= maxBytes) return;
+  size_t n = maxBytes;
+  while (n > 0 && (static_cast<uint8_t>(s[n]) & 0xC0) == 0x80) --n;
+  s.remove(n);
+}
+
+/**
+ * Assign a string to a JSON slot (e.g. obj["stringValue"]), truncated to
+ * maxBytes. Copies only when truncation is needed. Takes the proxy by value so
+ * the member is created on assignment.
+ */
+template <typename Slot>
+inline void setLimitedString(Slot dst, const String& value,
+                             size_t maxBytes = OTEL_ATTRIBUTE_VALUE_LENGTH_LIMIT) {
+  if (value.length() <= maxBytes) { dst = value; return; }
+  String cut = value;
+  truncateUtf8(cut, maxBytes);
+  dst = cut;
+}
+
 // -------------------------------------------------------------------------------------------------
 // OTLP JSON KeyValue helpers (ArduinoJson v7 deprecation-safe)
 // -------------------------------------------------------------------------------------------------
@@ -138,7 +197,7 @@ struct OTelResourceConfig {
 // -------------------------------------------------------------------------------------------------
 
 /** Default resource for general use (metrics/logs/etc.) */
-static inline OTelResourceConfig& defaultResource() {
+inline OTelResourceConfig& defaultResource() {
   static OTelResourceConfig rc;
   return rc;
 }
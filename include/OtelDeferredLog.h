@@ -0,0 +1,160 @@
+// OtelDeferredLog.h
+#ifndef OTEL_DEFERRED_LOG_H
+#define OTEL_DEFERRED_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "OtelTracer.h"     // provides: currentTraceContext()
+
+// Deferred (binary) logging: the control path only records a pointer to the
+// format string plus the raw argument bytes into a fixed ring; formatting and
+// OTLP serialisation happen later on the sender worker.
+
+// Number of records the ring can hold before new records are dropped.
+#ifndef OTEL_DEFERRED_LOG_CAPACITY
+#define OTEL_DEFERRED_LOG_CAPACITY 16
+#endif
+
+// Bytes of encoded arguments per record (tag + value; strings are copied inline).
+#ifndef OTEL_DEFERRED_LOG_ARG_BYTES
+#define OTEL_DEFERRED_LOG_ARG_BYTES 48
+#endif
+
+// Largest formatted message produced on the worker (longer output is truncated).
+#ifndef OTEL_DEFERRED_LOG_MSG_MAX
+#define OTEL_DEFERRED_LOG_MSG_MAX 192
+#endif
+
+namespace OTel {
+
+// Argument type tags stored in front of each encoded value
+enum class DeferredArg : uint8_t { I32, U32, I64, U64, F64, Str, Ptr };
+
+struct DeferredLogRecord {
+  const char* severity = nullptr;  // static severity text ("INFO", ...)
+  const char* fmt      = nullptr;  // must point at static storage (string literal)
+  uint32_t    capturedUs = 0;      // micros() at capture; converted to wall time on drain
+  char        traceId[33] = {0};   // active span at capture time (empty if none)
+  char        spanId[17]  = {0};
+  uint8_t     argLen    = 0;
+  bool        truncated = false;   // ran out of argument space while capturing
+  uint8_t     args[OTEL_DEFERRED_LOG_ARG_BYTES];
+};
+
+// Bounded writer used while capturing arguments; never allocates.
+class DeferredArgWriter {
+public:
+  explicit DeferredArgWriter(DeferredLogRecord& r) : r_(r) {}
+
+  void put(bool v)               { putInt(v ? 1 : 0); }
+  void put(char v)               { putInt(v); }
+  void put(signed char v)        { putInt(v); }
+  void put(unsigned char v)      { putUInt(v); }
+  void put(short v)              { putInt(v); }
+  void put(unsigned short v)     { putUInt(v); }
+  void put(int v)                { putInt(v); }
+  void put(unsigned int v)       { putUInt(v); }
+  void put(long v)               { putInt(v); }
+  void put(unsigned long v)      { putUInt(v); }
+  void put(long long v)          { putInt(v); }
+  void put(unsigned long long v) { putUInt(v); }
+  void put(float v)              { putRaw(DeferredArg::F64, (double)v); }
+  void put(double v)             { putRaw(DeferredArg::F64, v); }
+  void put(const String& v)      { putStr(v.c_str(), v.length()); }
+  void put(const char* v)        { putStr(v ? v : "(null)", v ? strlen(v) : 6); }
+  void put(char* v)              { put(static_cast<const char*>(v)); }
+  template <typename T>
+  void put(const T* v)           { putRaw(DeferredArg::Ptr, (uint64_t)(uintptr_t)v); }
+
+private:
+  // Integers take the narrowest slot that holds the value
+  void putInt(int64_t v) {
+    if (v >= INT32_MIN && v <= INT32_MAX) putRaw(DeferredArg::I32, (int32_t)v);
+    else                                  putRaw(DeferredArg::I64, v);
+  }
+  void putUInt(uint64_t v) {
+    if (v <= UINT32_MAX) putRaw(DeferredArg::U32, (uint32_t)v);
+    else                 putRaw(DeferredArg::U64, v);
+  }
+
+  template <typename T>
+  void putRaw(DeferredArg tag, T v) {
+    if (r_.truncated || (size_t)r_.argLen + 1 + sizeof(T) > sizeof(r_.args)) { r_.truncated = true; return; }
+    r_.args[r_.argLen++] = (uint8_t)tag;
+    memcpy(&r_.args[r_.argLen], &v, sizeof(T));
+    r_.argLen += sizeof(T);
+  }
+
+  // Strings are copied (length-prefixed) so non-literal buffers stay valid;
+  // they are cut to whatever space remains in the record.
+  void putStr(const char* s, size_t n) {
+    if (r_.truncated || (size_t)r_.argLen + 2 > sizeof(r_.args)) { r_.truncated = true; return; }
+    size_t room = sizeof(r_.args) - r_.argLen - 2;
+    if (n > room) n = room;
+    if (n > 255)  n = 255;
+    r_.args[r_.argLen++] = (uint8_t)DeferredArg::Str;
+    r_.args[r_.argLen++] = (uint8_t)n;
+    memcpy(&r_.args[r_.argLen], s, n);
+    r_.argLen += n;
+  }
+
+  DeferredLogRecord& r_;
+};
+
+// Render a captured record's format + arguments into `out` (always NUL-terminated).
+// Returns the number of characters written.
+size_t formatDeferred(char* out, size_t cap, const DeferredLogRecord& rec);
+
+class DeferredLog {
+public:
+  // Control path: single producer (the core/task that runs loop()). Returns false
+  // and counts a drop if the ring is full; never blocks and never allocates.
+  template <typename... Args>
+  static bool capture(const char* severity, const char* fmt, const Args&... args) {
+    size_t h = head_.load(std::memory_order_relaxed);
+    size_t next = (h + 1) % QCAP;
+    if (next == tail_.load(std::memory_order_acquire)) {
+      drops_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    DeferredLogRecord& r = ring_[h];
+    r.severity   = severity;
+    r.fmt        = fmt;
+    r.capturedUs = (uint32_t)micros();
+    r.argLen     = 0;
+    r.truncated  = false;
+
+    const TraceContext& ctx = currentTraceContext();
+    if (ctx.valid()) {
+      memcpy(r.traceId, ctx.traceId.c_str(), 33);
+      memcpy(r.spanId,  ctx.spanId.c_str(),  17);
+    } else {
+      r.traceId[0] = r.spanId[0] = '\0';
+    }
+
+    DeferredArgWriter w(r);
+    int expand[] = {0, (w.put(args), 0)...};
+    (void)expand;
+
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Worker side: single consumer. Copies the oldest record out of the ring.
+  static bool pop(DeferredLogRecord& out);
+
+  static size_t   pending();
+  static uint32_t droppedCount();
+
+private:
+  static constexpr size_t QCAP = OTEL_DEFERRED_LOG_CAPACITY;
+  static DeferredLogRecord ring_[QCAP];
+  static std::atomic<size_t>   head_;
+  static std::atomic<size_t>   tail_;
+  static std::atomic<uint32_t> drops_;
+};
+
+} // namespace OTel
+
+#endif // OTEL_DEFERRED_LOG_H
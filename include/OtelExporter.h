@@ -0,0 +1,317 @@
+// OtelExporter.h
+#ifndef OTEL_EXPORTER_H
+#define OTEL_EXPORTER_H
+
+#include <Arduino.h>
+#include <vector>
+#include <atomic>
+#include <initializer_list>
+#include "OtelSender.h"     // OTelSignal, OTEL_COLLECTOR_BASE_URL
+#include "OtelMutex.h"
+
+// Members of one FailoverExporter / FanoutExporter
+#ifndef OTEL_MAX_ENDPOINTS
+#define OTEL_MAX_ENDPOINTS 4
+#endif
+
+// How long a FailoverExporter skips an endpoint after a transport failure
+// before probing it again
+#ifndef OTEL_FAILOVER_REPROBE_MS
+#define OTEL_FAILOVER_REPROBE_MS 30000
+#endif
+
+// Stream requests to plain http:// collectors straight from the encoder into
+// the socket instead of building the whole payload in RAM first
+#ifndef OTEL_HTTP_STREAMING
+#define OTEL_HTTP_STREAMING 1
+#endif
+// Bytes buffered between the encoder and the socket (one chunk)
+#ifndef OTEL_STREAM_CHUNK_BYTES
+#define OTEL_STREAM_CHUNK_BYTES 512
+#endif
+// How long a streaming POST waits for the collector's response
+#ifndef OTEL_HTTP_TIMEOUT_MS
+#define OTEL_HTTP_TIMEOUT_MS 5000
+#endif
+
+// Largest datagram UdpExporter sends: a 1500-byte Ethernet/Wi-Fi MTU minus the
+// IP and UDP headers, so records are never fragmented
+#ifndef OTEL_UDP_MAX_DATAGRAM
+#define OTEL_UDP_MAX_DATAGRAM 1472
+#endif
+
+namespace fs { class FS; }  // <FS.h>: SPIFFS / LittleFS / SD on every supported core
+class WiFiUDP;              // <WiFiUdp.h>
+class WiFiClient;           // <WiFi.h>
+
+namespace OTel {
+
+enum class ExportResult : uint8_t {
+  Success,
+  RetryableFailure,  // transport error or throttling: the sender retries with backoff
+  Failure            // rejected: counted in OTelSender::exportFailures() and dropped
+};
+
+// A request body that is written on demand (and can be written again for a
+// retry or another endpoint) instead of being held as one String
+class PayloadSource {
+public:
+  virtual ~PayloadSource() {}
+  virtual size_t size() const = 0;             // exact byte count; 0 = unknown
+  virtual void   writeTo(Print& out) const = 0;
+};
+
+// Where encoded OTLP requests go. The sender worker calls exportRequest() once
+// per (batched) request, never concurrently with itself. Select one per signal
+// with OTelSender::setExporter(); the exporter must outlive its use.
+class Exporter {
+public:
+  virtual ~Exporter() {}
+
+  // `path` is the OTLP/HTTP path of the signal ("/v1/traces", ...); `payload`
+  // is one complete OTLP/JSON request
+  virtual ExportResult exportRequest(OTelSignal signal, const char* path,
+                                     const String& payload) = 0;
+
+  // True when exportStream() writes the source straight to its transport. The
+  // sender then never builds the full request; otherwise it materialises the
+  // request once (in a reused buffer) and calls exportRequest().
+  virtual bool streams() const { return false; }
+
+  // Default: collect the source into a String and call exportRequest()
+  virtual ExportResult exportStream(OTelSignal signal, const char* path,
+                                    const PayloadSource& source);
+};
+
+// OTLP/HTTP to a collector (the default for every signal)
+class HttpExporter : public Exporter {
+public:
+  explicit HttpExporter(const char* baseUrl = OTEL_COLLECTOR_BASE_URL);
+
+  ExportResult exportRequest(OTelSignal signal, const char* path,
+                             const String& payload) override;
+
+  // http:// base URLs (with OTEL_HTTP_STREAMING): the body goes to the socket
+  // through an OTEL_STREAM_CHUNK_BYTES buffer, with Content-Length when the
+  // size is known and Transfer-Encoding: chunked otherwise. The connection is
+  // kept alive between requests. https:// uses HTTPClient with a materialised
+  // payload.
+  bool streams() const override { return OTEL_HTTP_STREAMING && port_ != 0; }
+  ExportResult exportStream(OTelSignal signal, const char* path,
+                            const PayloadSource& source) override;
+
+  ~HttpExporter();
+
+  void  setBaseUrl(const char* baseUrl);
+  int   lastStatus() const { return lastStatus_; } // HTTP status, or <= 0 on transport errors
+  uint32_t connects() const { return connects_; }  // connections opened by the streaming path
+
+private:
+  // post() result when the request could not be written: nothing reached the
+  // collector, so it is safe to send again
+  static constexpr int kNotSent = -2;
+
+  String url(const char* path) const;
+  int    post(const char* path, const PayloadSource& source);
+  static ExportResult classify(int code);
+
+  String      base_;
+  String      host_;        // parsed from an http:// base URL (port_ 0 otherwise)
+  String      prefix_;      // path part of the base URL, without trailing slash
+  uint16_t    port_       = 0;
+  int         lastStatus_ = 0;
+  WiFiClient* client_     = nullptr;   // kept-alive streaming connection
+  uint32_t    connects_   = 0;
+};
+
+// Appends every request to a file, opened in append mode per request so a
+// reset loses at most the request being written
+class FileExporter : public Exporter {
+public:
+  enum class Format : uint8_t {
+    JsonLines,        // one request per line
+    LengthDelimited   // varint byte length, then the request (protobuf-style framing)
+  };
+
+  FileExporter(fs::FS& fs, const char* path, Format format = Format::JsonLines)
+  : fs_(fs), path_(path), format_(format) {}
+
+  ExportResult exportRequest(OTelSignal signal, const char* path,
+                             const String& payload) override;
+
+private:
+  fs::FS&     fs_;
+  const char* path_;
+  Format      format_;
+};
+
+// Prints each request as one JSON line, e.g. to Serial for a host-side parser
+class SerialExporter : public Exporter {
+public:
+  explicit SerialExporter(Print& out = Serial) : out_(out) {}
+
+  ExportResult exportRequest(OTelSignal signal, const char* path,
+                             const String& payload) override;
+
+private:
+  Print& out_;
+};
+
+// Keeps the most recent requests in RAM for tests; with maxRequests = 0 it only
+// counts them, which isolates encoding cost from any transport
+class MemoryExporter : public Exporter {
+public:
+  struct Request {
+    OTelSignal  signal = OTelSignal::Traces;
+    const char* path   = nullptr;
+    String      payload;
+  };
+
+  explicit MemoryExporter(size_t maxRequests = 16) : max_(maxRequests) {}
+
+  ExportResult exportRequest(OTelSignal signal, const char* path,
+                             const String& payload) override;
+
+  // Returned for every request (e.g. RetryableFailure to exercise retries)
+  void setResult(ExportResult result) { result_ = result; }
+
+  size_t   size();
+  Request  at(size_t i);   // copy (empty when out of range); the worker may append concurrently
+  void     clear();
+  uint32_t requests() const { return requests_.load(std::memory_order_relaxed); }
+  uint32_t bytes()    const { return bytes_.load(std::memory_order_relaxed); }
+
+private:
+  Mutex                m_;
+  std::vector<Request> captured_;
+  size_t               max_;
+  ExportResult         result_   = ExportResult::Success;
+  std::atomic<uint32_t> requests_{0};
+  std::atomic<uint32_t> bytes_{0};
+};
+
+// Relay transports. Both use the framing that scripts/otlp_relay.py expects:
+//
+//   u32 big-endian length N | u8 OTelSignal | N - 1 bytes of OTLP/JSON request
+//
+// The relay forwards each frame to a normal collector over OTLP/HTTP.
+
+// One record per datagram, fire-and-forget. A batched request is split back
+// into single-record requests so each fits in maxDatagram; a record that does
+// not is dropped and counted in oversize(), and the request still succeeds if
+// its other records were sent.
+class UdpExporter : public Exporter {
+public:
+  UdpExporter(const char* host, uint16_t port, size_t maxDatagram = OTEL_UDP_MAX_DATAGRAM)
+  : host_(host), port_(port), max_(maxDatagram) {}
+  ~UdpExporter();
+
+  ExportResult exportRequest(OTelSignal signal, const char* path,
+                             const String& payload) override;
+
+  uint32_t datagrams() const { return datagrams_; }
+  uint32_t oversize()  const { return oversize_; }
+
+private:
+  bool sendFrame(OTelSignal signal, const char* prefix, size_t prefixLen,
+                 const char* body, size_t bodyLen, const char* suffix, size_t suffixLen);
+
+  const char* host_;
+  uint16_t    port_;
+  size_t      max_;
+  WiFiUDP*    udp_       = nullptr;  // created on the worker at first use
+  uint32_t    datagrams_ = 0;
+  uint32_t    oversize_  = 0;
+};
+
+// One frame per request over a persistent TCP connection, reconnecting when it
+// drops. A failed write closes the connection and is retried by the sender.
+class TcpExporter : public Exporter {
+public:
+  TcpExporter(const char* host, uint16_t port) : host_(host), port_(port) {}
+  ~TcpExporter();
+
+  ExportResult exportRequest(OTelSignal signal, const char* path,
+                             const String& payload) override;
+
+  uint32_t connects() const { return connects_; }
+
+private:
+  const char* host_;
+  uint16_t    port_;
+  WiFiClient* client_   = nullptr;   // created on the worker at first use
+  uint32_t    connects_ = 0;
+};
+
+// Delivery record of one member of a composite exporter
+struct EndpointHealth {
+  uint32_t successes           = 0;
+  uint32_t failures            = 0;
+  uint32_t consecutiveFailures = 0;
+  uint32_t lastFailureMs       = 0;  // Scheduler::now() of the last failure
+  bool     healthy             = true;
+
+  void record(ExportResult result, uint32_t nowMs);
+};
+
+// Sends to the first healthy endpoint in order. A transport failure moves to
+// the next one; the failed endpoint is skipped for reprobeMs and then probed
+// again with the next request. Rejections (ExportResult::Failure) are about the
+// data, not the endpoint, and do not fail over. Switching happens on the worker
+// between requests, so producers never wait for it.
+class FailoverExporter : public Exporter {
+public:
+  FailoverExporter(std::initializer_list<Exporter*> endpoints,
+                   uint32_t reprobeMs = OTEL_FAILOVER_REPROBE_MS);
+
+  ExportResult exportRequest(OTelSignal signal, const char* path,
+                             const String& payload) override;
+  bool streams() const override;   // every endpoint streams
+  ExportResult exportStream(OTelSignal signal, const char* path,
+                            const PayloadSource& source) override;
+
+  size_t size()   const { return count_; }
+  size_t active() const { return active_; }   // endpoint that took the last request
+  const EndpointHealth& health(size_t i) const { return health_[i % OTEL_MAX_ENDPOINTS]; }
+
+private:
+  // Shared by exportRequest/exportStream: `send(i)` exports to endpoint i
+  template <typename Send> ExportResult run(Send send);
+  // Endpoint i failed in transport less than reprobeMs ago
+  bool backingOff(size_t i, uint32_t now) const;
+
+  Exporter*      endpoints_[OTEL_MAX_ENDPOINTS] = {};
+  EndpointHealth health_[OTEL_MAX_ENDPOINTS];
+  size_t         count_  = 0;
+  size_t         active_ = 0;
+  uint32_t       reprobeMs_;
+};
+
+// Sends every request to all endpoints (e.g. metrics to two backends), reusing
+// the one encoded payload. Succeeds when at least one endpoint accepted it and
+// is retried only when every endpoint failed retryably, so a retry never
+// duplicates data at a backend that already has it.
+class FanoutExporter : public Exporter {
+public:
+  FanoutExporter(std::initializer_list<Exporter*> endpoints);
+
+  ExportResult exportRequest(OTelSignal signal, const char* path,
+                             const String& payload) override;
+  bool streams() const override;   // every endpoint streams
+  ExportResult exportStream(OTelSignal signal, const char* path,
+                            const PayloadSource& source) override;
+
+  size_t size() const { return count_; }
+  const EndpointHealth& health(size_t i) const { return health_[i % OTEL_MAX_ENDPOINTS]; }
+
+private:
+  template <typename Send> ExportResult run(Send send);
+
+  Exporter*      endpoints_[OTEL_MAX_ENDPOINTS] = {};
+  EndpointHealth health_[OTEL_MAX_ENDPOINTS];
+  size_t         count_ = 0;
+};
+
+} // namespace OTel
+
+#endif // OTEL_EXPORTER_H
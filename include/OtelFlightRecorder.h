@@ -0,0 +1,98 @@
+// OtelFlightRecorder.h
+#ifndef OTEL_FLIGHT_RECORDER_H
+#define OTEL_FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+#include <map>
+
+// Bytes of the flight recorder ring (0 compiles it out). Ended spans and log
+// records are copied into it in binary form and only exported when a dump is
+// triggered.
+#ifndef OTEL_FLIGHT_RECORDER_BYTES
+#define OTEL_FLIGHT_RECORDER_BYTES 0
+#endif
+
+// Shortest time between two dumps triggered by ERROR logs
+#ifndef OTEL_FLIGHT_RECORDER_COOLDOWN_MS
+#define OTEL_FLIGHT_RECORDER_COOLDOWN_MS 30000
+#endif
+
+namespace OTel {
+
+// What caused a dump; exported as the flight_recorder.trigger scope attribute
+enum class FlightTrigger : uint8_t {
+  Manual,    // trigger() / dump()
+  ErrorLog,  // a record at ERROR or above
+  Reset      // the window survived a crash reset (ESP32, RP2040)
+};
+
+// Always-on ring of the last spans and logs, kept as binary records:
+//   [u16 payload bytes][u8 kind][payload]
+// Strings are [u16 length][bytes]; integers are little-endian as in memory.
+// Span:  traceId[16] spanId[8] parentSpanId[8] (zeros = root) startNs endNs
+//        u8 status, name, status message, attributes, u8 events,
+//        each event: timeNs, name, attributes
+// Log:   traceId[16] spanId[8] (zeros = none) timeNs u8 severityNumber
+//        severityText, body, u8 labels, each label: key, value
+// Attributes are u8 count, each: u8 type, key, value (string, 8-byte int or
+// double, or u8 bool).
+class FlightRecorder {
+public:
+  enum : uint8_t { kSpan = 1, kLog = 2 };
+  enum : uint8_t { kAttrStr = 0, kAttrInt = 1, kAttrDbl = 2, kAttrBool = 3 };
+
+  // Start recording; call once in setup() after the exporter is configured.
+  // If the last reset was a crash and the window survived it in no-init RAM
+  // (ESP32, RP2040), that window is exported first. Returns false, and does not
+  // record, if compiled out or if no worker/flush hook slot was free.
+  static bool begin();
+  static bool enabled() { return OTEL_FLIGHT_RECORDER_BYTES != 0 && active(); }
+
+  // Export the window on the worker (or at the next OTelSender::service())
+  static void trigger(FlightTrigger why = FlightTrigger::Manual);
+
+  // Export the window now, on the calling thread, and empty it. Returns the
+  // number of records exported.
+  static size_t dump(FlightTrigger why = FlightTrigger::Manual);
+
+  static void recordLog(int severityNumber, const char* severity, const String& body,
+                        const std::map<String, String>& labels, uint64_t timeUnixNano,
+                        const char* traceId, const char* spanId);
+
+  static size_t   usedBytes();
+  static uint32_t droppedCount();  // records larger than the whole ring
+
+  // Appends one record, holding the recorder lock until it is destroyed.
+  // Size the payload exactly; the oldest records are evicted to make room.
+  class Record {
+  public:
+    Record(uint8_t kind, size_t payloadBytes);
+    ~Record();
+    Record(const Record&) = delete;
+    Record& operator=(const Record&) = delete;
+
+    explicit operator bool() const { return ok_; }
+
+    void put(const void* data, size_t n);
+    void putU8(uint8_t v)   { put(&v, 1); }
+    void putU64(uint64_t v) { put(&v, 8); }
+    void putStr(const char* s, size_t n);
+    void putStr(const String& s) { putStr(s.c_str(), s.length()); }
+    void putHexId(const char* hex, size_t bytes);  // zeros unless exactly 2*bytes hex chars
+
+    static size_t strBytes(size_t n) { return 2 + (n > 0xFFFF ? 0xFFFF : n); }
+
+  private:
+    uint32_t at_    = 0;  // next write offset in the ring
+    uint32_t total_ = 0;  // header + payload
+    size_t   left_  = 0;  // payload bytes not yet written
+    bool     ok_    = false;
+  };
+
+private:
+  static bool active();
+};
+
+} // namespace OTel
+
+#endif // OTEL_FLIGHT_RECORDER_H
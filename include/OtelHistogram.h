@@ -0,0 +1,79 @@
+// OtelHistogram.h
+#ifndef OTEL_HISTOGRAM_H
+#define OTEL_HISTOGRAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Buckets per sign (positive and negative values each get this many). The
+// scale drops automatically until the recorded range fits.
+#ifndef OTEL_EXPO_HISTOGRAM_MAX_BUCKETS
+#define OTEL_EXPO_HISTOGRAM_MAX_BUCKETS 64
+#endif
+
+// Starting (finest) scale; the spec's maximum is 20
+#ifndef OTEL_EXPO_HISTOGRAM_MAX_SCALE
+#define OTEL_EXPO_HISTOGRAM_MAX_SCALE 20
+#endif
+
+namespace OTel {
+
+// Base-2 exponential histogram (OTLP ExponentialHistogramDataPoint). Bucket i
+// at scale s holds values in (2^(i/2^s), 2^((i+1)/2^s)]. Indices come from the
+// IEEE-754 exponent and mantissa bits: no log(), so recording stays cheap on
+// cores without an FPU. Not thread-safe: keep one instance per core/thread and
+// merge() them when exporting.
+class ExponentialHistogram {
+public:
+  static constexpr int kMinScale = -10;
+
+  // Contiguous counts starting at bucket index `offset`
+  struct Buckets {
+    int32_t  offset = 0;
+    uint16_t size   = 0;
+    uint32_t counts[OTEL_EXPO_HISTOGRAM_MAX_BUCKETS] = {};
+
+    uint32_t at(size_t i) const { return counts[i]; }
+  };
+
+  // NaN and infinities are ignored
+  void record(double value);
+
+  // Add `other`'s measurements; both end up at the coarser of the two scales
+  // (or coarser still if the combined range needs it)
+  void merge(const ExponentialHistogram& other);
+
+  void reset();
+
+  int      scale()     const { return scale_; }
+  uint64_t count()     const { return count_; }
+  uint64_t zeroCount() const { return zero_; }
+  double   sum()       const { return sum_; }
+  double   min()       const { return min_; }   // valid when count() > 0
+  double   max()       const { return max_; }
+  const Buckets& positive() const { return pos_; }
+  const Buckets& negative() const { return neg_; }
+
+  // Bucket index of |value| (> 0, finite) at `scale`
+  static int32_t indexOf(double value, int scale);
+
+private:
+  // Scale reduction needed for buckets [lo, hi] to fit next to `b`'s
+  static int  changeFor(const Buckets& b, int32_t lo, int32_t hi, int change);
+  void        downscale(int change);
+  static void downscale(Buckets& b, int change);
+  static void add(Buckets& b, int32_t index, uint32_t n);
+
+  int      scale_ = OTEL_EXPO_HISTOGRAM_MAX_SCALE;
+  uint64_t count_ = 0;
+  uint64_t zero_  = 0;
+  double   sum_   = 0;
+  double   min_   = 0;
+  double   max_   = 0;
+  Buckets  pos_;
+  Buckets  neg_;
+};
+
+} // namespace OTel
+
+#endif // OTEL_HISTOGRAM_H
@@ -0,0 +1,128 @@
+// OtelIsrEvents.h
+#ifndef OTEL_ISR_EVENTS_H
+#define OTEL_ISR_EVENTS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "OtelTracer.h"       // readActiveIds(), Span
+#include "OtelLogger.h"       // Severity
+#include "OtelIsrMetrics.h"   // detail::inInterrupt()
+
+// Events each IsrEventSource buffers until they are drained; more are dropped
+#ifndef OTEL_ISR_EVENT_CAPACITY
+#define OTEL_ISR_EVENT_CAPACITY 16
+#endif
+
+// Numeric fields an event can carry
+#ifndef OTEL_ISR_EVENT_FIELDS
+#define OTEL_ISR_EVENT_FIELDS 4
+#endif
+
+namespace OTel {
+
+// One event as captured: a few dozen bytes, no Strings
+struct IsrEvent {
+  const char* name       = nullptr;  // static string
+  uint32_t    capturedUs = 0;        // micros() at capture; wall time on drain
+  bool        hasContext = false;    // a span was active
+  uint8_t     nFields    = 0;
+  uint8_t     traceId[16] = {};
+  uint8_t     spanId[8]   = {};
+  int32_t     fields[OTEL_ISR_EVENT_FIELDS] = {};
+};
+
+// Where the events of a source end up
+enum class IsrEventTarget : uint8_t {
+  Log,        // log records, sent by the worker
+  SpanEvents  // events of a span, via drainInto(span) on the span's thread
+};
+
+// Wait-free single-producer ring for one interrupt handler (or one task):
+//   OTel::IsrEventSource g_limits("limit-switch");
+//   void IRAM_ATTR onLimit() { g_limits.record("limit.hit", axis, position); }
+// Each source must have exactly one writer; give every ISR its own source.
+// Events carry the trace and span that were active when they were recorded.
+// record() and push() are OTEL_ISR_ATTR, so they also work in ISRs registered
+// with ESP_INTR_FLAG_IRAM while the flash cache is disabled.
+class IsrEventSource {
+public:
+  // `fieldNames` (optional, static) name the numeric fields in order;
+  // otherwise they are "value", "value1", "value2", ...
+  constexpr explicit IsrEventSource(const char* source,
+                                    IsrEventTarget target = IsrEventTarget::Log,
+                                    Severity severity = Severity::Info,
+                                    const char* const* fieldNames = nullptr)
+  : source_(source), fieldNames_(fieldNames), target_(target), severity_(severity) {}
+
+  IsrEventSource(const IsrEventSource&) = delete;
+  IsrEventSource& operator=(const IsrEventSource&) = delete;
+
+  // `name` must be a string literal. False when the ring is full.
+  template <typename... V>
+  OTEL_ISR_ATTR bool record(const char* name, V... values) {
+    static_assert(sizeof...(V) <= OTEL_ISR_EVENT_FIELDS, "raise OTEL_ISR_EVENT_FIELDS");
+    const int32_t fields[] = { (int32_t)values..., 0 };
+    return push(name, fields, (uint8_t)sizeof...(V));
+  }
+
+  OTEL_ISR_ATTR bool push(const char* name, const int32_t* fields, uint8_t nFields) {
+    if (!OTEL_ENABLE_LOGS && !OTEL_ENABLE_TRACES) return false;
+    if (state_.load(std::memory_order_acquire) != kLinked) link();
+    const uint16_t h    = head_.load(std::memory_order_relaxed);
+    const uint16_t next = (uint16_t)((h + 1) % kSlots);
+    if (next == tail_.load(std::memory_order_acquire)) {
+      drops_.store(drops_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    IsrEvent& e  = ring_[h];
+    e.name       = name;
+    e.capturedUs = (uint32_t)micros();
+    e.hasContext = readActiveIds(e.traceId, e.spanId);
+    e.nFields    = nFields;
+    for (uint8_t i = 0; i < nFields; ++i) e.fields[i] = fields[i];
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Log sources are drained by the worker (or
+  // OTelSender::service()); drain SpanEvents sources into a span yourself.
+  // Each returns the number of events taken.
+  size_t drainToLogs(size_t max = OTEL_ISR_EVENT_CAPACITY);
+  size_t drainInto(Span& span, size_t max = OTEL_ISR_EVENT_CAPACITY);
+
+  size_t   pending() const;
+  uint32_t droppedCount() const { return drops_.load(std::memory_order_relaxed); }
+
+  const char*     source() const { return source_; }
+  IsrEventTarget  target() const { return target_; }
+  IsrEventSource* next()   const { return next_; }
+  static IsrEventSource* first();
+
+private:
+  enum : uint8_t { kUnlinked, kLinking, kLinked };
+  static constexpr uint16_t kSlots = OTEL_ISR_EVENT_CAPACITY + 1;  // one slot stays empty
+
+  void   link();
+  bool   pop(IsrEvent& out);
+  String fieldName(uint8_t i) const;
+
+  const char*            source_;
+  const char* const*     fieldNames_;
+  IsrEventTarget         target_;
+  Severity               severity_;
+  IsrEventSource*        next_ = nullptr;
+  std::atomic<uint8_t>   state_{kUnlinked};
+  std::atomic<uint16_t>  head_{0};
+  std::atomic<uint16_t>  tail_{0};
+  std::atomic<uint32_t>  drops_{0};
+  IsrEvent               ring_[kSlots];
+};
+
+// Drain Log sources on the worker. Sources call this themselves on first use
+// outside an ISR; call it from setup() when one may first record inside an
+// interrupt handler.
+void enableIsrEventDrain();
+
+} // namespace OTel
+
+#endif // OTEL_ISR_EVENTS_H
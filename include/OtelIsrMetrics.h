@@ -0,0 +1,157 @@
+// OtelIsrMetrics.h
+#ifndef OTEL_ISR_METRICS_H
+#define OTEL_ISR_METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "OtelDefaults.h"   // OTEL_ENABLE_METRICS, OTEL_ISR_ATTR
+#include "OtelProfile.h"    // ProfileIrqGuard, profileCore(), OTEL_PROFILE_CORES
+
+// Most explicit bounds an IsrHistogram takes (it has one bucket more)
+#ifndef OTEL_ISR_HISTOGRAM_MAX_BOUNDS
+#define OTEL_ISR_HISTOGRAM_MAX_BOUNDS 15
+#endif
+
+namespace OTel {
+
+// Instruments that interrupt handlers and both cores can record into. The
+// recording paths are OTEL_ISR_ATTR, so ISRs registered with ESP_INTR_FLAG_IRAM
+// can record while the flash cache is disabled. Like
+// OTEL_PROFILE_SCOPE sites they are constant-initialised statics (declare them
+// at namespace scope) that join a global list the first time they record, and
+// every core writes only its own slot with local interrupts masked: no lock, no
+// atomic read-modify-write, no allocation. The metric reader merges the slots
+// and exports the change since the previous collection (delta temporality).
+class IsrInstrument {
+public:
+  enum class Kind : uint8_t { Counter, Histogram };
+
+  IsrInstrument(const IsrInstrument&) = delete;
+  IsrInstrument& operator=(const IsrInstrument&) = delete;
+
+  Kind           kind() const { return kind_; }
+  const char*    name() const { return name_; }
+  const char*    unit() const { return unit_; }
+  IsrInstrument* next() const { return next_; }
+  static IsrInstrument* first();
+
+  // Exporter side: time of the previous collection (0 before the first)
+  uint64_t swapCollectedNs(uint64_t nowNs) {
+    const uint64_t prev = lastNs_;
+    lastNs_ = nowNs;
+    return prev;
+  }
+
+protected:
+  constexpr IsrInstrument(Kind kind, const char* name, const char* unit)
+  : kind_(kind), name_(name), unit_(unit) {}
+
+  OTEL_ISR_ATTR void ensureLinked() {
+    if (state_.load(std::memory_order_acquire) != kLinked) link();
+  }
+
+private:
+  enum : uint8_t { kUnlinked, kLinking, kLinked };
+  void link();
+
+  Kind                 kind_;
+  const char*          name_;
+  const char*          unit_;
+  IsrInstrument*       next_ = nullptr;
+  std::atomic<uint8_t> state_{kUnlinked};
+  uint64_t             lastNs_ = 0;  // exporter only
+};
+
+// Monotonic counter (edges, encoder ticks, overruns):
+//   OTel::IsrCounter g_edges("gpio.edges");
+//   void IRAM_ATTR onEdge() { g_edges.add(); }
+// Slots are 32-bit: fewer than 2^32 increments may happen between collections.
+class IsrCounter : public IsrInstrument {
+public:
+  constexpr explicit IsrCounter(const char* name, const char* unit = "1")
+  : IsrInstrument(Kind::Counter, name, unit) {}
+
+  OTEL_ISR_ATTR void add(uint32_t n = 1) {
+    if (!OTEL_ENABLE_METRICS) return;
+    ensureLinked();
+    detail::ProfileIrqGuard guard;
+    std::atomic<uint32_t>& c = slots_[detail::profileCore() % OTEL_PROFILE_CORES].count;
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  // Exporter side (one caller at a time): increments since the last call
+  uint32_t takeDelta();
+
+private:
+  struct Slot { std::atomic<uint32_t> count{0}; };
+  Slot     slots_[OTEL_PROFILE_CORES];
+  uint32_t last_ = 0;  // exporter only
+};
+
+// Explicit-bucket histogram of unsigned values (latencies in us, ADC codes):
+//   static const uint32_t kBounds[] = { 10, 50, 100, 500 };
+//   OTel::IsrHistogram g_isrLatency("isr.latency", kBounds, "us");
+// Bucket i counts values in (bounds[i-1], bounds[i]]; `bounds` must be static,
+// ascending and outlive the histogram. record() reads them, so for an ISR that
+// runs with the flash cache disabled declare them DRAM_ATTR.
+class IsrHistogram : public IsrInstrument {
+public:
+  static constexpr size_t kMaxBuckets = OTEL_ISR_HISTOGRAM_MAX_BOUNDS + 1;
+
+  template <size_t N>
+  constexpr IsrHistogram(const char* name, const uint32_t (&bounds)[N], const char* unit = "1")
+  : IsrInstrument(Kind::Histogram, name, unit), bounds_(bounds), nBounds_((uint8_t)N) {
+    static_assert(N <= OTEL_ISR_HISTOGRAM_MAX_BOUNDS, "raise OTEL_ISR_HISTOGRAM_MAX_BOUNDS");
+  }
+
+  OTEL_ISR_ATTR void record(uint32_t value) {
+    if (!OTEL_ENABLE_METRICS) return;
+    ensureLinked();
+    uint8_t b = 0;
+    while (b < nBounds_ && value > bounds_[b]) ++b;
+
+    detail::ProfileIrqGuard guard;
+    Slot& s = slots_[detail::profileCore() % OTEL_PROFILE_CORES];
+    // Odd sequence = update in progress (read side: takeDelta())
+    const uint32_t seq = s.seq.load(std::memory_order_relaxed);
+    s.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ++s.buckets[b];
+    s.sum += value;
+    s.seq.store(seq + 2, std::memory_order_release);
+  }
+
+  struct Delta {
+    uint32_t buckets[kMaxBuckets] = {};
+    uint32_t count = 0;
+    uint64_t sum   = 0;
+  };
+
+  // Exporter side (one caller at a time): measurements since the last call
+  Delta takeDelta();
+
+  const uint32_t* bounds()  const { return bounds_; }
+  size_t          nBounds() const { return nBounds_; }
+
+private:
+  struct Slot {
+    std::atomic<uint32_t> seq{0};
+    uint32_t buckets[kMaxBuckets] = {};
+    uint64_t sum = 0;
+  };
+
+  const uint32_t* bounds_;
+  uint8_t         nBounds_;
+  Slot            slots_[OTEL_PROFILE_CORES];
+  uint32_t        lastBuckets_[kMaxBuckets] = {};  // exporter only
+  uint64_t        lastSum_ = 0;
+};
+
+// Start exporting ISR instruments with the periodic metric collection.
+// Instruments call this themselves on first use outside an ISR; call it from
+// setup() when one may first record inside an interrupt handler.
+void enableIsrMetricsExport();
+
+} // namespace OTel
+
+#endif // OTEL_ISR_METRICS_H
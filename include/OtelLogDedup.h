@@ -0,0 +1,66 @@
+// OtelLogDedup.h
+#ifndef OTEL_LOG_DEDUP_H
+#define OTEL_LOG_DEDUP_H
+
+#include <Arduino.h>
+#include <map>
+
+// Repeats of a log record (same severity, message template and attributes)
+// within this many ms of its first occurrence are counted instead of sent, and
+// reported in one summary record when the window closes. 0 disables the stage;
+// Logger::setDedupWindow() changes it at run time.
+#ifndef OTEL_LOG_DEDUP_WINDOW_MS
+#define OTEL_LOG_DEDUP_WINDOW_MS 0
+#endif
+
+// Distinct records whose windows can be open at once. A new record evicts the
+// oldest window (which reports its repeats early).
+#ifndef OTEL_LOG_DEDUP_SLOTS
+#define OTEL_LOG_DEDUP_SLOTS 8
+#endif
+
+namespace OTel {
+
+// A record that was sent and the repeats of it that were counted instead
+struct LogRepeats {
+  const char* severity       = nullptr;  // static severity text
+  int         severityNumber = 0;
+  String      message;                   // body of the first occurrence
+  std::map<String, String> labels;
+  char        traceId[33] = {0};         // context of the first occurrence
+  char        spanId[17]  = {0};
+  uint32_t    count   = 0;               // repeats within the window
+  uint64_t    firstNs = 0;               // first and last repeat
+  uint64_t    lastNs  = 0;
+};
+
+using LogRepeatsSink = void (*)(const LogRepeats&);
+
+// Fixed table of open windows, shared by loop() and the worker. `templ` is the
+// printf format for deferred records and the message itself otherwise.
+class LogDedup {
+public:
+  static void     setWindow(uint32_t ms);
+  static uint32_t window();
+
+  // Counts the record and returns true if it repeats one whose window is open
+  static bool repeat(int severityNumber, const char* templ,
+                     const std::map<String, String>& labels, uint64_t timeNs);
+
+  // Opens a window for a record that is about to be sent. A window this closes
+  // (expired, or evicted for room) hands its repeats to `sink` first.
+  static void remember(const char* severity, int severityNumber, const char* templ,
+                       const String& message, const std::map<String, String>& labels,
+                       const char* traceId, const char* spanId, LogRepeatsSink sink);
+
+  // Close windows that have ended (every window with `all`), handing their
+  // repeats to `sink`. Returns the number of summaries produced.
+  static size_t expire(bool all, LogRepeatsSink sink);
+
+  // Records counted instead of sent since boot
+  static uint32_t suppressedCount();
+};
+
+} // namespace OTel
+
+#endif // OTEL_LOG_DEDUP_H
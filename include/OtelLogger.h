@@ -4,37 +4,103 @@
 
 #include <Arduino.h>
 #include <map>
+#include <atomic>
 #include <initializer_list>
 #include <ArduinoJson.h>
 #include "OtelDefaults.h"   // expects: nowUnixNano()
 #include "OtelSender.h"     // expects: OTelSender::sendJson(path, doc)
 #include "OtelTracer.h"     // provides: currentTraceContext(), u64ToStr(), defaults & addResAttr helpers
+#include "OtelDeferredLog.h" // provides: DeferredLog ring + formatDeferred()
+#include "OtelLogDedup.h"    // provides: LogDedup windows for repeated records
+#include "OtelFlightRecorder.h" // provides: FlightRecorder ring of recent records
+
+// ---- Compile-time log level --------------------------------------------------
+// Records below OTEL_LOG_LEVEL are stripped. Use the OTEL_LOG_* / OTEL_LOGF_*
+// macros below for call sites that must vanish entirely (arguments unevaluated).
+#define OTEL_LOG_LEVEL_TRACE 1
+#define OTEL_LOG_LEVEL_DEBUG 5
+#define OTEL_LOG_LEVEL_INFO  9
+#define OTEL_LOG_LEVEL_WARN  13
+#define OTEL_LOG_LEVEL_ERROR 17
+#define OTEL_LOG_LEVEL_FATAL 21
+#define OTEL_LOG_LEVEL_NONE  255
+
+#ifndef OTEL_LOG_LEVEL
+#define OTEL_LOG_LEVEL OTEL_LOG_LEVEL_TRACE
+#endif
 
 namespace OTel {
 
 // ---- Severity mapping -------------------------------------------------------
-static inline int severityNumberFromText(const String& s) {
-  if (s == "TRACE") return 1;
-  if (s == "DEBUG") return 5;
-  if (s == "INFO")  return 9;
-  if (s == "WARN")  return 13;
-  if (s == "ERROR") return 17;
-  if (s == "FATAL") return 21;
+// Values are the OTLP SeverityNumber of each level
+enum class Severity : uint8_t {
+  Trace = 1,
+  Debug = 5,
+  Info  = 9,
+  Warn  = 13,
+  Error = 17,
+  Fatal = 21
+};
+
+static inline const char* severityText(Severity s) {
+  switch (s) {
+    case Severity::Trace: return "TRACE";
+    case Severity::Debug: return "DEBUG";
+    case Severity::Info:  return "INFO";
+    case Severity::Warn:  return "WARN";
+    case Severity::Error: return "ERROR";
+    case Severity::Fatal: return "FATAL";
+  }
+  return "";
+}
+
+// The six level names have distinct first letters: one switch + one compare
+static inline int severityNumberFromText(const char* s) {
+  if (!s) return 0;
+  switch (s[0]) {
+    case 'T': return strcmp(s, "TRACE") == 0 ? 1  : 0;
+    case 'D': return strcmp(s, "DEBUG") == 0 ? 5  : 0;
+    case 'I': return strcmp(s, "INFO")  == 0 ? 9  : 0;
+    case 'W': return strcmp(s, "WARN")  == 0 ? 13 : 0;
+    case 'E': return strcmp(s, "ERROR") == 0 ? 17 : 0;
+    case 'F': return strcmp(s, "FATAL") == 0 ? 21 : 0;
+  }
   return 0;
 }
+static inline int severityNumberFromText(const String& s) {
+  return severityNumberFromText(s.c_str());
+}
+
+// Folds to a constant for literal severities, so disabled levels compile away
+static constexpr bool severityEnabled(int number) {
+  return OTEL_ENABLE_LOGS && (number == 0 || number >= OTEL_LOG_LEVEL);
+}
+static constexpr bool severityEnabled(Severity s) {
+  return severityEnabled((int)s);
+}
+
+// Sender queue priority: under OTelQueuePolicy::Priority, DEBUG/TRACE records
+// are evicted first and ERROR/FATAL last
+static constexpr OTelPriority logPriority(int number) {
+  return number >= (int)Severity::Error ? OTelPriority::Critical
+       : number >= (int)Severity::Warn  ? OTelPriority::High
+       : number >= (int)Severity::Info  ? OTelPriority::Normal
+       : number > 0                     ? OTelPriority::Low
+                                        : OTelPriority::Normal; // unspecified
+}
 
 // ---- Instrumentation scope for logs -----------------------------------------
 struct LogScopeConfig {
   String scopeName{"otel-embedded-cpp"};
   String scopeVersion{""}; // optional
 };
-static inline LogScopeConfig& logScopeConfig() {
+inline LogScopeConfig& logScopeConfig() {
   static LogScopeConfig cfg;
   return cfg;
 }
 
 // ---- Default labels (merged into each log record's attributes) --------------
-static inline std::map<String, String>& defaultLabels() {
+inline std::map<String, String>& defaultLabels() {
   static std::map<String, String> labels;
   return labels;
 }
@@ -52,38 +118,220 @@ public:
   // Map-based API
   static void log(const String& severity, const String& message,
                   const std::map<String,String>& labels = {}) {
-    buildAndSend(severity, message, labels);
+    const int number = severityNumberFromText(severity);
+    if (!severityEnabled(number)) return;
+    buildAndSend(severity.c_str(), number, message, labels);
   }
 
   // Convenience overload: initializer_list of key/value pairs
   static void log(const String& severity, const String& message,
                   std::initializer_list<std::pair<const char*, const char*>> kvs) {
-    std::map<String, String> labels;
-    for (auto &kv : kvs) labels[String(kv.first)] = String(kv.second);
-    buildAndSend(severity, message, labels);
+    const int number = severityNumberFromText(severity);
+    if (!severityEnabled(number)) return;
+    buildAndSend(severity.c_str(), number, message, toLabels(kvs));
+  }
+
+  // Enum-based API (no severity string comparisons)
+  static void log(Severity severity, const String& message,
+                  const std::map<String,String>& labels = {}) {
+    if (!severityEnabled(severity)) return;
+    buildAndSend(severityText(severity), (int)severity, message, labels);
+  }
+
+  static void log(Severity severity, const String& message,
+                  std::initializer_list<std::pair<const char*, const char*>> kvs) {
+    if (!severityEnabled(severity)) return;
+    buildAndSend(severityText(severity), (int)severity, message, toLabels(kvs));
   }
 
   // Helpers by severity
-  static void logTrace(const String &m, const std::map<String,String> &l = {}) { log("TRACE", m, l); }
-  static void logDebug(const String &m, const std::map<String,String> &l = {}) { log("DEBUG", m, l); }
-  static void logInfo (const String &m, const std::map<String,String> &l = {}) { log("INFO",  m, l); }
-  static void logWarn (const String &m, const std::map<String,String> &l = {}) { log("WARN",  m, l); }
-  static void logError(const String &m, const std::map<String,String> &l = {}) { log("ERROR", m, l); }
-  static void logFatal(const String &m, const std::map<String,String> &l = {}) { log("FATAL", m, l); }
-
-  static void logTrace(const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log("TRACE", m, kvs); }
-  static void logDebug(const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log("DEBUG", m, kvs); }
-  static void logInfo (const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log("INFO",  m, kvs); }
-  static void logWarn (const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log("WARN",  m, kvs); }
-  static void logError(const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log("ERROR", m, kvs); }
-  static void logFatal(const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log("FATAL", m, kvs); }
+  static void logTrace(const String &m, const std::map<String,String> &l = {}) { log(Severity::Trace, m, l); }
+  static void logDebug(const String &m, const std::map<String,String> &l = {}) { log(Severity::Debug, m, l); }
+  static void logInfo (const String &m, const std::map<String,String> &l = {}) { log(Severity::Info,  m, l); }
+  static void logWarn (const String &m, const std::map<String,String> &l = {}) { log(Severity::Warn,  m, l); }
+  static void logError(const String &m, const std::map<String,String> &l = {}) { log(Severity::Error, m, l); }
+  static void logFatal(const String &m, const std::map<String,String> &l = {}) { log(Severity::Fatal, m, l); }
+
+  static void logTrace(const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log(Severity::Trace, m, kvs); }
+  static void logDebug(const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log(Severity::Debug, m, kvs); }
+  static void logInfo (const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log(Severity::Info,  m, kvs); }
+  static void logWarn (const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log(Severity::Warn,  m, kvs); }
+  static void logError(const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log(Severity::Error, m, kvs); }
+  static void logFatal(const String &m, std::initializer_list<std::pair<const char*,const char*>> kvs) { log(Severity::Fatal, m, kvs); }
+
+  // A record captured earlier, with its own time and span (ISR events, bridges)
+  static void logAt(Severity severity, const String& message,
+                    const std::map<String,String>& labels,
+                    uint64_t timeUnixNano, const char* traceId, const char* spanId) {
+    if (!severityEnabled(severity)) return;
+    recordFlight(severityText(severity), (int)severity, message, labels, timeUnixNano,
+                 traceId, spanId);
+    if (LogDedup::repeat((int)severity, message.c_str(), labels, timeUnixNano)) return;
+    sendFirst(severityText(severity), (int)severity, message.c_str(), message, labels,
+              timeUnixNano, traceId, spanId);
+  }
+
+  // Deferred printf-style API: only the format pointer and raw argument bytes
+  // are recorded here; formatting and OTLP serialisation run later on the
+  // sender worker. `fmt` must be a string literal (string arguments are copied).
+  // Returns false if the record was dropped because the ring is full.
+  template <typename... Args>
+  static bool logf(Severity severity, const char* fmt, const Args&... args) {
+    if (!severityEnabled(severity)) return false;
+    const bool drained = ensureDeferredDrain();
+    const bool captured = DeferredLog::capture(severityText(severity), fmt, args...);
+    if (drained) OTelSender::wake();
+    else         (void)flushDeferred();
+    return captured;
+  }
+
+  // `severity` must be a static string ("INFO", "WARN", ...)
+  template <typename... Args>
+  static bool logf(const char* severity, const char* fmt, const Args&... args) {
+    if (!severityEnabled(severityNumberFromText(severity))) return false;
+    const bool drained = ensureDeferredDrain();
+    const bool captured = DeferredLog::capture(severity, fmt, args...);
+    if (drained) OTelSender::wake();
+    else         (void)flushDeferred();
+    return captured;
+  }
+
+  template <typename... Args> static bool tracef(const char* fmt, const Args&... a) { return logf(Severity::Trace, fmt, a...); }
+  template <typename... Args> static bool debugf(const char* fmt, const Args&... a) { return logf(Severity::Debug, fmt, a...); }
+  template <typename... Args> static bool infof (const char* fmt, const Args&... a) { return logf(Severity::Info,  fmt, a...); }
+  template <typename... Args> static bool warnf (const char* fmt, const Args&... a) { return logf(Severity::Warn,  fmt, a...); }
+  template <typename... Args> static bool errorf(const char* fmt, const Args&... a) { return logf(Severity::Error, fmt, a...); }
+  template <typename... Args> static bool fatalf(const char* fmt, const Args&... a) { return logf(Severity::Fatal, fmt, a...); }
+
+  // Format and send up to `max` deferred records on the calling thread. The
+  // worker does this on every pass; call it from loop() on boards without one.
+  static size_t flushDeferred(size_t max = OTEL_DEFERRED_LOG_CAPACITY) {
+    size_t n = 0;
+    DeferredLogRecord rec;
+    char msg[OTEL_DEFERRED_LOG_MSG_MAX];
+    while (n < max && DeferredLog::pop(rec)) {
+      ++n;
+      // Back-date to the capture instant using the cheap micros() stamp
+      const uint32_t ageUs = (uint32_t)micros() - rec.capturedUs;
+      const uint64_t timeNs = nowUnixNano() - (uint64_t)ageUs * 1000ULL;
+      const int number = severityNumberFromText(rec.severity);
+      // Repeats are keyed on the format string and never formatted, unless
+      // the flight recorder keeps every record
+      const bool recording = FlightRecorder::enabled();
+      if (recording) {
+        formatDeferred(msg, sizeof(msg), rec);
+        recordFlight(rec.severity, number, String(msg), noLabels(), timeNs,
+                     rec.traceId, rec.spanId);
+      }
+      if (LogDedup::repeat(number, rec.fmt, noLabels(), timeNs)) continue;
+      if (!recording) formatDeferred(msg, sizeof(msg), rec);
+      sendFirst(rec.severity, number, rec.fmt, String(msg), noLabels(), timeNs,
+                rec.traceId, rec.spanId);
+    }
+    return n;
+  }
+
+  // Collapse repeats of a record within `windowMs` of its first occurrence
+  // into one summary record (0 disables; default OTEL_LOG_DEDUP_WINDOW_MS)
+  static void setDedupWindow(uint32_t windowMs) {
+    LogDedup::setWindow(windowMs && ensureDedupExpiry() ? windowMs : 0);
+  }
 
 private:
-  static void buildAndSend(const String& severity, const String& message,
+  // False if no worker hook was free: callers then drain on their own task
+  static bool ensureDeferredDrain() {
+    static const bool ok = [] {
+      const bool added = OTelSender::addHooks("deferred logs", [] { (void)Logger::flushDeferred(); }, nullptr);
+      OTelSender::beginAsyncWorker();
+      return added;
+    }();
+    return ok;
+  }
+
+  // Summaries are sent when their window closes, or all at once by flush().
+  // False if the hooks could not be registered: dedup then stays off.
+  static bool ensureDedupExpiry() {
+    static const bool ok = [] {
+      const bool added = OTelSender::addHooks("log dedup",
+                                              [] { (void)LogDedup::expire(false, sendRepeats); },
+                                              [] { (void)LogDedup::expire(true, sendRepeats); });
+      OTelSender::beginAsyncWorker();
+      return added;
+    }();
+    return ok;
+  }
+
+  static const std::map<String, String>& noLabels() {
+    static const std::map<String, String> none;
+    return none;
+  }
+
+  static std::map<String, String> toLabels(std::initializer_list<std::pair<const char*, const char*>> kvs) {
+    std::map<String, String> labels;
+    for (auto &kv : kvs) labels[String(kv.first)] = String(kv.second);
+    return labels;
+  }
+
+  static void buildAndSend(const char* severity, int severityNumber,
+                           const String& message,
                            const std::map<String,String>& labels)
   {
-    // Build OTLP/HTTP logs payload (ArduinoJson v7)
-    JsonDocument doc;
+    const uint64_t now = nowUnixNano();
+    const auto& ctx = currentTraceContext();
+    const char* traceId = ctx.valid() ? ctx.traceId.c_str() : "";
+    const char* spanId  = ctx.valid() ? ctx.spanId.c_str()  : "";
+    recordFlight(severity, severityNumber, message, labels, now, traceId, spanId);
+    if (LogDedup::repeat(severityNumber, message.c_str(), labels, now)) return;
+    sendFirst(severity, severityNumber, message.c_str(), message, labels, now,
+              traceId, spanId);
+  }
+
+  // Every record, repeats included, goes into the flight recorder; ERROR and
+  // above trigger a dump of the window
+  static void recordFlight(const char* severity, int severityNumber,
+                           const String& message,
+                           const std::map<String,String>& labels,
+                           uint64_t timeUnixNano,
+                           const char* traceId, const char* spanId)
+  {
+    if (!FlightRecorder::enabled()) return;
+    FlightRecorder::recordLog(severityNumber, severity, message, labels, timeUnixNano,
+                              traceId, spanId);
+    if (severityNumber >= (int)Severity::Error) FlightRecorder::trigger(FlightTrigger::ErrorLog);
+  }
+
+  // Send a record that is not a repeat, opening its dedup window
+  static void sendFirst(const char* severity, int severityNumber, const char* templ,
+                        const String& message,
+                        const std::map<String,String>& labels,
+                        uint64_t timeUnixNano,
+                        const char* traceId, const char* spanId)
+  {
+    if (LogDedup::window() && ensureDedupExpiry()) {
+      LogDedup::remember(severity, severityNumber, templ, message, labels,
+                         traceId, spanId, sendRepeats);
+    }
+    buildAndSend(severity, severityNumber, message, labels, timeUnixNano, traceId, spanId);
+  }
+
+  // One record standing for the repeats counted in a closed window: timed at
+  // the first repeat, linked to the first occurrence's span
+  static void sendRepeats(const LogRepeats& r) {
+    buildAndSend(r.severity, r.severityNumber, r.message, r.labels, r.firstNs,
+                 r.traceId, r.spanId, &r);
+  }
+
+  static void buildAndSend(const char* severity, int severityNumber,
+                           const String& message,
+                           const std::map<String,String>& labels,
+                           uint64_t timeUnixNano,
+                           const char* traceId, const char* spanId,
+                           const LogRepeats* repeats = nullptr)
+  {
+#if OTEL_ENABLE_LOGS
+    // Build OTLP/HTTP logs payload (ArduinoJson v7) in the logs workspace
+    JsonLease lease(OTelSignal::Logs);
+    JsonDocument& doc = lease.doc();
 
     JsonArray resourceLogs = doc["resourceLogs"].to<JsonArray>();
     JsonObject rl = resourceLogs.add<JsonObject>();
@@ -104,42 +352,105 @@ private:
 
     // Log record
     JsonObject lr = sl["logRecords"].to<JsonArray>().add<JsonObject>();
-    lr["timeUnixNano"]   = u64ToStr(nowUnixNano());
-    lr["severityNumber"] = severityNumberFromText(severity);
+    lr["timeUnixNano"]   = u64ToStr(timeUnixNano);
+    lr["severityNumber"] = severityNumber;
     lr["severityText"]   = severity;
 
     // Body
     JsonObject body = lr["body"].to<JsonObject>();
-    body["stringValue"] = message;
+    setLimitedString(body["stringValue"], message, OTEL_LOG_BODY_LENGTH_LIMIT);
 
-    // Correlate to active span if present
-    auto &ctx = currentTraceContext();
-    if (ctx.valid()) {
-      lr["traceId"] = ctx.traceId;
-      lr["spanId"]  = ctx.spanId;
+    // Correlate to the span that was active when the record was captured
+    if (traceId && *traceId && spanId && *spanId) {
+      lr["traceId"] = traceId;
+      lr["spanId"]  = spanId;
       // (optional) lr["flags"] = 1;
     }
 
     // Attributes (merge defaults first, then per-call to allow override)
     JsonArray lattrs = lr["attributes"].to<JsonArray>();
-
-    for (const auto& kv : defaultLabels()) {
+    uint32_t dropped = 0;
+    auto addAttr = [&](const String& key, const String& value) {
+      if (lattrs.size() >= OTEL_ATTRIBUTE_COUNT_LIMIT) { ++dropped; return; }
       JsonObject a = lattrs.add<JsonObject>();
-      a["key"] = kv.first;
-      a["value"].to<JsonObject>()["stringValue"] = kv.second;
-    }
-    for (const auto& kv : labels) {
-      JsonObject a = lattrs.add<JsonObject>();
-      a["key"] = kv.first;
-      a["value"].to<JsonObject>()["stringValue"] = kv.second;
+      a["key"] = key;
+      setLimitedString(a["value"].to<JsonObject>()["stringValue"], value);
+    };
+    if (repeats) {
+      auto addInt = [&](const char* key, const String& value) {
+        JsonObject a = lattrs.add<JsonObject>();
+        a["key"] = key;
+        a["value"].to<JsonObject>()["intValue"] = value;
+      };
+      addInt("log.repeat_count",     String(repeats->count));
+      addInt("log.repeat.first_time", u64ToStr(repeats->firstNs));
+      addInt("log.repeat.last_time",  u64ToStr(repeats->lastNs));
     }
+    for (const auto& kv : defaultLabels()) addAttr(kv.first, kv.second);
+    for (const auto& kv : labels)          addAttr(kv.first, kv.second);
+    if (dropped) lr["droppedAttributesCount"] = dropped;
 
     // Send
-    OTelSender::sendJson("/v1/logs", doc);
+    OTelSender::sendJson("/v1/logs", doc, logPriority(severityNumber), lease.scratch());
+#else
+    (void)severity; (void)severityNumber; (void)message; (void)labels;
+    (void)timeUnixNano; (void)traceId; (void)spanId; (void)repeats;
+#endif
   }
 };
 
 } // namespace OTel
 
+// ---- Zero-cost logging macros -----------------------------------------------
+// When a level (or the whole logs signal) is compiled out these expand to
+// nothing: the arguments are never evaluated and no code reaches the binary.
+#if OTEL_ENABLE_LOGS && OTEL_LOG_LEVEL <= OTEL_LOG_LEVEL_TRACE
+  #define OTEL_LOG_TRACE(...)  ::OTel::Logger::logTrace(__VA_ARGS__)
+  #define OTEL_LOGF_TRACE(...) ::OTel::Logger::tracef(__VA_ARGS__)
+#else
+  #define OTEL_LOG_TRACE(...)  (void)0
+  #define OTEL_LOGF_TRACE(...) (void)0
+#endif
+
+#if OTEL_ENABLE_LOGS && OTEL_LOG_LEVEL <= OTEL_LOG_LEVEL_DEBUG
+  #define OTEL_LOG_DEBUG(...)  ::OTel::Logger::logDebug(__VA_ARGS__)
+  #define OTEL_LOGF_DEBUG(...) ::OTel::Logger::debugf(__VA_ARGS__)
+#else
+  #define OTEL_LOG_DEBUG(...)  (void)0
+  #define OTEL_LOGF_DEBUG(...) (void)0
+#endif
+
+#if OTEL_ENABLE_LOGS && OTEL_LOG_LEVEL <= OTEL_LOG_LEVEL_INFO
+  #define OTEL_LOG_INFO(...)   ::OTel::Logger::logInfo(__VA_ARGS__)
+  #define OTEL_LOGF_INFO(...)  ::OTel::Logger::infof(__VA_ARGS__)
+#else
+  #define OTEL_LOG_INFO(...)   (void)0
+  #define OTEL_LOGF_INFO(...)  (void)0
+#endif
+
+#if OTEL_ENABLE_LOGS && OTEL_LOG_LEVEL <= OTEL_LOG_LEVEL_WARN
+  #define OTEL_LOG_WARN(...)   ::OTel::Logger::logWarn(__VA_ARGS__)
+  #define OTEL_LOGF_WARN(...)  ::OTel::Logger::warnf(__VA_ARGS__)
+#else
+  #define OTEL_LOG_WARN(...)   (void)0
+  #define OTEL_LOGF_WARN(...)  (void)0
+#endif
+
+#if OTEL_ENABLE_LOGS && OTEL_LOG_LEVEL <= OTEL_LOG_LEVEL_ERROR
+  #define OTEL_LOG_ERROR(...)  ::OTel::Logger::logError(__VA_ARGS__)
+  #define OTEL_LOGF_ERROR(...) ::OTel::Logger::errorf(__VA_ARGS__)
+#else
+  #define OTEL_LOG_ERROR(...)  (void)0
+  #define OTEL_LOGF_ERROR(...) (void)0
+#endif
+
+#if OTEL_ENABLE_LOGS && OTEL_LOG_LEVEL <= OTEL_LOG_LEVEL_FATAL
+  #define OTEL_LOG_FATAL(...)  ::OTel::Logger::logFatal(__VA_ARGS__)
+  #define OTEL_LOGF_FATAL(...) ::OTel::Logger::fatalf(__VA_ARGS__)
+#else
+  #define OTEL_LOG_FATAL(...)  (void)0
+  #define OTEL_LOGF_FATAL(...) (void)0
+#endif
+
 #endif // OTEL_LOGGER_H
 
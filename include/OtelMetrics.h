@@ -4,31 +4,210 @@
 
 #include <Arduino.h>
 #include <map>
+#include <vector>
 #include <initializer_list>
+#include <functional>
 #include <ArduinoJson.h>
 #include "OtelDefaults.h"   // expects: nowUnixNano()
 #include "OtelSender.h"     // expects: OTelSender::sendJson(path, doc)
+#include "OtelHistogram.h"  // ExponentialHistogram
 #include "OtelTracer.h"     // reuses: u64ToStr(), defaultServiceName(), defaultServiceInstanceId(), defaultHostName(), addResAttr()
 
+// Exemplars kept per data point (0 disables exemplar capture entirely)
+#ifndef OTEL_EXEMPLAR_RESERVOIR_SIZE
+#define OTEL_EXEMPLAR_RESERVOIR_SIZE 2
+#endif
+
+// Maximum number of observable (callback) instruments
+#ifndef OTEL_MAX_OBSERVABLES
+#define OTEL_MAX_OBSERVABLES 16
+#endif
+
+// How often the metric reader collects observable instruments (ms)
+#ifndef OTEL_METRIC_EXPORT_INTERVAL_MS
+#define OTEL_METRIC_EXPORT_INTERVAL_MS 60000
+#endif
+
+// Maximum number of registered metric Views
+#ifndef OTEL_MAX_VIEWS
+#define OTEL_MAX_VIEWS 8
+#endif
+
+// Distinct attribute sets per instrument, the overflow series included. Further
+// sets are folded into the otel.metric.overflow=true series.
+#ifndef OTEL_METRIC_CARDINALITY_LIMIT
+#define OTEL_METRIC_CARDINALITY_LIMIT 16
+#endif
+
+// Instruments whose cardinality is tracked. Points of further instruments are
+// exported with only the overflow attribute (aggregated ones are dropped).
+#ifndef OTEL_METRIC_MAX_INSTRUMENTS
+#define OTEL_METRIC_MAX_INSTRUMENTS 16
+#endif
+
+// Series held in memory for aggregating Views and histograms (all instruments)
+#ifndef OTEL_METRIC_MAX_STREAMS
+#define OTEL_METRIC_MAX_STREAMS 32
+#endif
+
 namespace OTel {
 
+// ---- Exemplars --------------------------------------------------------------
+// A measurement linked to the sampled span that was active when it was recorded
+struct Exemplar {
+  double   value = 0;
+  uint64_t timeUnixNano = 0;
+  char     traceId[33] = {0};
+  char     spanId[17]  = {0};
+
+  // Take the IDs of the current span; false (and untouched) unless it is sampled
+  bool capture(double v, uint64_t t) {
+    const TraceContext& ctx = currentTraceContext();
+    if (!ctx.sampled || !ctx.valid()) return false;
+    value        = v;
+    timeUnixNano = t;
+    memcpy(traceId, ctx.traceId.c_str(), 33);
+    memcpy(spanId,  ctx.spanId.c_str(),  17);
+    return true;
+  }
+
+  void toJson(JsonArray exemplars) const {
+    JsonObject ex = exemplars.add<JsonObject>();
+    ex["timeUnixNano"] = u64ToStr(timeUnixNano);
+    ex["asDouble"]     = value;
+    ex["traceId"]      = traceId;
+    ex["spanId"]       = spanId;
+  }
+};
+
+// Fixed-size, allocation-free reservoir (spec "SimpleFixedSizeExemplarReservoir"):
+// the first N sampled measurements fill it, later ones replace a slot with
+// probability N/seen so every sampled measurement has an equal chance.
+// Only measurements taken inside a sampled span are offered (trace-based filter).
+// Each aggregated series owns one and empties it at every collection.
+template <size_t N>
+class ExemplarReservoir {
+public:
+  // The timestamp is only taken for measurements that are kept
+  void offer(double value) {
+    if (N == 0) return;
+    const TraceContext& ctx = currentTraceContext();
+    if (!ctx.sampled || !ctx.valid()) return;
+
+    size_t slot = count_;
+    ++seen_;
+    if (count_ < N) {
+      ++count_;
+    } else {
+      slot = nextRandom() % seen_;
+      if (slot >= N) return;
+    }
+    slots_[slot].capture(value, nowUnixNano());
+  }
+
+  size_t size() const { return count_; }
+  const Exemplar& at(size_t i) const { return slots_[i]; }
+
+  // Start a new collection interval
+  void reset() { count_ = 0; seen_ = 0; }
+
+  // Writes dp["exemplars"] (omitted when empty)
+  void toJson(JsonObject dp) const {
+    if (count_ == 0) return;
+    JsonArray arr = dp["exemplars"].to<JsonArray>();
+    for (size_t i = 0; i < count_; ++i) slots_[i].toJson(arr);
+  }
+
+private:
+  // xorshift32: cheap and good enough for reservoir slot selection
+  static uint32_t nextRandom() {
+    static uint32_t state = 0x9E3779B9u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  Exemplar slots_[N > 0 ? N : 1];
+  size_t   count_ = 0;
+  uint32_t seen_  = 0;
+};
+
+using DefaultExemplarReservoir = ExemplarReservoir<OTEL_EXEMPLAR_RESERVOIR_SIZE>;
+
 // ---- Instrumentation scope for metrics --------------------------------------
 struct MetricsScopeConfig {
   String scopeName{"otel-embedded"};
   String scopeVersion{"0.1.0"};
 };
 
-static inline MetricsScopeConfig& metricsScopeConfig() {
+inline MetricsScopeConfig& metricsScopeConfig() {
   static MetricsScopeConfig cfg;
   return cfg;
 }
 
 // ---- Default metric labels (merged into each datapoint's attributes) --------
-static inline std::map<String, String>& defaultMetricLabels() {
+inline std::map<String, String>& defaultMetricLabels() {
   static std::map<String, String> labels;
   return labels;
 }
 
+// ---- Views -----------------------------------------------------------------
+enum class MetricAggregation : uint8_t {
+  Default,    // as recorded: each gauge()/sum() call is exported on its own
+  Drop,       // discard every measurement of the instrument
+  LastValue,  // keep the latest value per series, export it as a gauge
+  Sum,        // add up measurements per series, export a cumulative sum
+  ExponentialHistogram  // base-2 exponential histogram per series (default for histogram())
+};
+
+// Reshapes the instruments it matches before anything is kept or exported.
+// The first registered View whose `instrument` matches applies.
+struct MetricView {
+  String instrument;                  // instrument name, or a prefix ending in '*'
+  String name;                        // exported name ("" keeps the instrument's)
+  std::vector<String> attributeKeys;  // keys to keep (empty keeps all)
+  std::vector<String> excludeKeys;    // keys to drop, applied after attributeKeys
+  MetricAggregation aggregation = MetricAggregation::Default;
+  uint16_t cardinalityLimit = 0;      // 0 = OTEL_METRIC_CARDINALITY_LIMIT (also the maximum)
+};
+
+// ---- Observable (asynchronous) instruments ----------------------------------
+enum class ObservableKind : uint8_t {
+  Gauge,          // last value
+  Counter,        // monotonic cumulative sum
+  UpDownCounter   // non-monotonic cumulative sum
+};
+
+class MetricsRequest;  // collect()'s output, split under OTEL_MAX_REQUEST_BYTES
+
+// Handed to observable callbacks at collection time; each observe() adds one
+// data point to the batched export.
+class ObservableResult {
+public:
+  ObservableResult(JsonArray dataPoints, uint64_t timeUnixNano, uint64_t startTimeUnixNano,
+                   const String* instrument = nullptr)
+  : dps_(dataPoints), now_(timeUnixNano), start_(startTimeUnixNano), instrument_(instrument) {}
+  ObservableResult(MetricsRequest& request, uint64_t timeUnixNano, uint64_t startTimeUnixNano,
+                   const String* instrument = nullptr)
+  : request_(&request), now_(timeUnixNano), start_(startTimeUnixNano), instrument_(instrument) {}
+
+  void observe(double value, const std::map<String,String>& labels = {});
+  void observe(double value, std::initializer_list<std::pair<const char*, const char*>> kvs);
+
+  size_t count() const { return count_; }
+
+private:
+  JsonArray dps_;
+  MetricsRequest* request_ = nullptr;  // instead of dps_ during collect()
+  uint64_t  now_;
+  uint64_t  start_;  // 0 for gauges (no start time)
+  const String* instrument_; // for View attribute filters and the cardinality cap
+  size_t    count_ = 0;
+};
+
+using ObservableCallback = std::function<void(ObservableResult&)>;
+
 class Metrics {
 public:
   // Configure the instrumentation scope name/version for metrics
@@ -82,7 +261,89 @@ public:
     buildAndSendSum(name, value, isMonotonic, temporality, unit, labels);
   }
 
+  // --------- HISTOGRAM -------------
+  // Recorded into a base-2 exponential histogram per attribute set and exported
+  // at each collection (cumulative), unless a View chooses another aggregation
+  static void histogram(const String& name, double value,
+                        const String& unit = "1",
+                        const std::map<String,String>& labels = {}) {
+    recordHistogram(name, value, nullptr, unit, labels);
+  }
+
+  static void histogram(const String& name, double value,
+                        const String& unit,
+                        std::initializer_list<std::pair<const char*, const char*>> kvs) {
+    std::map<String, String> labels;
+    for (auto &kv : kvs) labels[String(kv.first)] = String(kv.second);
+    recordHistogram(name, value, nullptr, unit, labels);
+  }
+
+  // Merge a histogram filled elsewhere (e.g. one instance per core, without
+  // locking) into the instrument's series
+  static void mergeHistogram(const String& name, const ExponentialHistogram& h,
+                             const String& unit = "1",
+                             const std::map<String,String>& labels = {}) {
+    recordHistogram(name, 0, &h, unit, labels);
+  }
+
+  // --------- Observable instruments --------
+  // Registered once; the callback runs only when the metric reader collects
+  // (every OTEL_METRIC_EXPORT_INTERVAL_MS, on the sender worker where there is
+  // one), and all observable instruments share one request per collection.
+  // Returns false when OTEL_MAX_OBSERVABLES instruments are already registered.
+  static bool createObservableGauge(const String& name, const String& unit,
+                                    ObservableCallback callback) {
+    return registerObservable(ObservableKind::Gauge, name, unit, std::move(callback));
+  }
+  static bool createObservableCounter(const String& name, const String& unit,
+                                      ObservableCallback callback) {
+    return registerObservable(ObservableKind::Counter, name, unit, std::move(callback));
+  }
+  static bool createObservableUpDownCounter(const String& name, const String& unit,
+                                            ObservableCallback callback) {
+    return registerObservable(ObservableKind::UpDownCounter, name, unit, std::move(callback));
+  }
+
+  // --------- Views --------
+  // Register before recording. Returns false when OTEL_MAX_VIEWS are registered.
+  // Aggregating Views (LastValue, Sum, ExponentialHistogram) keep their series
+  // in memory (at most OTEL_METRIC_MAX_STREAMS) and export them at each collection.
+  static bool addView(const MetricView& view);
+
+  // Measurements folded into an overflow series (or dropped because the series
+  // table was full) since boot
+  static uint32_t overflowCount();
+
+  // Collection interval of the metric reader (0 = only on explicit collect())
+  static void setExportInterval(uint32_t intervalMs);
+
+  // Invoke every observable callback now and export the result, together with
+  // the series aggregated by Views, as one batch. A batch larger than
+  // OTEL_MAX_REQUEST_BYTES is sent as several requests, split between data points.
+  // Returns the number of data points exported.
+  static size_t collect();
+
+  // collect() if the export interval has elapsed since the last call. The
+  // scheduler already collects on the worker (or in OTelSender::service());
+  // this is for sketches that drive collection themselves.
+  static bool collectIfDue();
+
+  // Span metrics: a span processor counts every ending span and records its
+  // duration, per span name and status, before any span is dropped. Exported
+  // with the other aggregated series as `traces.span.metrics.calls` (cumulative
+  // sum) and `traces.span.metrics.duration` (exponential histogram, ms).
+  // Returns false when no span processor slot is free.
+  static bool enableSpanMetrics();
+
 private:
+  static void recordHistogram(const String& name, double value,
+                              const ExponentialHistogram* merged,
+                              const String& unit,
+                              const std::map<String,String>& labels);
+
+  static bool registerObservable(ObservableKind kind, const String& name,
+                                 const String& unit, ObservableCallback callback);
+
   static void buildAndSendGauge(const String& name, double value,
                                 const String& unit,
                                 const std::map<String,String>& labels);
@@ -96,5 +357,16 @@ private:
 
 } // namespace OTel
 
+// Metric calls that vanish (arguments unevaluated) when OTEL_ENABLE_METRICS=0
+#if OTEL_ENABLE_METRICS
+  #define OTEL_METRIC_GAUGE(...) ::OTel::Metrics::gauge(__VA_ARGS__)
+  #define OTEL_METRIC_SUM(...)   ::OTel::Metrics::sum(__VA_ARGS__)
+  #define OTEL_METRIC_HISTOGRAM(...) ::OTel::Metrics::histogram(__VA_ARGS__)
+#else
+  #define OTEL_METRIC_GAUGE(...) (void)0
+  #define OTEL_METRIC_SUM(...)   (void)0
+  #define OTEL_METRIC_HISTOGRAM(...) (void)0
+#endif
+
 #endif // OTEL_METRICS_H
 
@@ -0,0 +1,53 @@
+// OtelMutex.h
+#ifndef OTEL_MUTEX_H
+#define OTEL_MUTEX_H
+
+#if defined(ARDUINO_ARCH_RP2040)
+  #include "pico/mutex.h"
+#elif defined(ESP32)
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/semphr.h>
+#endif
+
+namespace OTel {
+
+// Blocking mutex for state shared by loop() and the sender worker when the
+// critical section allocates (Strings, maps). The queue's spin lock / portMUX
+// must not be held across heap work, so such state takes this instead. It is
+// a no-op where there is no worker (ESP8266 services from loop()).
+class Mutex {
+public:
+#if defined(ARDUINO_ARCH_RP2040)
+  Mutex()       { mutex_init(&m_); }
+  void lock()   { mutex_enter_blocking(&m_); }
+  void unlock() { mutex_exit(&m_); }
+private:
+  mutex_t m_;
+#elif defined(ESP32)
+  Mutex() : h_(xSemaphoreCreateMutex()) {}
+  void lock()   { if (h_) xSemaphoreTake(h_, portMAX_DELAY); }
+  void unlock() { if (h_) xSemaphoreGive(h_); }
+private:
+  SemaphoreHandle_t h_;
+#else
+  Mutex() {}
+  void lock()   {}
+  void unlock() {}
+#endif
+public:
+  Mutex(const Mutex&) = delete;
+  Mutex& operator=(const Mutex&) = delete;
+};
+
+struct MutexLock {
+  explicit MutexLock(Mutex& m) : m_(m) { m_.lock(); }
+  ~MutexLock() { m_.unlock(); }
+  MutexLock(const MutexLock&) = delete;
+  MutexLock& operator=(const MutexLock&) = delete;
+private:
+  Mutex& m_;
+};
+
+} // namespace OTel
+
+#endif // OTEL_MUTEX_H
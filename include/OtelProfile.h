@@ -0,0 +1,193 @@
+// OtelProfile.h
+#ifndef OTEL_PROFILE_H
+#define OTEL_PROFILE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "OtelDefaults.h"   // OTEL_ENABLE_METRICS
+
+#if defined(ARDUINO_ARCH_RP2040)
+  #include "hardware/sync.h"
+  #include "hardware/timer.h"
+#elif defined(ESP32)
+  #include <freertos/FreeRTOS.h>
+#endif
+
+// Cores that can run profiled code at the same time. Each site keeps one slot
+// per core, so a scope only ever touches memory its own core writes.
+#ifndef OTEL_PROFILE_CORES
+  #if defined(ARDUINO_ARCH_RP2040) || defined(ESP32)
+    #define OTEL_PROFILE_CORES 2
+  #else
+    #define OTEL_PROFILE_CORES 1
+  #endif
+#endif
+
+namespace OTel {
+
+// Cheapest free-running counter: CCOUNT on Xtensa (ESP32, ESP8266), the cycle
+// CSR on RISC-V ESP32s, the 1 MHz timer on RP2040 (the Cortex-M0+ has no DWT
+// cycle counter). 32 bits: a scope longer than one wrap (~17 s at 240 MHz) is
+// mismeasured.
+inline uint32_t profileTicks() {
+#if defined(__XTENSA__)
+  uint32_t c;
+  __asm__ __volatile__("rsr %0, ccount" : "=a"(c));
+  return c;
+#elif defined(ESP32)
+  return ESP.getCycleCount();
+#elif defined(ARDUINO_ARCH_RP2040)
+  return time_us_32();
+#else
+  return (uint32_t)micros();
+#endif
+}
+
+// profileTicks() per microsecond (the current CPU clock for cycle counters)
+double profileTicksPerUs();
+
+namespace detail {
+// Masks interrupts on the local core, so each per-core slot has one writer
+struct ProfileIrqGuard {
+#if defined(ARDUINO_ARCH_RP2040)
+  uint32_t saved;
+  ProfileIrqGuard() : saved(save_and_disable_interrupts()) {}
+  ~ProfileIrqGuard() { restore_interrupts(saved); }
+#elif defined(ESP32)
+  UBaseType_t saved;
+  ProfileIrqGuard() : saved(portSET_INTERRUPT_MASK_FROM_ISR()) {}
+  ~ProfileIrqGuard() { portCLEAR_INTERRUPT_MASK_FROM_ISR(saved); }
+#elif defined(ESP8266)
+  uint32_t saved;
+  ProfileIrqGuard() : saved(xt_rsil(15)) {}
+  ~ProfileIrqGuard() { xt_wsr_ps(saved); }
+#endif
+};
+
+inline unsigned profileCore() {
+#if defined(ARDUINO_ARCH_RP2040)
+  return get_core_num();
+#elif defined(ESP32)
+  return (unsigned)xPortGetCoreID();
+#else
+  return 0;
+#endif
+}
+
+inline bool inInterrupt() {
+#if defined(ARDUINO_ARCH_RP2040)
+  return __get_current_exception() != 0;
+#elif defined(ESP32)
+  return xPortInIsrContext();
+#else
+  return false;
+#endif
+}
+} // namespace detail
+
+// Calls and time of one site since the previous snapshot
+struct ProfileSample {
+  uint32_t calls    = 0;
+  uint64_t ticks    = 0;
+  uint32_t minTicks = 0;
+  uint32_t maxTicks = 0;
+  bool     hasRange = false;  // min/max seen in this interval
+  uint64_t startNs  = 0;      // previous snapshot (0 on the first)
+};
+
+// Statistics of one OTEL_PROFILE_SCOPE site. Sites are constant-initialised
+// statics (no guard, no constructor at run time) and join the global site list
+// the first time they record.
+class ProfileSite {
+public:
+  constexpr explicit ProfileSite(const char* name) : name_(name) {}
+  ProfileSite(const ProfileSite&) = delete;
+  ProfileSite& operator=(const ProfileSite&) = delete;
+
+  void record(uint32_t ticks) {
+    if (state_.load(std::memory_order_acquire) != kLinked) link();
+    detail::ProfileIrqGuard guard;
+    Slot& s = slots_[detail::profileCore() % OTEL_PROFILE_CORES];
+    // Odd sequence = update in progress (read side: snapshot())
+    const uint32_t seq = s.seq.load(std::memory_order_relaxed);
+    s.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    const uint32_t epoch = epoch_.load(std::memory_order_relaxed);
+    if (s.epoch != epoch) {
+      s.epoch = epoch;
+      s.min = s.max = ticks;
+    } else {
+      if (ticks < s.min) s.min = ticks;
+      if (ticks > s.max) s.max = ticks;
+    }
+    ++s.count;
+    s.total += ticks;
+    s.seq.store(seq + 2, std::memory_order_release);
+  }
+
+  const char* name() const { return name_; }
+  ProfileSite* next() const { return next_; }
+  static ProfileSite* first();
+
+  // Exporter side (one caller at a time): totals since the last snapshot
+  ProfileSample snapshot(uint64_t nowNs);
+
+private:
+  enum : uint8_t { kUnlinked, kLinking, kLinked };
+  struct Slot {
+    std::atomic<uint32_t> seq{0};
+    uint32_t epoch = 0;
+    uint32_t count = 0;
+    uint64_t total = 0;
+    uint32_t min   = 0;
+    uint32_t max   = 0;
+  };
+
+  void link();
+
+  const char*           name_;
+  ProfileSite*          next_ = nullptr;
+  std::atomic<uint8_t>  state_{kUnlinked};
+  std::atomic<uint32_t> epoch_{1};         // bumped by snapshot(): min/max restart
+  Slot                  slots_[OTEL_PROFILE_CORES];
+  uint32_t              lastCount_ = 0;    // exporter only
+  uint64_t              lastTotal_ = 0;
+  uint64_t              lastNs_    = 0;
+};
+
+// Times its own lifetime into a site
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfileSite& site) : site_(site), start_(profileTicks()) {}
+  ~ProfileScope() { site_.record(profileTicks() - start_); }
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+  ProfileSite& site_;
+  uint32_t     start_;
+};
+
+// Start exporting the sites with the periodic metric collection. Sites call
+// this themselves on first use outside an ISR; call it from setup() when a
+// site may first run inside an interrupt handler.
+void enableProfileExport();
+
+} // namespace OTel
+
+#define OTEL_PROFILE_CAT2_(a, b) a##b
+#define OTEL_PROFILE_CAT_(a, b)  OTEL_PROFILE_CAT2_(a, b)
+
+// Time the rest of the enclosing scope:
+//   void readSensor() { OTEL_PROFILE_SCOPE("readSensor"); ... }
+// `name` must be a string literal. Compiled out with OTEL_ENABLE_METRICS=0.
+#if OTEL_ENABLE_METRICS
+  #define OTEL_PROFILE_SCOPE(name)                                                   \
+    static ::OTel::ProfileSite OTEL_PROFILE_CAT_(otel_profile_site_, __LINE__)(name); \
+    ::OTel::ProfileScope OTEL_PROFILE_CAT_(otel_profile_scope_, __LINE__)(            \
+        OTEL_PROFILE_CAT_(otel_profile_site_, __LINE__))
+#else
+  #define OTEL_PROFILE_SCOPE(name) do {} while (0)
+#endif
+
+#endif // OTEL_PROFILE_H
@@ -0,0 +1,95 @@
+// OtelScheduler.h
+#ifndef OTEL_SCHEDULER_H
+#define OTEL_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Timer wheel resolution (ms per slot) and number of slots. Deadlines further
+// out than TICK_MS * WHEEL_SLOTS simply wait for another turn of the wheel.
+#ifndef OTEL_SCHED_TICK_MS
+#define OTEL_SCHED_TICK_MS 10
+#endif
+#ifndef OTEL_SCHED_WHEEL_SLOTS
+#define OTEL_SCHED_WHEEL_SLOTS 64
+#endif
+
+// Maximum number of timers (batch flushes, retries, metric collection, ...)
+#ifndef OTEL_SCHED_MAX_TIMERS
+#define OTEL_SCHED_MAX_TIMERS 12
+#endif
+
+// Radio-window alignment: when non-zero every deadline is rounded up to the
+// next multiple of this many ms, so all exports due in a window go out together
+#ifndef OTEL_EXPORT_ALIGN_MS
+#define OTEL_EXPORT_ALIGN_MS 0
+#endif
+
+namespace OTel {
+
+// Millisecond clock. The default is millis(); host tests can install a
+// virtual clock and step it by hand.
+using SchedulerClock = uint32_t (*)();
+using SchedulerTask  = void (*)(void* ctx);
+
+// Hashed timer wheel owned by the sender worker. It is not thread-safe: create,
+// arm and tick timers from the worker (worker hooks, timer callbacks) or, on
+// boards without one, from the thread that calls OTelSender::service().
+class Scheduler {
+public:
+  static constexpr int kInvalidTimer = -1;
+
+  // Allocate a (disarmed) timer. Returns kInvalidTimer when all slots are used.
+  static int  create(SchedulerTask fn, void* ctx = nullptr);
+
+  // One-shot: fire once, delayMs from now (re-arming replaces the old deadline)
+  static void armAfter(int id, uint32_t delayMs);
+  // Periodic: first fire periodMs from now, then every periodMs
+  static void armEvery(int id, uint32_t periodMs);
+  static void cancel(int id);
+  static bool armed(int id);
+
+  // Run every timer whose deadline has passed. Returns how many fired.
+  static size_t tick();
+
+  // Time until the earliest armed deadline, capped at `cap` (0 = something is due)
+  static uint32_t msUntilNext(uint32_t cap);
+
+  // Install before arming timers: existing deadlines are not translated.
+  static void     setClock(SchedulerClock clock); // nullptr restores millis()
+  static uint32_t now();
+
+  // Override OTEL_EXPORT_ALIGN_MS at runtime (0 disables alignment). Applies
+  // to deadlines armed after the call.
+  static void     setAlignment(uint32_t windowMs);
+  static uint32_t alignment();
+
+  // Drop every timer and restart the wheel from the current clock (tests)
+  static void reset();
+
+private:
+  struct Timer {
+    SchedulerTask fn = nullptr;
+    void*    ctx      = nullptr;
+    uint32_t deadline = 0;   // absolute, in clock ms
+    uint32_t period   = 0;   // 0 = one-shot
+    int8_t   next     = -1;  // next timer in the same wheel slot
+    bool     inUse    = false;
+    bool     armed    = false;
+  };
+
+  static uint32_t alignUp_(uint32_t t);
+  static void     insert_(int id, uint32_t deadline);
+  static void     unlink_(int id);
+
+  static Timer    timers_[OTEL_SCHED_MAX_TIMERS];
+  static int8_t   slots_[OTEL_SCHED_WHEEL_SLOTS];
+  static uint32_t cursorTick_;
+  static bool     started_;
+  static uint32_t alignMs_;
+  static SchedulerClock clock_;
+};
+
+} // namespace OTel
+
+#endif // OTEL_SCHEDULER_H
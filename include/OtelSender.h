@@ -13,13 +13,101 @@
 #define OTEL_WORKER_BURST 8
 #endif
 
+// 0: the worker sleeps until a producer wakes it or a timer falls due.
+// > 0: it polls the queue at this interval instead.
 #ifndef OTEL_WORKER_SLEEP_MS
 #define OTEL_WORKER_SLEEP_MS 0
 #endif
 
+// Longest the idle worker sleeps, so hooks that never call wake() still run
+#ifndef OTEL_WORKER_IDLE_MS
+#define OTEL_WORKER_IDLE_MS 1000
+#endif
+
 #ifndef OTEL_QUEUE_CAPACITY
 #define OTEL_QUEUE_CAPACITY 128
 #endif
+
+// Per-signal queue lanes. Each lane has its own capacity (by default a share
+// of OTEL_QUEUE_CAPACITY) so a log storm cannot crowd out metrics or traces.
+#ifndef OTEL_QUEUE_CAPACITY_TRACES
+#define OTEL_QUEUE_CAPACITY_TRACES (OTEL_QUEUE_CAPACITY * 3 / 8)
+#endif
+#ifndef OTEL_QUEUE_CAPACITY_LOGS
+#define OTEL_QUEUE_CAPACITY_LOGS (OTEL_QUEUE_CAPACITY * 3 / 8)
+#endif
+#ifndef OTEL_QUEUE_CAPACITY_METRICS
+#define OTEL_QUEUE_CAPACITY_METRICS (OTEL_QUEUE_CAPACITY / 4)
+#endif
+
+// Deficit-round-robin: each visit a lane may dequeue weight * quantum bytes
+#ifndef OTEL_LANE_QUANTUM_BYTES
+#define OTEL_LANE_QUANTUM_BYTES 1024
+#endif
+#ifndef OTEL_LANE_WEIGHT_TRACES
+#define OTEL_LANE_WEIGHT_TRACES 2
+#endif
+#ifndef OTEL_LANE_WEIGHT_LOGS
+#define OTEL_LANE_WEIGHT_LOGS 1
+#endif
+#ifndef OTEL_LANE_WEIGHT_METRICS
+#define OTEL_LANE_WEIGHT_METRICS 2
+#endif
+
+// Maximum number of worker hooks (functions run by the worker on every pass),
+// and of flush hooks. The library itself uses up to OTEL_BUILTIN_WORKER_HOOKS:
+// deferred logs, log dedup, metric collection, ISR event drain, trace assembly
+// and the flight recorder.
+#define OTEL_BUILTIN_WORKER_HOOKS 6
+#ifndef OTEL_WORKER_MAX_HOOKS
+#define OTEL_WORKER_MAX_HOOKS 8
+#endif
+
+// ESP32 background worker task (FreeRTOS); started by beginAsyncWorker()
+#ifndef OTEL_WORKER_STACK
+#define OTEL_WORKER_STACK 8192
+#endif
+#ifndef OTEL_WORKER_PRIORITY
+#define OTEL_WORKER_PRIORITY 1
+#endif
+#ifndef OTEL_WORKER_CORE
+#define OTEL_WORKER_CORE 0
+#endif
+
+// What enqueue does when the queue is full (see OTelQueuePolicy)
+#define OTEL_QUEUE_DROP_OLDEST 0
+#define OTEL_QUEUE_DROP_NEWEST 1
+#define OTEL_QUEUE_BLOCK       2
+#define OTEL_QUEUE_PRIORITY    3
+#ifndef OTEL_QUEUE_POLICY
+#define OTEL_QUEUE_POLICY OTEL_QUEUE_DROP_OLDEST
+#endif
+// OTEL_QUEUE_BLOCK: longest a producer waits for space before dropping the new item
+#ifndef OTEL_QUEUE_BLOCK_TIMEOUT_MS
+#define OTEL_QUEUE_BLOCK_TIMEOUT_MS 20
+#endif
+
+// Worker-side batching: records of one signal are merged into one request and
+// sent once the oldest has waited OTEL_BATCH_DELAY_MS (0 = send on arrival)
+#ifndef OTEL_BATCH_DELAY_MS
+#define OTEL_BATCH_DELAY_MS 1000
+#endif
+// Largest encoded request. Batches are split at record boundaries to stay under
+// it; a single record that is still larger (after the attribute limits in
+// OtelDefaults.h) is dropped and counted in oversizeCount().
+#ifndef OTEL_MAX_REQUEST_BYTES
+#define OTEL_MAX_REQUEST_BYTES 8192
+#endif
+
+// Failed exports (network error, HTTP 429/502/503/504) are retried up to
+// OTEL_RETRY_MAX times with exponential backoff starting at OTEL_RETRY_BASE_MS
+#ifndef OTEL_RETRY_MAX
+#define OTEL_RETRY_MAX 3
+#endif
+#ifndef OTEL_RETRY_BASE_MS
+#define OTEL_RETRY_BASE_MS 1000
+#endif
+
 // Base URL of your OTLP/HTTP collector (no trailing slash), e.g. "http://192.168.8.50:4318"
 // You can override this via build_flags: -DOTEL_COLLECTOR_BASE_URL="\"http://…:4318\""
 #ifndef OTEL_COLLECTOR_BASE_URL
@@ -32,45 +120,217 @@
 #define OTEL_QUEUE_CAPACITY 16
 #endif
 
+namespace OTel {
+class Exporter;                     // OtelExporter.h
+enum class ExportResult : uint8_t;
+}
+
+enum class OTelQueuePolicy : uint8_t {
+  DropOldest = OTEL_QUEUE_DROP_OLDEST, // evict the oldest queued item
+  DropNewest = OTEL_QUEUE_DROP_NEWEST, // reject the incoming item
+  Block      = OTEL_QUEUE_BLOCK,       // wait up to the timeout, then reject
+  Priority   = OTEL_QUEUE_PRIORITY,    // evict the oldest lowest-priority item,
+                                       // or reject the incoming one if it ranks lower
+};
+
+// Signal index used by the per-signal counters
+enum class OTelSignal : uint8_t { Traces = 0, Logs = 1, Metrics = 2 };
+
+// Priority of a queued request: debug logs and unsampled spans go first,
+// error logs last.
+enum class OTelPriority : uint8_t { Low = 0, Normal = 1, High = 2, Critical = 3 };
+
 struct OTelQueuedItem {
-  const char* path;   // "/v1/logs", "/v1/traces", "/v1/metrics"
+  const char* path = nullptr; // "/v1/logs", "/v1/traces", "/v1/metrics"
   String payload;     // serialized JSON
+  OTelPriority priority = OTelPriority::Normal;
+  uint32_t enqueuedMs = 0;
+};
+
+// Snapshot of one queue lane
+struct OTelLaneStats {
+  size_t   depth;          // items waiting now
+  size_t   capacity;
+  uint32_t sent;           // items handed to the exporter
+  uint32_t dropped;        // all priorities
+  uint32_t lastLatencyMs;  // enqueue -> dequeue of the most recent item
+  uint32_t avgLatencyMs;   // moving average (1/8 weight per item)
+  uint32_t maxLatencyMs;
+};
+
+// Outcome of OTelSender::flush() / shutdown(), counted in records (sendJson calls)
+struct OTelFlushResult {
+  uint32_t delivered = 0;     // accepted by the exporter during the call
+  uint32_t abandoned = 0;     // rejected, or still pending when the deadline passed
+  bool     complete  = false; // nothing was left behind
 };
 
 class OTelSender {
 public:
   // Main API: called by logger/tracer/metrics to send serialized JSON to OTLP/HTTP
-  static void sendJson(const char* path, JsonDocument& doc);
+  // `scratch` (optional) is a reusable output buffer, e.g. JsonLease::scratch();
+  // it keeps its capacity when the record is batched on the worker.
+  static void sendJson(const char* path, JsonDocument& doc,
+                       OTelPriority priority = OTelPriority::Normal,
+                       String* scratch = nullptr);
+
+  // Route a signal's requests to another exporter (OtelExporter.h): file,
+  // Serial, in-memory, or an HttpExporter with another base URL. nullptr
+  // restores the default OTLP/HTTP exporter. The exporter must outlive its use.
+  static void setExporter(OTelSignal signal, OTel::Exporter* exporter);
+  static void setExporter(OTel::Exporter* exporter);   // every signal
+  static OTel::Exporter& exporter(OTelSignal signal);
 
-  // Start the RP2040 core-1 worker (no-op on non-RP2040). Call once after Wi-Fi is ready.
+  // Full-queue behaviour (defaults to OTEL_QUEUE_POLICY / OTEL_QUEUE_BLOCK_TIMEOUT_MS).
+  // Block only waits while a background worker is draining the queue.
+  static void setQueuePolicy(OTelQueuePolicy policy,
+                             uint32_t blockTimeoutMs = OTEL_QUEUE_BLOCK_TIMEOUT_MS);
+
+  // Start the background worker: core 1 on RP2040, a FreeRTOS task on ESP32
+  // (no-op elsewhere). Call once after Wi-Fi is ready.
   static void beginAsyncWorker();
 
+  // Register a function the worker runs on every pass before draining the queue
+  // (e.g. formatting deferred log records). Returns false if all slots are used.
+  static bool addWorkerHook(void (*fn)());
+
+  // Export everything queued, batched or waiting for a retry right now, e.g.
+  // before esp_deep_sleep_start() or an OTA reboot. Returns after at most
+  // timeoutMs (on the Scheduler clock). Records still pending at the deadline
+  // stay queued.
+  static OTelFlushResult flush(uint32_t timeoutMs);
+  // flush(), then discard what is left; later sends are dropped
+  static OTelFlushResult shutdown(uint32_t timeoutMs);
+  // Register a function run at the start of every flush (e.g. a final metric
+  // collection). Returns false if all slots are used.
+  static bool addFlushHook(void (*fn)());
+  // addWorkerHook() and addFlushHook() for a subsystem (either may be null).
+  // Prints an "[otel]" error naming `owner` and returns false if a table is full.
+  static bool addHooks(const char* owner, void (*worker)(), void (*flushFn)());
+
+  // Wake the background worker now instead of at its next deadline, e.g. after
+  // handing work to a hook. Sends wake it on their own. Cheap; any task or core.
+  static void wake();
+
+  // Run one worker pass on the calling thread: hooks, up to OTEL_WORKER_BURST
+  // queued items, then due scheduler timers (batch flushes, retries, metric
+  // collection). Call from loop() on boards without a background worker (ESP8266);
+  // once it has been called, sends are queued and batched there as well.
+  static void service();
+
+  // Called around each burst of exports, e.g. to wake the radio before the
+  // first request and let it sleep again afterwards. Combine with
+  // OTEL_EXPORT_ALIGN_MS so every signal exports in the same window.
+  static void setExportWindowHooks(void (*open)(), void (*close)());
+
   // Diagnostics (published via your health metrics if you like)
   static uint32_t droppedCount();   // number of items dropped due to full queue
+  static uint32_t droppedCount(OTelSignal signal, OTelPriority priority);
+  static OTelLaneStats laneStats(OTelSignal signal);
+
+  // Relative share of worker dequeues for a lane (deficit round robin; >= 1)
+  static void setLaneWeight(OTelSignal signal, uint8_t weight);
   static bool     queueIsHealthy(); // worker started?
+  static uint32_t exportFailures(); // requests abandoned after failing (and retries)
+  static uint32_t oversizeCount();  // records larger than OTEL_MAX_REQUEST_BYTES
 
 private:
-  // ---------- SPSC ring buffer (core0 producer -> core1 consumer) ----------
-  static constexpr size_t QCAP = OTEL_QUEUE_CAPACITY;
-  static OTelQueuedItem q_[QCAP];
-  static std::atomic<size_t> head_;   // producer writes
-  static std::atomic<size_t> tail_;   // consumer writes
+  // ---------- Lanes: one ring buffer per signal (producers -> worker) ----------
+  struct Lane {
+    OTelQueuedItem*     q;
+    size_t              cap;
+    std::atomic<size_t> head;       // producer writes
+    std::atomic<size_t> tail;       // consumer writes
+    uint8_t             weight;
+    size_t              deficit;    // worker only
+    std::atomic<uint32_t> sent;
+    std::atomic<uint32_t> latLast, latAvg, latMax;
+  };
+  static OTelQueuedItem qTraces_[OTEL_QUEUE_CAPACITY_TRACES];
+  static OTelQueuedItem qLogs_[OTEL_QUEUE_CAPACITY_LOGS];
+  static OTelQueuedItem qMetrics_[OTEL_QUEUE_CAPACITY_METRICS];
+  static Lane lanes_[3];
+  static size_t rr_;                  // next lane to visit (worker only)
   static std::atomic<uint32_t> drops_;
+  static std::atomic<uint32_t> drops_by_[3][4]; // [signal][priority]
+  static OTelQueuePolicy policy_;
+  static uint32_t        block_timeout_ms_;
   static std::atomic<bool>    worker_started_;
 
-  static bool enqueue_(const char* path, String&& payload);
-  static bool dequeue_(OTelQueuedItem& out);
+  static void (*hooks_[OTEL_WORKER_MAX_HOOKS])();
+  static std::atomic<size_t> hook_count_;
+  static void (*flush_hooks_[OTEL_WORKER_MAX_HOOKS])();
+  static std::atomic<size_t> flush_hook_count_;
+
+  // flush() handshake with the background worker: each caller takes a ticket
+  // and waits until the worker has served it. A flush that timed out leaves
+  // nothing behind for the next one to mistake for its own.
+  static std::atomic<uint32_t> flush_requested_;  // last ticket handed out
+  static std::atomic<uint32_t> flush_served_;     // last ticket the worker served
+  static std::atomic<uint32_t> flush_deadline_;   // stored before the ticket is taken
+  static std::atomic<bool> shut_down_;            // set before shutdown() takes its ticket
+
+  static bool enqueue_(const char* path, String&& payload, OTelPriority priority);
+  static void countDrop_(const char* path, OTelPriority priority);
+  static bool dequeue_(Lane& lane, size_t maxBytes, OTelQueuedItem& out, size_t& size);
+  static size_t drainLanes_(size_t budget); // weighted DRR over the lanes
+
+  // ---------- Batches (worker side, one per signal) ----------
+  struct Batch {
+    const char* path;        // "/v1/traces", ...
+    const char* key;         // "resourceSpans", ...
+    String      body;        // comma-joined resource entries awaiting export
+    String      request;     // envelope + body, rebuilt in place at each flush (non-streaming exporters)
+    String      retry;       // one failed request awaiting its next attempt
+    uint16_t    items;       // records in body
+    uint16_t    retryItems;  // records in retry
+    uint8_t     attempts;
+    int         flushTimer;
+    int         retryTimer;
+  };
+  static Batch batches_[3];
+  static std::atomic<OTel::Exporter*> exporters_[3]; // nullptr = default HTTP
+  static std::atomic<uint32_t> export_failures_;
+  static std::atomic<uint32_t> oversize_;
+  static std::atomic<uint32_t> delivered_records_;  // flush() accounting
+  static std::atomic<uint32_t> failed_records_;
+  static std::atomic<uint32_t> batched_records_;    // in batch bodies and retry slots
+
+  static void initBatches_();
+  static void acceptBatch_(const char* path, String& payload);
+  static void flushBatch_(Batch& b);
+  static void export_(Batch& b, const String& payload);
+  static bool claimRetry_(Batch& b, OTel::ExportResult result, uint16_t items); // true: caller fills b.retry
+  static void tally_(OTel::ExportResult result, uint32_t items);
+  static void flushNow_(uint32_t deadline, bool discard);
+  static uint32_t pendingRecords_();
+  static OTelFlushResult flush_(uint32_t timeoutMs, bool discard);
+  static void buildRequest_(String& out, const Batch& b);
+  static void flushTimer_(void* batch);
+  static void retryTimer_(void* batch);
 
   // ---------- Worker ----------
-  static void pumpOnce_();   // send one item if present
-  static void workerLoop_(); // runs on core 1 (RP2040)
+  static void runHooks_();
+  static void workerPass_(); // hooks, queue burst, scheduler timers
+  static void workerLoop_(); // runs on core 1 (RP2040) / worker task (ESP32)
+  static bool lanesPending_();
+  static void waitForWork_(uint32_t ms);
   static void launchWorkerOnce_();
+  static bool inWorker_();   // true when called from the worker itself
 
   // ---------- Utilities ----------
-  static String fullUrl_(const char* path); // build collector URL + path
+  static OTel::ExportResult deliver_(const char* path, const String& payload);
+  static void   openWindow_();
+  static void   closeWindow_();
+
+  static bool servicing_;      // inside service() on the caller's thread
+  static bool serviced_;       // service() has been called at least once
+  static bool window_open_;
+  static void (*window_open_hook_)();
+  static void (*window_close_hook_)();
 
   // inside class OTelSender (near the bottom)
-#ifdef ARDUINO_ARCH_RP2040
+#if defined(ARDUINO_ARCH_RP2040) || defined(ESP32)
   friend void otel_worker_entry();
 #endif
 };
@@ -0,0 +1,58 @@
+// OtelTraceAssembly.h
+#ifndef OTEL_TRACE_ASSEMBLY_H
+#define OTEL_TRACE_ASSEMBLY_H
+
+#include <Arduino.h>
+#include <vector>
+
+// 1 = hold ended spans per trace and export the whole local trace in one
+// request when its local root span ends (Tracer::setTraceAssembly() at run time)
+#ifndef OTEL_TRACE_ASSEMBLY
+#define OTEL_TRACE_ASSEMBLY 0
+#endif
+
+// Encoded bytes of spans held per trace. Reaching it exports what is held so
+// far; keep it well below OTEL_MAX_REQUEST_BYTES to leave room for the root.
+#ifndef OTEL_TRACE_ASSEMBLY_BYTES
+#define OTEL_TRACE_ASSEMBLY_BYTES 4096
+#endif
+
+// Held spans of a trace whose root has not ended after this long are exported
+#ifndef OTEL_TRACE_ASSEMBLY_TIMEOUT_MS
+#define OTEL_TRACE_ASSEMBLY_TIMEOUT_MS 10000
+#endif
+
+// Traces assembled at once; one more evicts (exports) the oldest
+#ifndef OTEL_TRACE_ASSEMBLY_SLOTS
+#define OTEL_TRACE_ASSEMBLY_SLOTS 2
+#endif
+
+namespace OTel {
+
+// Encoded span objects ({"traceId":...}) exported together
+using HeldSpans     = std::vector<String>;
+using HeldSpansSink = void (*)(HeldSpans&);
+
+// Per-trace buffers of ended child spans, shared by every thread that ends
+// spans and the worker (timeouts). Spans that leave early (budget, timeout,
+// eviction) are handed to the sink outside the lock.
+class TraceAssembly {
+public:
+  static void setEnabled(bool on);
+  static bool enabled();
+
+  // Keep an ended child span until its local root ends. `sink` sends spans
+  // that cannot wait; the first call also starts expiry on the worker.
+  static void hold(const String& traceId, String&& spanJson, HeldSpansSink sink);
+
+  // Move the spans held for `traceId` into `out` and forget the trace
+  static void release(const String& traceId, HeldSpans& out);
+
+  // Send traces held longer than OTEL_TRACE_ASSEMBLY_TIMEOUT_MS (all with
+  // `all`) to the sink. Returns the number of traces sent.
+  static size_t expire(bool all = false);
+};
+
+} // namespace OTel
+
+#endif // OTEL_TRACE_ASSEMBLY_H
@@ -6,10 +6,14 @@
 #include <ArduinoJson.h>
 #include <utility>
 #include <functional>
+#include <atomic>
 #include <vector>              // NEW: needed for attributes/events buffers
 #include "OtelDebug.h"
 #include "OtelDefaults.h"   // expects: nowUnixNano()
 #include "OtelSender.h"     // expects: OTelSender::sendJson(const char* path, const JsonDocument&)
+#include "OtelWorkspace.h"  // JsonLease: reusable per-signal document + output buffer
+#include "OtelTraceAssembly.h"
+#include "OtelFlightRecorder.h"
 
 #if defined(ESP32)
   #include <esp_system.h>   // esp_random, esp_fill_random
@@ -21,16 +25,33 @@
   #include <pico/rand.h>    // get_rand_32()
 #endif
 
+// Longest W3C tracestate we keep/forward. The spec asks propagators to handle
+// at least 512 chars; lower it on tight RAM budgets (longer values are truncated
+// on a list-member boundary).
+#ifndef OTEL_TRACESTATE_MAX_LEN
+#define OTEL_TRACESTATE_MAX_LEN 512
+#endif
+
+// Span processors Tracer::addSpanProcessor() accepts
+#ifndef OTEL_MAX_SPAN_PROCESSORS
+#define OTEL_MAX_SPAN_PROCESSORS 4
+#endif
+
 namespace OTel {
     
 // ---- Active Trace Context ---------------------------------------------------
 struct TraceContext {
-  String traceId;  // 32 hex chars
-  String spanId;   // 16 hex chars
+  String traceId;     // 32 hex chars
+  String spanId;      // 16 hex chars
+  String tracestate;  // W3C tracestate inherited from the remote parent (may be empty)
+  bool   sampled = true; // W3C sampled flag of the active trace
+  bool   remote  = false; // spanId belongs to another process (RemoteParentScope)
   bool valid() const { return traceId.length() == 32 && spanId.length() == 16; }
 };
 
-static inline TraceContext& currentTraceContext() {
+// `inline` (not `static`): one context shared by every translation unit,
+// so spans started in sketch code are visible to src/*.cpp (e.g. metrics).
+inline TraceContext& currentTraceContext() {
   static TraceContext ctx;
   return ctx;
 }
@@ -38,7 +59,7 @@ static inline TraceContext& currentTraceContext() {
 // --- New: Context Propagation (extract + scope) ------------------------------
 struct ExtractedContext {
   TraceContext ctx;
-  String tracestate;   // optional; unused for now but kept for future injection
+  String tracestate;   // optional; forwarded on inject once installed via RemoteParentScope
   bool sampled = true; // from flags; default true if unknown
   bool valid() const { return ctx.valid(); }
 };
@@ -49,46 +70,294 @@ struct KeyValuePairs {
   std::function<String(const String&)> get;
 };
 
+// Allocation-free counterpart of ExtractedContext. Everything lives in fixed
+// buffers, so extraction on every incoming MQTT/HTTP message never touches the heap.
+struct RawTraceContext {
+  char     traceId[33] = {0};
+  char     spanId[17]  = {0};
+  uint8_t  flags       = 0;
+  char     tracestate[OTEL_TRACESTATE_MAX_LEN + 1] = {0};
+  size_t   tracestateLen = 0;
+
+  bool valid()   const { return traceId[0] != '\0' && spanId[0] != '\0'; }
+  bool sampled() const { return (flags & 0x01) != 0; }
+  void clear() {
+    traceId[0] = spanId[0] = tracestate[0] = '\0';
+    flags = 0;
+    tracestateLen = 0;
+  }
+};
+
+// Lowercase hex only, as required by W3C Trace Context. Returns -1 otherwise.
+static inline int hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+// True if s[0..n) is lowercase hex and not all zeros (all-zero IDs are invalid)
+static inline bool isValidHexId(const char* s, size_t n) {
+  bool nonZero = false;
+  for (size_t i = 0; i < n; ++i) {
+    int v = hexNibble(s[i]);
+    if (v < 0) return false;
+    nonZero |= (v != 0);
+  }
+  return nonZero;
+}
+
+// ---- Active IDs for interrupt handlers ----------------------------------------
+// Binary copy of the active trace/span IDs. ISRs must not read the Strings in
+// TraceContext, so every context switch below republishes them here under a
+// sequence counter; a reader that races a switch gets no context, never a mix.
+struct ActiveIds {
+  std::atomic<uint32_t> seq{0};
+  bool    valid = false;
+  uint8_t traceId[16] = {};
+  uint8_t spanId[8]   = {};
+};
+
+OTEL_ISR_ATTR inline ActiveIds& activeIds() {
+  static ActiveIds ids;
+  return ids;
+}
+
+static inline void hexToBytes(const String& hex, uint8_t* out, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = (uint8_t)((hexNibble(hex[2 * i]) << 4) | hexNibble(hex[2 * i + 1]));
+  }
+}
+
+// Call after changing currentTraceContext()'s IDs
+inline void publishActiveIds() {
+  const TraceContext& ctx = currentTraceContext();
+  ActiveIds& ids = activeIds();
+  const bool valid = ctx.valid() && isValidHexId(ctx.traceId.c_str(), 32) &&
+                     isValidHexId(ctx.spanId.c_str(), 16);
+  const uint32_t seq = ids.seq.load(std::memory_order_relaxed);
+  ids.seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  ids.valid = valid;
+  if (valid) {
+    hexToBytes(ctx.traceId, ids.traceId, 16);
+    hexToBytes(ctx.spanId,  ids.spanId,  8);
+  }
+  ids.seq.store(seq + 2, std::memory_order_release);
+}
+
+// Interrupt-safe and wait-free: false when there is no active span, or when
+// the context is being switched (an ISR may have interrupted the switch)
+OTEL_ISR_ATTR inline bool readActiveIds(uint8_t traceId[16], uint8_t spanId[8]) {
+  const ActiveIds& ids = activeIds();
+  for (int tries = 0; tries < 2; ++tries) {
+    const uint32_t before = ids.seq.load(std::memory_order_acquire);
+    if (before & 1) return false;
+    if (!ids.valid) return false;
+    memcpy(traceId, ids.traceId, 16);
+    memcpy(spanId,  ids.spanId,  8);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (ids.seq.load(std::memory_order_relaxed) == before) return true;
+  }
+  return false;
+}
+
 // W3C "traceparent": 00-<32 hex traceId>-<16 hex parentId>-<2 hex flags>
+// `out` is only written when the header is valid.
+static inline bool parseTraceparent(const char* tp, size_t len, RawTraceContext& out) {
+  if (!tp || len < 55) return false;
+  int v0 = hexNibble(tp[0]), v1 = hexNibble(tp[1]);
+  if (v0 < 0 || v1 < 0) return false;
+  const uint8_t version = (uint8_t)((v0 << 4) | v1);
+  if (version == 0xff) return false;              // forbidden version
+  if (version == 0x00 && len != 55) return false; // v00 is exactly 55 chars
+  if (len > 55 && tp[55] != '-') return false;    // future versions may only append fields
+  if (tp[2] != '-' || tp[35] != '-' || tp[52] != '-') return false;
+  if (!isValidHexId(tp + 3, 32) || !isValidHexId(tp + 36, 16)) return false;
+  int f0 = hexNibble(tp[53]), f1 = hexNibble(tp[54]);
+  if (f0 < 0 || f1 < 0) return false;
+
+  memcpy(out.traceId, tp + 3, 32);  out.traceId[32] = '\0';
+  memcpy(out.spanId,  tp + 36, 16); out.spanId[16]  = '\0';
+  out.flags = (uint8_t)((f0 << 4) | f1);
+  return true;
+}
+
+// B3 single header: b3 = traceId-spanId[-sampled[-parentSpanId]]
+// 64-bit trace IDs are left-padded to 128 bits. A bare sampling state
+// ("0", "1", "d") carries no context and is rejected.
+static inline bool parseB3Single(const char* b3, size_t len, RawTraceContext& out) {
+  if (!b3) return false;
+  const char* end = b3 + len;
+  const char* d1 = static_cast<const char*>(memchr(b3, '-', len));
+  if (!d1) return false;
+
+  const size_t tlen = (size_t)(d1 - b3);
+  if (tlen != 16 && tlen != 32) return false;
+  const char* sid = d1 + 1;
+  if (end - sid < 16) return false;
+  if (!isValidHexId(b3, tlen) || !isValidHexId(sid, 16)) return false;
+
+  uint8_t flags = 0;
+  const char* p = sid + 16;
+  if (p != end) {
+    if (*p++ != '-' || p == end) return false;
+    const char* d2 = static_cast<const char*>(memchr(p, '-', (size_t)(end - p)));
+    if ((d2 ? d2 : end) - p != 1) return false;
+    if (*p == '1' || *p == 'd') flags = 0x01;
+    else if (*p != '0') return false;
+    if (d2 && (end - (d2 + 1) != 16 || !isValidHexId(d2 + 1, 16))) return false;
+  }
+
+  if (tlen == 16) {
+    memset(out.traceId, '0', 16);
+    memcpy(out.traceId + 16, b3, 16);
+  } else {
+    memcpy(out.traceId, b3, 32);
+  }
+  out.traceId[32] = '\0';
+  memcpy(out.spanId, sid, 16); out.spanId[16] = '\0';
+  out.flags = flags;
+  return true;
+}
+
+// Copy a W3C tracestate into `out`. Surrounding whitespace is trimmed; values
+// longer than OTEL_TRACESTATE_MAX_LEN are truncated on a list-member boundary
+// (as the spec allows) and non-printable input is discarded.
+static inline bool setTracestate(const char* ts, size_t len, RawTraceContext& out) {
+  out.tracestate[0] = '\0';
+  out.tracestateLen = 0;
+  if (!ts) return false;
+  while (len && (*ts == ' ' || *ts == '\t')) { ++ts; --len; }
+  while (len && (ts[len - 1] == ' ' || ts[len - 1] == '\t')) --len;
+  if (len > OTEL_TRACESTATE_MAX_LEN) {
+    size_t cut = OTEL_TRACESTATE_MAX_LEN;
+    while (cut && ts[cut] != ',') --cut;
+    len = cut;
+  }
+  for (size_t i = 0; i < len; ++i) {
+    if ((uint8_t)ts[i] < 0x20 || (uint8_t)ts[i] > 0x7e) return false;
+  }
+  memcpy(out.tracestate, ts, len);
+  out.tracestate[len] = '\0';
+  out.tracestateLen = len;
+  return len > 0;
+}
+
+// Copy the fixed-buffer form into the String-based ExtractedContext
+static inline void toExtractedContext(const RawTraceContext& raw, ExtractedContext& out) {
+  out.ctx.traceId = raw.traceId;
+  out.ctx.spanId  = raw.spanId;
+  out.sampled     = raw.sampled();
+  out.tracestate  = raw.tracestateLen ? String(raw.tracestate) : String();
+}
+
+// String wrappers kept for existing callers
 static inline bool parseTraceparent(const String& tp, ExtractedContext& out) {
-  // Minimal, allocation-light parser
-  // Expect 55 chars with version "00" or at least the 4 parts separated by '-'
-  int p1 = tp.indexOf('-'); if (p1 < 0) return false;
-  int p2 = tp.indexOf('-', p1+1); if (p2 < 0) return false;
-  int p3 = tp.indexOf('-', p2+1); if (p3 < 0) return false;
-
-  String ver  = tp.substring(0, p1);
-  String tid  = tp.substring(p1+1, p2);
-  String psid = tp.substring(p2+1, p3);
-  String flg  = tp.substring(p3+1);
-
-  // Validate lengths per spec
-  if (tid.length() != 32 || psid.length() != 16 || flg.length() != 2) return false;
-
-  out.ctx.traceId = tid;
-  out.ctx.spanId  = psid;
-  // Flags: bit 0 = sampled
-  out.sampled = (strtoul(flg.c_str(), nullptr, 16) & 0x01) == 0x01;
+  RawTraceContext raw;
+  if (!parseTraceparent(tp.c_str(), tp.length(), raw)) return false;
+  toExtractedContext(raw, out);
   return out.valid();
 }
 
-// B3 single header: b3 = traceId-spanId-sampled
 static inline bool parseB3Single(const String& b3, ExtractedContext& out) {
-  // Minimal split (traceId-spanId-[sampling?])
-  int p1 = b3.indexOf('-'); if (p1 < 0) return false;
-  int p2 = b3.indexOf('-', p1+1);
-
-  String tid = (p1 > 0) ? b3.substring(0, p1) : "";
-  String sid = (p2 > 0) ? b3.substring(p1+1, p2) : b3.substring(p1+1);
-  String smp = (p2 > 0) ? b3.substring(p2+1) : "";
-
-  if (tid.length() != 32 || sid.length() != 16) return false;
-  out.ctx.traceId = tid;
-  out.ctx.spanId  = sid;
-  out.sampled = (smp == "1" || smp == "d");
+  RawTraceContext raw;
+  if (!parseB3Single(b3.c_str(), b3.length(), raw)) return false;
+  toExtractedContext(raw, out);
   return out.valid();
 }
 
+// ---- Streaming JSON member scan (no JsonDocument) ---------------------------
+// Walks the top-level members of a JSON object and hands each one to a visitor
+// as raw slices. Nested objects/arrays are skipped without being parsed, so
+// only the keys we care about are ever looked at.
+namespace json_scan {
+
+static inline const char* skipWs(const char* p, const char* e) {
+  while (p < e && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+  return p;
+}
+
+// p points at the opening quote. Returns the position after the closing quote
+// (nullptr if unterminated); [s, s+n) is the raw content.
+static inline const char* scanString(const char* p, const char* e,
+                                     const char*& s, size_t& n, bool& escaped) {
+  s = ++p;
+  escaped = false;
+  while (p < e) {
+    if (*p == '\\') { escaped = true; p += 2; continue; }
+    if (*p == '"')  { n = (size_t)(p - s); return p + 1; }
+    ++p;
+  }
+  return nullptr;
+}
+
+static inline const char* skipValue(const char* p, const char* e) {
+  if (p >= e) return nullptr;
+  const char* s; size_t n; bool esc;
+  if (*p == '"') return scanString(p, e, s, n, esc);
+  if (*p == '{' || *p == '[') {
+    int depth = 0;
+    while (p < e) {
+      if (*p == '"') { p = scanString(p, e, s, n, esc); if (!p) return nullptr; continue; }
+      if (*p == '{' || *p == '[') ++depth;
+      else if ((*p == '}' || *p == ']') && --depth == 0) return p + 1;
+      ++p;
+    }
+    return nullptr;
+  }
+  // number / true / false / null
+  const char* start = p;
+  while (p < e && *p != ',' && *p != '}' && *p != ']' &&
+         *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') ++p;
+  return p == start ? nullptr : p;
+}
+
+// Visitor: bool(const char* key, size_t keyLen, const char* val, size_t valLen, bool isString)
+// Return false from the visitor to stop early. Members containing escape
+// sequences are skipped (no propagation key or value needs them).
+template <typename Visitor>
+static inline bool forEachMember(const char* json, size_t len, Visitor visit) {
+  if (!json) return false;
+  const char* e = json + len;
+  const char* p = skipWs(json, e);
+  if (p >= e || *p != '{') return false;
+  p = skipWs(p + 1, e);
+  if (p < e && *p == '}') return true;
+
+  while (p < e) {
+    if (*p != '"') return false;
+    const char* k; size_t kn = 0; bool kesc;
+    p = scanString(p, e, k, kn, kesc);
+    if (!p) return false;
+    p = skipWs(p, e);
+    if (p >= e || *p != ':') return false;
+    p = skipWs(p + 1, e);
+    if (p >= e) return false;
+
+    const bool isString = (*p == '"');
+    const char* v = p; size_t vn = 0; bool vesc = false;
+    if (isString) {
+      p = scanString(p, e, v, vn, vesc);
+    } else {
+      p = skipValue(p, e);
+      vn = p ? (size_t)(p - v) : 0;
+    }
+    if (!p) return false;
+    if (!kesc && !vesc && !visit(k, kn, v, vn, isString)) return true;
+
+    p = skipWs(p, e);
+    if (p < e && *p == ',') { p = skipWs(p + 1, e); continue; }
+    return p < e && *p == '}';
+  }
+  return false;
+}
+
+static inline bool keyIs(const char* k, size_t n, const char* lit) {
+  return strlen(lit) == n && memcmp(k, lit, n) == 0;
+}
+
+} // namespace json_scan
+
 struct Propagators {
   // 1) Extract from header-like key/values (HTTP headers, MQTT v5 user props)
   static ExtractedContext extract(const KeyValuePairs& kv) {
@@ -100,7 +369,8 @@ struct Propagators {
       if (tp.length() == 0) tp = kv.get("Traceparent"); // some stacks capitalise
       if (tp.length() && parseTraceparent(tp, out)) {
         String ts = kv.get("tracestate"); if (ts.length() == 0) ts = kv.get("Tracestate");
-        out.tracestate = ts;
+        RawTraceContext raw;
+        if (setTracestate(ts.c_str(), ts.length(), raw)) out.tracestate = raw.tracestate;
         return out;
       }
 
@@ -111,108 +381,165 @@ struct Propagators {
     return out; // invalid
   }
 
-  // 2) Extract directly from JSON payload
-  static ExtractedContext extractFromJson(const String& json) {
-    ExtractedContext out;
-    if (json.length() == 0) return out;
-
-    // Use a small document to avoid heap bloat; adjust if payloads are larger
-    JsonDocument doc;
-    DeserializationError err = deserializeJson(doc, json);
-    if (err) return out;
-
-    if (doc["traceparent"].is<const char*>()) {
-      out = ExtractedContext{};
-      String tp = doc["traceparent"].as<String>();
-      parseTraceparent(tp, out);
-      if (doc["tracestate"].is<const char*>()) {
-        out.tracestate = doc["tracestate"].as<String>();
-      }
-      return out;
+  // 2) Extract directly from a JSON payload without deserializing it.
+  //    Precedence: traceparent (+tracestate), then trace_id/span_id(/trace_flags), then b3.
+  static bool extractFromJson(const char* json, size_t len, RawTraceContext& out) {
+    out.clear();
+    struct Slice { const char* p = nullptr; size_t n = 0; bool str = false; };
+    Slice tp, ts, tid, sid, tfl, b3;
+
+    bool wellFormed = json_scan::forEachMember(json, len,
+      [&](const char* k, size_t kn, const char* v, size_t vn, bool isStr) {
+        Slice s; s.p = v; s.n = vn; s.str = isStr;
+        if      (json_scan::keyIs(k, kn, "traceparent") && isStr) tp  = s;
+        else if (json_scan::keyIs(k, kn, "tracestate")  && isStr) ts  = s;
+        else if (json_scan::keyIs(k, kn, "trace_id")    && isStr) tid = s;
+        else if (json_scan::keyIs(k, kn, "span_id")     && isStr) sid = s;
+        else if (json_scan::keyIs(k, kn, "trace_flags"))          tfl = s;
+        else if (json_scan::keyIs(k, kn, "b3")          && isStr) b3  = s;
+        return true;
+      });
+    if (!wellFormed) return false;
+
+    if (tp.p) {
+      if (!parseTraceparent(tp.p, tp.n, out)) return false;
+      if (ts.p) setTracestate(ts.p, ts.n, out);
+      return true;
     }
 
-    if (doc["trace_id"].is<const char*>() && doc["span_id"].is<const char*>()) {
-      out = ExtractedContext{};
-      String tid = doc["trace_id"].as<String>();
-      String sid = doc["span_id"].as<String>();
-      out.ctx.traceId = tid;
-      out.ctx.spanId  = sid;
-      if (doc["trace_flags"].is<const char*>()) {
-        out.sampled = (String(doc["trace_flags"].as<const char*>()).indexOf("01") >= 0);
-      } else if (doc["trace_flags"].is<uint8_t>()) {
-        out.sampled = (doc["trace_flags"].as<uint8_t>() & 0x01) != 0;
+    if (tid.p && sid.p) {
+      if (tid.n != 32 || sid.n != 16) return false;
+      if (!isValidHexId(tid.p, 32) || !isValidHexId(sid.p, 16)) return false;
+      uint8_t flags = 0x01; // sampled unless told otherwise
+      if (tfl.p && tfl.str) {
+        // "01"-style hex string
+        int hi = tfl.n == 2 ? hexNibble(tfl.p[0]) : 0;
+        int lo = tfl.n ? hexNibble(tfl.p[tfl.n - 1]) : -1;
+        if (tfl.n >= 1 && tfl.n <= 2 && hi >= 0 && lo >= 0) flags = (uint8_t)((hi << 4) | lo);
+      } else if (tfl.p) {
+        // numeric flags: only the low bit matters
+        uint32_t n = 0;
+        for (size_t i = 0; i < tfl.n && tfl.p[i] >= '0' && tfl.p[i] <= '9'; ++i) n = n * 10 + (tfl.p[i] - '0');
+        flags = (uint8_t)(n & 0xff);
       }
-      return out;
+      memcpy(out.traceId, tid.p, 32); out.traceId[32] = '\0';
+      memcpy(out.spanId,  sid.p, 16); out.spanId[16]  = '\0';
+      out.flags = flags;
+      return true;
     }
 
-    if (doc["b3"].is<const char*>()) {
-      out = ExtractedContext{};
-      String b3 = doc["b3"].as<String>();
-      parseB3Single(b3, out);
-      return out;
-    }
+    if (b3.p) return parseB3Single(b3.p, b3.n, out);
 
-    return out; // invalid if none matched
+    return false; // none matched
   }
 
-// --- ADD these inside: struct OTel::Propagators { ... } ---
-
-// Generic injector: pass a setter that accepts (key, value).
-template <typename Setter>
-static inline void inject(Setter set, uint8_t flags = 0x01) {
-  const auto& ctx = OTel::currentTraceContext();
-
-  // Only inject if we actually have a valid active context
-  if (ctx.traceId.length() != 32 || ctx.spanId.length() != 16) {
-    return; // no active span/context; skip injection rather than invent IDs
+  static ExtractedContext extractFromJson(const String& json) {
+    ExtractedContext out;
+    RawTraceContext raw;
+    if (extractFromJson(json.c_str(), json.length(), raw)) toExtractedContext(raw, out);
+    return out;
   }
 
-  char tpbuf[64];
-  // "00-" + 32 + "-" + 16 + "-" + 2 = 55 chars
-  snprintf(tpbuf, sizeof(tpbuf), "00-%s-%s-%02x",
-           ctx.traceId.c_str(),
-           ctx.spanId.c_str(),
-           static_cast<unsigned>(flags));
+  // Write "00-<trace>-<span>-<flags>" into `out` (needs >= 56 bytes).
+  // Returns the length written, or 0 if the buffer is too small.
+  static inline size_t formatTraceparent(char* out, size_t cap,
+                                         const char* traceId, const char* spanId,
+                                         uint8_t flags) {
+    static const char hex[] = "0123456789abcdef";
+    if (!out || cap < 56) return 0;
+    char* p = out;
+    *p++ = '0'; *p++ = '0'; *p++ = '-';
+    memcpy(p, traceId, 32); p += 32; *p++ = '-';
+    memcpy(p, spanId, 16);  p += 16; *p++ = '-';
+    *p++ = hex[flags >> 4];
+    *p++ = hex[flags & 0x0F];
+    *p = '\0';
+    return 55;
+  }
 
-  set("traceparent", tpbuf);
+  // Active context -> caller-provided buffers. Both return 0 when there is
+  // nothing to inject (no active span / empty tracestate) or `cap` is too small.
+  static inline size_t injectTraceparent(char* out, size_t cap, uint8_t flags = 0x01) {
+    const auto& ctx = OTel::currentTraceContext();
+    if (!ctx.valid()) return 0; // no active span/context; skip rather than invent IDs
+    return formatTraceparent(out, cap, ctx.traceId.c_str(), ctx.spanId.c_str(), flags);
+  }
 
-  // NOTE: your TraceContext doesn't have tracestate; omit it to avoid compile errors.
-  // If you add tracestate in future, you can forward it here.
-}
+  static inline size_t injectTracestate(char* out, size_t cap) {
+    const String& ts = OTel::currentTraceContext().tracestate;
+    const size_t n = ts.length();
+    if (!out || n == 0 || n + 1 > cap) return 0;
+    memcpy(out, ts.c_str(), n + 1);
+    return n;
+  }
 
-// Convenience: inject into ArduinoJson JsonDocument payloads
-static inline void injectToJson(JsonDocument& doc, uint8_t flags = 0x01) {
-  inject([&](const char* k, const char* v){ doc[k] = v; }, flags);
-}
+  // Generic injector: pass a setter that accepts (key, value).
+  template <typename Setter>
+  static inline void inject(Setter set, uint8_t flags = 0x01) {
+    char tpbuf[56];
+    if (!injectTraceparent(tpbuf, sizeof(tpbuf), flags)) return;
+    set("traceparent", tpbuf);
 
-// Convenience: inject into HTTP headers via a generic adder (e.g., http.addHeader)
-template <typename HeaderAdder>
-static inline void injectToHeaders(HeaderAdder add, uint8_t flags = 0x01) {
-  inject(add, flags);
-}
+    const String& ts = OTel::currentTraceContext().tracestate;
+    if (ts.length()) set("tracestate", ts.c_str());
+  }
 
+  // Convenience: inject into ArduinoJson JsonDocument payloads
+  static inline void injectToJson(JsonDocument& doc, uint8_t flags = 0x01) {
+    inject([&](const char* k, const char* v){ doc[k] = v; }, flags);
+  }
 
+  // Convenience: inject into HTTP headers via a generic adder (e.g., http.addHeader)
+  template <typename HeaderAdder>
+  static inline void injectToHeaders(HeaderAdder add, uint8_t flags = 0x01) {
+    inject(add, flags);
+  }
 };
 
 // RAII helper: temporarily install a remote parent context as the active one
 class RemoteParentScope {
 public:
   RemoteParentScope(const TraceContext& incoming) {
-    // Save current
-    prev_ = currentTraceContext();
-    // Install incoming (only if valid; otherwise leave as-is)
+    install(incoming.traceId, incoming.spanId, incoming.tracestate,
+            incoming.sampled, incoming.valid());
+  }
+  RemoteParentScope(const ExtractedContext& incoming) {
+    install(incoming.ctx.traceId, incoming.ctx.spanId, incoming.tracestate,
+            incoming.sampled, incoming.valid());
+  }
+  RemoteParentScope(const RawTraceContext& incoming) {
     if (incoming.valid()) {
-      currentTraceContext().traceId = incoming.traceId;
-      currentTraceContext().spanId  = incoming.spanId;
+      prev_ = currentTraceContext();
+      currentTraceContext().traceId    = incoming.traceId;
+      currentTraceContext().spanId     = incoming.spanId;
+      currentTraceContext().tracestate = incoming.tracestateLen ? incoming.tracestate : "";
+      currentTraceContext().sampled    = incoming.sampled();
+      currentTraceContext().remote     = true;
+      publishActiveIds();
       installed_ = true;
     }
   }
   ~RemoteParentScope() {
     if (installed_) {
       currentTraceContext() = prev_;
+      publishActiveIds();
     }
   }
 private:
+  // Install incoming (only if valid; otherwise leave as-is)
+  void install(const String& traceId, const String& spanId,
+               const String& tracestate, bool sampled, bool valid) {
+    if (!valid) return;
+    prev_ = currentTraceContext();  // save current
+    currentTraceContext().traceId    = traceId;
+    currentTraceContext().spanId     = spanId;
+    currentTraceContext().tracestate = tracestate;
+    currentTraceContext().sampled    = sampled;
+    currentTraceContext().remote     = true;
+    publishActiveIds();
+    installed_ = true;
+  }
+
   TraceContext prev_;
   bool installed_ = false;
 };
@@ -418,14 +745,66 @@ struct TracerConfig {
   String scopeVersion{"0.1.0"};
 };
 
-static inline TracerConfig& tracerConfig() {
+inline TracerConfig& tracerConfig() {
   static TracerConfig cfg;
   return cfg;
 }
 
+// Resource and scope of an OTLP traces request; returns its (empty) spans array
+inline JsonArray beginTracesRequest(JsonDocument& doc) {
+  JsonObject rs = doc["resourceSpans"][0].to<JsonObject>();
+  JsonArray rattrs = rs["resource"]["attributes"].to<JsonArray>();
+  addResAttr(rattrs, "service.name",        defaultServiceName());
+  addResAttr(rattrs, "service.instance.id", defaultServiceInstanceId());
+  addResAttr(rattrs, "host.name",           defaultHostName());
+
+  JsonObject ss = rs["scopeSpans"][0].to<JsonObject>();
+  JsonObject scope = ss["scope"].to<JsonObject>();
+  scope["name"]    = tracerConfig().scopeName;
+  scope["version"] = tracerConfig().scopeVersion;
+  return ss["spans"].to<JsonArray>();
+}
+
+// Sends spans of a trace assembled without their root (budget, timeout, eviction)
+inline void sendHeldSpans(HeldSpans& held) {
+  JsonLease lease(OTelSignal::Traces);
+  JsonArray spans = beginTracesRequest(lease.doc());
+  for (const String& json : held) spans.add(serialized(json));
+  OTelSender::sendJson("/v1/traces", lease.doc(), OTelPriority::Normal, lease.scratch());
+}
+
+// ---- Span status and processors ---------------------------------------------
+// OTLP status codes
+enum class SpanStatus : uint8_t { Unset = 0, Ok = 1, Error = 2 };
+
+// What a span processor sees of a span as it ends
+struct SpanEnd {
+  const String& name;
+  SpanStatus    status;
+  uint64_t      startNs;
+  uint64_t      endNs;
+  bool          sampled;  // W3C sampled flag of its trace
+  bool          root;     // no local or remote parent
+};
+
+// Runs on the thread that ends the span, before the span is serialised or
+// queued, so it sees every span whatever happens to it afterwards
+using SpanProcessor = void (*)(const SpanEnd&);
+
+struct SpanProcessorTable {
+  SpanProcessor       fns[OTEL_MAX_SPAN_PROCESSORS];
+  std::atomic<size_t> count{0};
+};
+
+inline SpanProcessorTable& spanProcessors() {
+  static SpanProcessorTable table;
+  return table;
+}
+
 // ---- Span -------------------------------------------------------------------
 class Span {
 public:
+#if OTEL_ENABLE_TRACES
   explicit Span(const String& name)
   : name_(name),
     traceId_(currentTraceContext().valid() ? currentTraceContext().traceId : generateTraceId()),
@@ -436,9 +815,19 @@ public:
     // Save previous context and install this span's ids
     prevTraceId_ = currentTraceContext().traceId;
     prevSpanId_  = currentTraceContext().spanId;
+    prevRemote_  = currentTraceContext().remote;
+    localRoot_   = prevSpanId_.length() != 16 || prevRemote_;
+    // A new root trace is sampled; children inherit the parent's decision
+    if (prevSpanId_.length() != 16) currentTraceContext().sampled = true;
     currentTraceContext().traceId = traceId_;
     currentTraceContext().spanId  = spanId_;
+    currentTraceContext().remote  = false;
+    publishActiveIds();
   }
+#else
+  // Traces compiled out: no IDs, no context switch, nothing sent
+  explicit Span(const String&) : startNs_(0) {}
+#endif
 
   // RAII: if user forgets to call end(), do it at scope exit.
   ~Span() {
@@ -458,8 +847,14 @@ public:
     startNs_(o.startNs_),
     prevTraceId_(std::move(o.prevTraceId_)),
     prevSpanId_(std::move(o.prevSpanId_)),
+    prevRemote_(o.prevRemote_),
+    localRoot_(o.localRoot_),
     attrs_(std::move(o.attrs_)),
     events_(std::move(o.events_)),
+    droppedAttrs_(o.droppedAttrs_),
+    droppedEvents_(o.droppedEvents_),
+    status_(o.status_),
+    statusMessage_(std::move(o.statusMessage_)),
     ended_(o.ended_)
   {
     o.ended_ = true;          // source dtor becomes a no-op
@@ -476,8 +871,14 @@ public:
       startNs_     = o.startNs_;
       prevTraceId_ = std::move(o.prevTraceId_);
       prevSpanId_  = std::move(o.prevSpanId_);
+      prevRemote_  = o.prevRemote_;
+      localRoot_   = o.localRoot_;
       attrs_       = std::move(o.attrs_);
       events_      = std::move(o.events_);
+      droppedAttrs_  = o.droppedAttrs_;
+      droppedEvents_ = o.droppedEvents_;
+      status_        = o.status_;
+      statusMessage_ = std::move(o.statusMessage_);
       ended_       = o.ended_;
       o.ended_     = true;    // source won't end() again
       o.prevTraceId_ = "";
@@ -489,6 +890,7 @@ public:
   // ---------- NEW: span attributes API ---------------------------------------
   // These buffer attributes until end() and are rendered into OTLP JSON.
   Span& setAttribute(const String& key, const String& v) {
+    if (!OTEL_ENABLE_TRACES) return *this;
     //attrs_.push_back(Attr{key, Type::Str, v, 0, 0.0, false});
     Attr a;
     a.key  = key;
@@ -497,26 +899,30 @@ public:
     a.i    = 0;
     a.d    = 0.0;
     a.b    = false;
-    attrs_.push_back(a);
-    return *this;
+    return pushAttr_(a);
   }
   Span& setAttribute(const String& key, const char* v) {
     return setAttribute(key, String(v));
   }
   Span& setAttribute(const String& key, int64_t v) {
-    Attr a; a.key=key; a.type=Type::Int; a.i=v; attrs_.push_back(a); return *this;
+    if (!OTEL_ENABLE_TRACES) return *this;
+    Attr a; a.key=key; a.type=Type::Int; a.i=v; return pushAttr_(a);
   }
   Span& setAttribute(const String& key, double v) {
-    Attr a; a.key=key; a.type=Type::Dbl; a.d=v; attrs_.push_back(a); return *this;
+    if (!OTEL_ENABLE_TRACES) return *this;
+    Attr a; a.key=key; a.type=Type::Dbl; a.d=v; return pushAttr_(a);
   }
   Span& setAttribute(const String& key, bool v) {
-    Attr a; a.key=key; a.type=Type::Bool; a.b=v; attrs_.push_back(a); return *this;
+    if (!OTEL_ENABLE_TRACES) return *this;
+    Attr a; a.key=key; a.type=Type::Bool; a.b=v; return pushAttr_(a);
   }
 
   // ---------- NEW: span events API -------------------------------------------
   // 1) Event without attributes
   Span& addEvent(const String& name) {
+    if (!OTEL_ENABLE_TRACES) return *this;
     //events_.push_back(Event{name, nowUnixNano(), {}});
+    if (events_.size() >= OTEL_SPAN_EVENT_COUNT_LIMIT) { ++droppedEvents_; return *this; }
     Event e;
     e.name = name;
     e.t    = nowUnixNano();
@@ -525,13 +931,21 @@ public:
   }
   // 2) Event with simple (string) attributes — minimal footprint
   Span& addEvent(const String& name, const std::vector<std::pair<String,String>>& attrs) {
+    return addEventAt(nowUnixNano(), name, attrs);
+  }
+  // 3) Event that happened earlier (e.g. captured in an interrupt handler)
+  Span& addEventAt(uint64_t timeUnixNano, const String& name,
+                   const std::vector<std::pair<String,String>>& attrs = {}) {
+    if (!OTEL_ENABLE_TRACES) return *this;
     //Event e{name, nowUnixNano(), {}};
+    if (events_.size() >= OTEL_SPAN_EVENT_COUNT_LIMIT) { ++droppedEvents_; return *this; }
     // NEW
     Event e;
     e.name = name;
-    e.t    = nowUnixNano();
-    e.attrs.reserve(attrs.size());
+    e.t    = timeUnixNano;
+    e.attrs.reserve(attrs.size() < OTEL_ATTRIBUTE_COUNT_LIMIT ? attrs.size() : OTEL_ATTRIBUTE_COUNT_LIMIT);
     for (const auto& kv : attrs) {
+      if (e.attrs.size() >= OTEL_ATTRIBUTE_COUNT_LIMIT) { ++e.dropped; continue; }
       //e.attrs.push_back(Attr{kv.first, Type::Str, kv.second, 0, 0.0, false});
       Attr a;
         a.key  = kv.first;
@@ -540,35 +954,117 @@ public:
         a.i    = 0;
         a.d    = 0.0;
         a.b    = false;
+        truncateUtf8(a.s, OTEL_ATTRIBUTE_VALUE_LENGTH_LIMIT);
         e.attrs.push_back(a);
     }
     events_.push_back(e);
     return *this;
   }
 
+  // Ok is final and the message is kept for Error only, as the spec asks;
+  // Unset is ignored
+  Span& setStatus(SpanStatus code, const String& message = "") {
+    if (!OTEL_ENABLE_TRACES || code == SpanStatus::Unset || status_ == SpanStatus::Ok) return *this;
+    status_        = code;
+    statusMessage_ = code == SpanStatus::Error ? message : String();
+    truncateUtf8(statusMessage_, OTEL_ATTRIBUTE_VALUE_LENGTH_LIMIT);
+    return *this;
+  }
+
   // You can still call this manually; it's safe to call more than once.
   void end() {
     if (ended_) return;               // idempotent guard
     ended_ = true;
 
+#if OTEL_ENABLE_TRACES
     const uint64_t endNs = nowUnixNano();
 
-    // Build minimal OTLP/HTTP JSON payload for a single span
-    JsonDocument doc;
+    SpanProcessorTable& procs = spanProcessors();
+    const size_t nProcs = procs.count.load(std::memory_order_acquire);
+    if (nProcs) {
+      const SpanEnd info{ name_, status_, startNs_, endNs,
+                          currentTraceContext().sampled, prevSpanId_.length() != 16 };
+      for (size_t i = 0; i < nProcs; ++i) procs.fns[i](info);
+    }
+    if (FlightRecorder::enabled()) recordFlight_(endNs);
+
+    const bool assemble = TraceAssembly::enabled();
+    if (assemble && !localRoot_) {
+      // Child of a local span: held until the local root ends
+      String json;
+      {
+        JsonLease lease(OTelSignal::Traces);
+        writeSpan_(lease.doc().to<JsonObject>(), endNs);
+        serializeJson(lease.doc(), json);
+      }
+      TraceAssembly::hold(traceId_, std::move(json), sendHeldSpans);
+      restoreContext_();
+      return;
+    }
+
+    // Build OTLP/HTTP JSON payload: this span, after any children held for it
+    HeldSpans held;
+    if (assemble) TraceAssembly::release(traceId_, held);
+    JsonLease lease(OTelSignal::Traces);
+    JsonDocument& doc = lease.doc();
+    JsonArray spans = beginTracesRequest(doc);
+    for (const String& json : held) spans.add(serialized(json));
+    writeSpan_(spans.add<JsonObject>(), endNs);
+
+    // Send: unsampled spans are evicted first under backpressure, local roots last
+    const OTelPriority priority = !currentTraceContext().sampled ? OTelPriority::Low
+                                : prevSpanId_.length() != 16     ? OTelPriority::High
+                                                                 : OTelPriority::Normal;
+    OTelSender::sendJson("/v1/traces", doc, priority, lease.scratch());
+
+    restoreContext_();
+#endif
+  }
 
-    // resourceSpans[0].resource.attributes[...]
-    JsonArray rattrs = doc["resourceSpans"][0]["resource"]["attributes"].to<JsonArray>();
-    addResAttr(rattrs, "service.name",        defaultServiceName());
-    addResAttr(rattrs, "service.instance.id", defaultServiceInstanceId());
-    addResAttr(rattrs, "host.name",           defaultHostName());
+  // Optional helpers (if you have them already, keep yours)
+  const String& traceId() const { return traceId_; }
+  const String& spanId()  const { return spanId_;  }
 
-    // instrumentation scope
-    JsonObject scope = doc["resourceSpans"][0]["scopeSpans"][0]["scope"].to<JsonObject>();
-    scope["name"]    = tracerConfig().scopeName;
-    scope["version"] = tracerConfig().scopeVersion;
+private:
+#if OTEL_ENABLE_TRACES
+  // Restore previous active context
+  void restoreContext_() {
+    currentTraceContext().traceId = prevTraceId_;
+    currentTraceContext().spanId  = prevSpanId_;
+    currentTraceContext().remote  = prevRemote_;
+    publishActiveIds();
+  }
 
-    // span body
-    JsonObject s = doc["resourceSpans"][0]["scopeSpans"][0]["spans"][0].to<JsonObject>();
+  // Binary copy for the flight recorder, in the layout OtelFlightRecorder.h describes
+  void recordFlight_(uint64_t endNs) const {
+    static_assert(OTEL_ATTRIBUTE_COUNT_LIMIT <= 255 && OTEL_SPAN_EVENT_COUNT_LIMIT <= 255,
+                  "flight recorder counts are one byte");
+    using Rec = FlightRecorder::Record;
+    size_t n = 16 + 8 + 8 + 8 + 8 + 1 + Rec::strBytes(name_.length()) +
+               Rec::strBytes(statusMessage_.length()) + flightAttrBytes_(attrs_) + 1;
+    for (const auto& ev : events_) n += 8 + Rec::strBytes(ev.name.length()) + flightAttrBytes_(ev.attrs);
+
+    Rec r(FlightRecorder::kSpan, n);
+    if (!r) return;
+    r.putHexId(traceId_.c_str(), 16);
+    r.putHexId(spanId_.c_str(), 8);
+    r.putHexId(prevSpanId_.c_str(), 8);
+    r.putU64(startNs_);
+    r.putU64(endNs);
+    r.putU8((uint8_t)status_);
+    r.putStr(name_);
+    r.putStr(statusMessage_);
+    putFlightAttrs_(r, attrs_);
+    r.putU8((uint8_t)events_.size());
+    for (const auto& ev : events_) {
+      r.putU64(ev.t);
+      r.putStr(ev.name);
+      putFlightAttrs_(r, ev.attrs);
+    }
+  }
+
+  // span body
+  void writeSpan_(JsonObject s, uint64_t endNs) const {
     s["traceId"]           = traceId_;
     s["spanId"]            = spanId_;
     s["name"]              = name_;
@@ -580,6 +1076,13 @@ public:
     if (prevSpanId_.length() == 16) {
       s["parentSpanId"] = prevSpanId_;
     }
+    if (droppedAttrs_)  s["droppedAttributesCount"] = droppedAttrs_;
+    if (droppedEvents_) s["droppedEventsCount"]     = droppedEvents_;
+    if (status_ != SpanStatus::Unset) {
+      JsonObject st = s["status"].to<JsonObject>();
+      st["code"] = (int)status_;
+      if (statusMessage_.length()) st["message"] = statusMessage_;
+    }
 
     // ---------- NEW: serialise span attributes (if any) -----------------------
     if (!attrs_.empty()) {
@@ -604,6 +1107,7 @@ public:
         JsonObject e = evs.add<JsonObject>();
         e["timeUnixNano"] = u64ToStr(ev.t);
         e["name"] = ev.name;
+        if (ev.dropped) e["droppedAttributesCount"] = ev.dropped;
 
         if (!ev.attrs.empty()) {
           JsonArray ea = e["attributes"].to<JsonArray>();
@@ -621,26 +1125,8 @@ public:
         }
       }
     }
-
-    // Send
-    OTelSender::sendJson("/v1/traces", doc);
-
-    // Restore previous active context
-    currentTraceContext().traceId = prevTraceId_;
-    currentTraceContext().spanId  = prevSpanId_;
-  }
-
-  // Optional helpers (if you have them already, keep yours)
-  const String& traceId() const { return traceId_; }
-  const String& spanId()  const { return spanId_;  }
-
-private:
-  // Utility to add a resource attribute
-  static inline void addResAttr(JsonArray& arr, const char* key, const String& val) {
-    JsonObject a = arr.add<JsonObject>();
-    a["key"] = key;
-    a["value"]["stringValue"] = val;
   }
+#endif
 
   static inline String u64ToStr(uint64_t v) {
     // Avoid ambiguous Arduino String(uint64_t) by formatting manually
@@ -663,9 +1149,45 @@ private:
     String name;
     uint64_t t{0};
     std::vector<Attr> attrs;
+    uint32_t dropped{0}; // attributes over OTEL_ATTRIBUTE_COUNT_LIMIT
   };
 
 private:
+  // Flight recorder encoding of an attribute list
+  static size_t flightAttrBytes_(const std::vector<Attr>& attrs) {
+    size_t n = 1;
+    for (const auto& at : attrs) {
+      n += 1 + FlightRecorder::Record::strBytes(at.key.length());
+      switch (at.type) {
+        case Type::Str:  n += FlightRecorder::Record::strBytes(at.s.length()); break;
+        case Type::Int:
+        case Type::Dbl:  n += 8; break;
+        case Type::Bool: n += 1; break;
+      }
+    }
+    return n;
+  }
+
+  static void putFlightAttrs_(FlightRecorder::Record& r, const std::vector<Attr>& attrs) {
+    r.putU8((uint8_t)attrs.size());
+    for (const auto& at : attrs) {
+      switch (at.type) {
+        case Type::Str:  r.putU8(FlightRecorder::kAttrStr);  r.putStr(at.key); r.putStr(at.s); break;
+        case Type::Int:  r.putU8(FlightRecorder::kAttrInt);  r.putStr(at.key); r.put(&at.i, 8); break;
+        case Type::Dbl:  r.putU8(FlightRecorder::kAttrDbl);  r.putStr(at.key); r.put(&at.d, 8); break;
+        case Type::Bool: r.putU8(FlightRecorder::kAttrBool); r.putStr(at.key); r.putU8(at.b); break;
+      }
+    }
+  }
+
+  // Applies OTEL_ATTRIBUTE_COUNT_LIMIT / OTEL_ATTRIBUTE_VALUE_LENGTH_LIMIT
+  Span& pushAttr_(Attr& a) {
+    if (attrs_.size() >= OTEL_ATTRIBUTE_COUNT_LIMIT) { ++droppedAttrs_; return *this; }
+    if (a.type == Type::Str) truncateUtf8(a.s, OTEL_ATTRIBUTE_VALUE_LENGTH_LIMIT);
+    attrs_.push_back(std::move(a));
+    return *this;
+  }
+
   String name_;
   String traceId_;
   String spanId_;
@@ -674,10 +1196,16 @@ private:
   // Previous active context (for parent linkage and restoration)
   String prevTraceId_;
   String prevSpanId_;
+  bool   prevRemote_ = false;
+  bool   localRoot_  = true;   // no parent in this process: ends its local trace
 
   // NEW: buffers
   std::vector<Attr>  attrs_;
   std::vector<Event> events_;
+  uint32_t droppedAttrs_  = 0;
+  uint32_t droppedEvents_ = 0;
+  SpanStatus status_ = SpanStatus::Unset;
+  String     statusMessage_;
 
   // RAII guard
   bool ended_ = false;
@@ -690,8 +1218,12 @@ public:
     seedEntropy();
 
     // NEW: nuke any stale IDs so the first Span *must* generate fresh ones
-    currentTraceContext().traceId = "";
-    currentTraceContext().spanId  = "";
+    currentTraceContext().traceId    = "";
+    currentTraceContext().spanId     = "";
+    currentTraceContext().tracestate = "";
+    currentTraceContext().sampled    = true;
+    currentTraceContext().remote     = false;
+    publishActiveIds();
 
     tracerConfig().scopeName    = scopeName;
     tracerConfig().scopeVersion = scopeVersion;
@@ -700,9 +1232,56 @@ public:
   static Span startSpan(const String& name) {
     return Span(name);
   }
+
+  // Hold ended child spans and send each local trace in one request when its
+  // local root ends (see OTEL_TRACE_ASSEMBLY). Turning it off sends what is held.
+  static void setTraceAssembly(bool on) {
+    TraceAssembly::setEnabled(on);
+    if (!on) TraceAssembly::expire(true);
+  }
+
+  // Register a function called for every span as it ends. Register from
+  // setup(), before spans end on other threads. Returns false when
+  // OTEL_MAX_SPAN_PROCESSORS are registered.
+  static bool addSpanProcessor(SpanProcessor fn) {
+    if (!fn) return false;
+    SpanProcessorTable& t = spanProcessors();
+    size_t n = t.count.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) {
+      if (t.fns[i] == fn) return true; // already registered
+    }
+    if (n >= OTEL_MAX_SPAN_PROCESSORS) return false;
+    t.fns[n] = fn;
+    t.count.store(n + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+// Stand-in used by OTEL_SPAN when traces are compiled out; every call is a no-op
+// and takes its arguments by reference, so nothing is converted or allocated.
+struct NoopSpan {
+  template <typename K, typename V> NoopSpan& setAttribute(const K&, const V&) { return *this; }
+  template <typename C> NoopSpan& setStatus(const C&) { return *this; }
+  template <typename C, typename M> NoopSpan& setStatus(const C&, const M&) { return *this; }
+  template <typename N> NoopSpan& addEvent(const N&) { return *this; }
+  template <typename N, typename A> NoopSpan& addEvent(const N&, const A&) { return *this; }
+  template <typename N> NoopSpan& addEventAt(uint64_t, const N&) { return *this; }
+  template <typename N, typename A> NoopSpan& addEventAt(uint64_t, const N&, const A&) { return *this; }
+  template <typename N>
+  NoopSpan& addEvent(const N&, std::initializer_list<std::pair<const char*, const char*>>) { return *this; }
+  void end() {}
 };
 
 } // namespace OTel
 
+// Scoped span that disappears entirely when OTEL_ENABLE_TRACES=0:
+//   OTEL_SPAN(span, "read-sensor");
+//   span.setAttribute("sensor.id", id);
+#if OTEL_ENABLE_TRACES
+  #define OTEL_SPAN(var, name) ::OTel::Span var(name)
+#else
+  #define OTEL_SPAN(var, name) ::OTel::NoopSpan var
+#endif
+
 #endif // OTEL_TRACER_H
 
@@ -0,0 +1,115 @@
+// OtelWorkspace.h
+#ifndef OTEL_WORKSPACE_H
+#define OTEL_WORKSPACE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "OtelSender.h"     // OTelSignal
+
+// Bytes of static arena per signal backing its JsonDocument. A record that
+// needs more spills to the heap (counted in arenaSpills()). 0 disables the
+// arenas; documents then use the heap as before but the output buffer is
+// still reused. ESP8266 defaults to 0 to keep its small RAM free.
+#ifndef OTEL_JSON_ARENA_BYTES
+  #if defined(ESP8266)
+    #define OTEL_JSON_ARENA_BYTES 0
+  #else
+    #define OTEL_JSON_ARENA_BYTES 3072
+  #endif
+#endif
+
+namespace OTel {
+
+// Bump allocator over a caller-provided buffer for ArduinoJson. Freeing is a
+// no-op except for the most recent block; reset() rewinds everything at once.
+// Requests that do not fit fall back to malloc() and are freed normally.
+class JsonArena : public ArduinoJson::Allocator {
+public:
+  JsonArena(uint8_t* buf, size_t capacity) : buf_(buf), cap_(capacity) {}
+
+  void* allocate(size_t size) override;
+  void  deallocate(void* ptr) override;
+  void* reallocate(void* ptr, size_t newSize) override;
+
+  // Invalidates every block handed out from the arena
+  void reset() { top_ = 0; last_ = kNone; }
+
+  size_t   capacity()  const { return cap_; }
+  size_t   highWater() const { return high_; }
+  uint32_t spills()    const { return spills_; }
+
+private:
+  static constexpr size_t kNone = (size_t)-1;
+  static constexpr size_t kAlign = 8;
+  static size_t alignUp(size_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+  bool inArena(const void* p) const {
+    return buf_ && (const uint8_t*)p >= buf_ && (const uint8_t*)p < buf_ + cap_;
+  }
+
+  uint8_t* buf_;
+  size_t   cap_;
+  size_t   top_    = 0;
+  size_t   last_   = kNone; // header offset of the most recent block
+  size_t   high_   = 0;
+  uint32_t spills_ = 0;
+};
+
+// Per-signal serialization workspace: an arena-backed JsonDocument plus an
+// output buffer that keeps its capacity between records. Obtain it through
+// JsonLease, which falls back to a private heap document when the workspace is
+// already in use (e.g. the worker building a record while loop() does too).
+class JsonWorkspace {
+public:
+  JsonWorkspace(uint8_t* arena, size_t arenaBytes);
+
+  bool tryAcquire() {
+    bool expected = false;
+    return busy_.compare_exchange_strong(expected, true, std::memory_order_acquire);
+  }
+  void release();
+
+  JsonDocument& doc() { return doc_; }
+  String&       out() { return out_; }
+  const JsonArena& arena() const { return arena_; }
+
+private:
+  JsonArena         arena_;
+  JsonDocument      doc_;
+  String            out_;
+  std::atomic<bool> busy_{false};
+};
+
+JsonWorkspace& workspaceFor(OTelSignal signal);
+
+// Arena statistics for sizing OTEL_JSON_ARENA_BYTES
+size_t   arenaHighWater(OTelSignal signal);
+uint32_t arenaSpills(OTelSignal signal);
+
+// RAII access to a signal's workspace for building and sending one record:
+//
+//   JsonLease lease(OTelSignal::Logs);
+//   JsonDocument& doc = lease.doc();
+//   ... fill doc ...
+//   OTelSender::sendJson("/v1/logs", doc, priority, lease.scratch());
+class JsonLease {
+public:
+  explicit JsonLease(OTelSignal signal) {
+    JsonWorkspace& ws = workspaceFor(signal);
+    if (ws.tryAcquire()) ws_ = &ws;
+  }
+  ~JsonLease() { if (ws_) ws_->release(); }
+  JsonLease(const JsonLease&) = delete;
+  JsonLease& operator=(const JsonLease&) = delete;
+
+  JsonDocument& doc()     { return ws_ ? ws_->doc() : local_; }
+  String*       scratch() { return ws_ ? &ws_->out() : nullptr; }
+
+private:
+  JsonWorkspace* ws_ = nullptr;
+  JsonDocument   local_;  // default-constructed documents do not allocate
+};
+
+} // namespace OTel
+
+#endif // OTEL_WORKSPACE_H
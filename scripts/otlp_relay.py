@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Reference relay for OTel::UdpExporter / OTel::TcpExporter.
+
+Receives framed OTLP/JSON records on UDP and TCP and forwards each one to an
+OTLP/HTTP collector. Frames are:
+
+    u32 big-endian length N | u8 signal (0 traces, 1 logs, 2 metrics) | N-1 bytes
+
+Usage: scripts/otlp_relay.py [--listen 0.0.0.0] [--port 4319]
+                             [--collector http://localhost:4318]
+Only the Python standard library is needed.
+"""
+import argparse
+import socket
+import socketserver
+import struct
+import sys
+import threading
+import urllib.error
+import urllib.request
+
+PATHS = {0: "/v1/traces", 1: "/v1/logs", 2: "/v1/metrics"}
+MAX_FRAME = 1 << 20
+
+
+class Forwarder:
+    def __init__(self, collector):
+        self.collector = collector.rstrip("/")
+        self.lock = threading.Lock()
+        self.forwarded = 0
+        self.failed = 0
+
+    def forward(self, signal, body):
+        path = PATHS.get(signal)
+        if path is None:
+            self._count(ok=False, why="unknown signal %d" % signal)
+            return
+        req = urllib.request.Request(self.collector + path, data=body, method="POST",
+                                     headers={"Content-Type": "application/json"})
+        try:
+            with urllib.request.urlopen(req, timeout=10) as resp:
+                resp.read()
+            self._count(ok=True)
+        except (urllib.error.URLError, OSError) as e:
+            self._count(ok=False, why="%s: %s" % (path, e))
+
+    def _count(self, ok, why=""):
+        with self.lock:
+            if ok:
+                self.forwarded += 1
+            else:
+                self.failed += 1
+                print("relay: forward failed (%s)" % why, file=sys.stderr)
+
+
+def parse_frame(data):
+    """Returns (signal, body) for one complete frame, or None if malformed."""
+    if len(data) < 5:
+        return None
+    (n,) = struct.unpack(">I", data[:4])
+    if n < 1 or n > MAX_FRAME or len(data) != 4 + n:
+        return None
+    return data[4], data[5:]
+
+
+def serve_udp(host, port, fwd):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((host, port))
+    while True:
+        data, _ = sock.recvfrom(65535)
+        frame = parse_frame(data)
+        if frame is None:
+            print("relay: dropped malformed datagram (%d bytes)" % len(data), file=sys.stderr)
+            continue
+        fwd.forward(*frame)
+
+
+def make_tcp_handler(fwd):
+    class Handler(socketserver.StreamRequestHandler):
+        def handle(self):
+            while True:
+                hdr = self.rfile.read(4)
+                if len(hdr) < 4:
+                    return  # closed (a partial frame is discarded with the connection)
+                (n,) = struct.unpack(">I", hdr)
+                if n < 1 or n > MAX_FRAME:
+                    print("relay: bad frame length %d, closing" % n, file=sys.stderr)
+                    return
+                rest = self.rfile.read(n)
+                if len(rest) < n:
+                    return
+                fwd.forward(rest[0], rest[1:])
+
+    return Handler
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--listen", default="0.0.0.0")
+    ap.add_argument("--port", type=int, default=4319)
+    ap.add_argument("--collector", default="http://localhost:4318")
+    args = ap.parse_args()
+
+    fwd = Forwarder(args.collector)
+    threading.Thread(target=serve_udp, args=(args.listen, args.port, fwd), daemon=True).start()
+
+    socketserver.ThreadingTCPServer.allow_reuse_address = True
+    socketserver.ThreadingTCPServer.daemon_threads = True
+    with socketserver.ThreadingTCPServer((args.listen, args.port), make_tcp_handler(fwd)) as srv:
+        print("relay: udp+tcp %s:%d -> %s" % (args.listen, args.port, fwd.collector))
+        srv.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
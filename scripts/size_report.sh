@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+# Build src/main.cpp for every platform in platformio.ini under each
+# compile-time stripping configuration and print flash/RAM use as a
+# Markdown table (deltas are relative to the full build on that platform).
+#
+# Usage: scripts/size_report.sh [env ...]     (defaults to all three envs)
+# Needs the same environment variables as the CI build (WIFI_SSID, ...).
+set -euo pipefail
+
+cd "$(dirname "$0")/.."
+
+ENVS=("$@")
+if [ ${#ENVS[@]} -eq 0 ]; then
+  ENVS=(esp32dev rpipicow esp8266)
+fi
+
+CONFIG_NAMES=(
+  "full"
+  "log-level=WARN"
+  "no-logs"
+  "no-traces"
+  "no-metrics"
+  "all-signals-off"
+)
+CONFIG_FLAGS=(
+  ""
+  "-DOTEL_LOG_LEVEL=OTEL_LOG_LEVEL_WARN"
+  "-DOTEL_ENABLE_LOGS=0"
+  "-DOTEL_ENABLE_TRACES=0"
+  "-DOTEL_ENABLE_METRICS=0"
+  "-DOTEL_ENABLE_LOGS=0 -DOTEL_ENABLE_TRACES=0 -DOTEL_ENABLE_METRICS=0"
+)
+
+# Prints "<flash> <ram>" in bytes from the PlatformIO size summary
+build_size() {
+  local env="$1" flags="$2" out
+  out=$(PLATFORMIO_BUILD_FLAGS="$flags" platformio ci src/main.cpp \
+          --project-conf platformio.ini --lib "." -e "$env" 2>&1) || {
+    echo "$out" >&2
+    return 1
+  }
+  local flash ram
+  flash=$(echo "$out" | sed -n 's/^Flash:.*used \([0-9]*\) bytes.*/\1/p' | tail -1)
+  ram=$(echo "$out"   | sed -n 's/^RAM:.*used \([0-9]*\) bytes.*/\1/p'   | tail -1)
+  echo "${flash:-0} ${ram:-0}"
+}
+
+echo "| Platform | Configuration | Flash (bytes) | Δ Flash | RAM (bytes) | Δ RAM |"
+echo "| -------- | ------------- | ------------: | ------: | ----------: | ----: |"
+for env in "${ENVS[@]}"; do
+  base_flash=0
+  base_ram=0
+  for i in "${!CONFIG_NAMES[@]}"; do
+    read -r flash ram < <(build_size "$env" "${CONFIG_FLAGS[$i]}")
+    if [ "$i" -eq 0 ]; then
+      base_flash=$flash
+      base_ram=$ram
+    fi
+    echo "| $env | ${CONFIG_NAMES[$i]} | $flash | $((flash - base_flash)) | $ram | $((ram - base_ram)) |"
+  done
+done
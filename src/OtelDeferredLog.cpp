@@ -0,0 +1,185 @@
+#include "OtelDeferredLog.h"
+#include <limits.h>
+#include <stdlib.h>
+
+namespace OTel {
+
+// ===== statics =====
+DeferredLogRecord     DeferredLog::ring_[DeferredLog::QCAP];
+std::atomic<size_t>   DeferredLog::head_{0};
+std::atomic<size_t>   DeferredLog::tail_{0};
+std::atomic<uint32_t> DeferredLog::drops_{0};
+
+bool DeferredLog::pop(DeferredLogRecord& out) {
+  size_t t = tail_.load(std::memory_order_relaxed);
+  size_t h = head_.load(std::memory_order_acquire);
+  if (t == h) return false; // empty
+
+  out = ring_[t];
+  tail_.store((t + 1) % QCAP, std::memory_order_release);
+  return true;
+}
+
+size_t DeferredLog::pending() {
+  size_t h = head_.load(std::memory_order_acquire);
+  size_t t = tail_.load(std::memory_order_acquire);
+  return (h + QCAP - t) % QCAP;
+}
+
+uint32_t DeferredLog::droppedCount() {
+  return drops_.load(std::memory_order_relaxed);
+}
+
+// ---------- Worker-side formatting ----------
+namespace {
+
+struct ArgReader {
+  const uint8_t* p;
+  const uint8_t* end;
+
+  bool next(DeferredArg& tag, int64_t& i, uint64_t& u, double& d,
+            const char*& s, size_t& n) {
+    if (p >= end) return false;
+    tag = (DeferredArg)*p++;
+    switch (tag) {
+      case DeferredArg::I32: { int32_t v;  memcpy(&v, p, 4); p += 4; i = v; return true; }
+      case DeferredArg::U32: { uint32_t v; memcpy(&v, p, 4); p += 4; u = v; return true; }
+      case DeferredArg::I64: memcpy(&i, p, 8); p += 8; return true;
+      case DeferredArg::U64:
+      case DeferredArg::Ptr: memcpy(&u, p, 8); p += 8; return true;
+      case DeferredArg::F64: memcpy(&d, p, 8); p += 8; return true;
+      case DeferredArg::Str: n = *p++; s = (const char*)p; p += n; return true;
+    }
+    return false;
+  }
+};
+
+// Portable 64-bit decimal (avoids %lld, which some newlib-nano builds lack)
+size_t u64ToDec(char* out, uint64_t v) {
+  char tmp[21];
+  size_t n = 0;
+  do { tmp[n++] = char('0' + (v % 10)); v /= 10; } while (v);
+  for (size_t k = 0; k < n; ++k) out[k] = tmp[n - 1 - k];
+  return n;
+}
+
+} // namespace
+
+size_t formatDeferred(char* out, size_t cap, const DeferredLogRecord& rec) {
+  if (!out || cap == 0) return 0;
+  size_t o = 0;
+  const char* f = rec.fmt ? rec.fmt : "";
+  ArgReader rd{rec.args, rec.args + rec.argLen};
+
+  auto emit = [&](const char* s, size_t n) {
+    if (o + n > cap - 1) n = cap - 1 - o;
+    memcpy(out + o, s, n);
+    o += n;
+  };
+
+  while (*f && o < cap - 1) {
+    if (*f != '%') { out[o++] = *f++; continue; }
+    if (f[1] == '%') { out[o++] = '%'; f += 2; continue; }
+
+    // Collect "%[flags][width][.precision]" and skip any length modifier;
+    // the recorded argument type decides the modifier we actually use. A '*'
+    // width or precision is read from the next argument and written in.
+    char spec[24];
+    size_t sn = 0;
+    spec[sn++] = *f++;
+    while (*f && strchr("-+ #0123456789.*", *f) && sn < sizeof(spec) - 8) {
+      if (*f != '*') { spec[sn++] = *f++; continue; }
+      ++f;
+      DeferredArg tag = DeferredArg::Str; int64_t i = 0; uint64_t u = 0; double d = 0; const char* s = ""; size_t n = 0;
+      if (rd.next(tag, i, u, d, s, n) && (tag == DeferredArg::U32 || tag == DeferredArg::U64)) {
+        i = u > 999 ? 999 : (int64_t)u;
+      } else if (tag != DeferredArg::I32 && tag != DeferredArg::I64) {
+        i = 0;
+      }
+      const bool precision = spec[sn - 1] == '.';
+      if (i < 0) {
+        if (precision) { --sn; continue; }  // negative precision: as if omitted
+        spec[sn++] = '-';                   // negative width: left-justified
+        i = -i;
+      }
+      sn += u64ToDec(spec + sn, (uint64_t)(i > 999 ? 999 : i));
+    }
+    spec[sn] = '\0';
+    while (*f && strchr("hlLqjzt", *f)) ++f;
+    const char conv = *f;
+    if (!conv) break;
+    ++f;
+
+    DeferredArg tag; int64_t i = 0; uint64_t u = 0; double d = 0; const char* s = ""; size_t n = 0;
+    if (!rd.next(tag, i, u, d, s, n)) { emit("?", 1); continue; }
+
+    char buf[48];
+    int w = 0;
+    const bool floatConv = strchr("fFeEgGaA", conv) != nullptr;
+
+    if (tag == DeferredArg::Str) {
+      if (conv != 's') { emit(s, n); continue; }
+      // The copy is not NUL-terminated: its length goes in as the precision,
+      // capped by any precision the format gave
+      const char* dot = strchr(spec, '.');
+      if (dot) {
+        const size_t p = (size_t)atoi(dot + 1);
+        if (p < n) n = p;
+        sn = (size_t)(dot - spec);
+      }
+      spec[sn++] = '.'; spec[sn++] = '*'; spec[sn++] = 's'; spec[sn] = '\0';
+      w = snprintf(out + o, cap - o, spec, (int)n, s);
+    } else if (tag == DeferredArg::F64 || floatConv) {
+      if (tag == DeferredArg::I32 || tag == DeferredArg::I64) d = (double)i;
+      else if (tag != DeferredArg::F64)                        d = (double)u;
+      spec[sn++] = floatConv ? conv : 'g'; spec[sn] = '\0';
+      w = snprintf(buf, sizeof(buf), spec, d);
+      emit(buf, w < 0 ? 0 : ((size_t)w < sizeof(buf) ? (size_t)w : sizeof(buf) - 1));
+      continue;
+    } else if (tag == DeferredArg::Ptr || conv == 'p') {
+      if (tag == DeferredArg::I32 || tag == DeferredArg::I64) u = (uint64_t)i;
+      spec[sn++] = 'p'; spec[sn] = '\0';
+      w = snprintf(buf, sizeof(buf), spec, (void*)(uintptr_t)u);
+      emit(buf, w < 0 ? 0 : ((size_t)w < sizeof(buf) ? (size_t)w : sizeof(buf) - 1));
+      continue;
+    } else {
+      // Integer conversions
+      const bool isSigned = (tag == DeferredArg::I32 || tag == DeferredArg::I64);
+      char c = strchr("diouxXc", conv) ? conv : (isSigned ? 'd' : 'u');
+      if (isSigned && (c == 'u' || c == 'o' || c == 'x' || c == 'X')) { u = (uint64_t)i; }
+      const bool wide = isSigned ? (i < LONG_MIN || i > LONG_MAX) : (u > ULONG_MAX);
+      if (!wide) {
+        spec[sn++] = (c == 'c') ? 'c' : 'l';
+        if (c != 'c') spec[sn++] = c;
+        spec[sn] = '\0';
+        if (c == 'c')                  w = snprintf(buf, sizeof(buf), spec, (int)(isSigned ? i : (int64_t)u));
+        else if (isSigned && (c == 'd' || c == 'i')) w = snprintf(buf, sizeof(buf), spec, (long)i);
+        else                           w = snprintf(buf, sizeof(buf), spec, (unsigned long)(isSigned ? (uint64_t)i : u));
+        emit(buf, w < 0 ? 0 : ((size_t)w < sizeof(buf) ? (size_t)w : sizeof(buf) - 1));
+      } else {
+        // 64-bit value on a 32-bit long: render by hand (width/flags ignored)
+        size_t k = 0;
+        if (c == 'x' || c == 'X') {
+          const char* hex = (c == 'x') ? "0123456789abcdef" : "0123456789ABCDEF";
+          char tmp[16]; size_t m = 0;
+          do { tmp[m++] = hex[u & 0x0F]; u >>= 4; } while (u);
+          while (m) buf[k++] = tmp[--m];
+        } else {
+          if (isSigned && (c == 'd' || c == 'i')) {
+            if (i < 0) { buf[k++] = '-'; u = (uint64_t)(-(i + 1)) + 1; } else u = (uint64_t)i;
+          }
+          k += u64ToDec(buf + k, u);
+        }
+        emit(buf, k);
+      }
+      continue;
+    }
+    if (w > 0) o += ((size_t)w < cap - o) ? (size_t)w : cap - 1 - o;
+  }
+
+  if (rec.truncated) emit("...", 3);
+  out[o] = '\0';
+  return o;
+}
+
+} // namespace OTel
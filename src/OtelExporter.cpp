@@ -0,0 +1,549 @@
+#include "OtelExporter.h"
+#include "OtelScheduler.h"
+#include <FS.h>
+#include <string.h>
+
+// --- HTTP + WiFi includes (portable) ---
+#if defined(ESP8266)
+  #include <ESP8266WiFi.h>
+  #include <ESP8266HTTPClient.h>
+  #include <WiFiUdp.h>
+#elif defined(ESP32)
+  #include <WiFi.h>
+  #include <WiFiUdp.h>
+  #include <HTTPClient.h>
+#elif defined(ARDUINO_ARCH_RP2040)
+  #include <WiFi.h>        // Earle Philhower core
+  #include <WiFiUdp.h>
+  #include <HTTPClient.h>  // Arduino HTTPClient
+#else
+  #error "Unsupported platform: need WiFi + HTTPClient"
+#endif
+
+namespace OTel {
+
+// Print adapter that appends to a String (materialising a PayloadSource)
+namespace {
+class StringPrint : public Print {
+public:
+  explicit StringPrint(String& s) : s_(s) {}
+  size_t write(uint8_t c) override { s_ += (char)c; return 1; }
+  size_t write(const uint8_t* buf, size_t n) override {
+    s_.concat(reinterpret_cast<const char*>(buf), n);
+    return n;
+  }
+private:
+  String& s_;
+};
+
+// Buffers writes into OTEL_STREAM_CHUNK_BYTES blocks and sends each one to the
+// socket, framed as an HTTP/1.1 chunk when `chunked` is set
+class ChunkedWriter : public Print {
+public:
+  ChunkedWriter(Print& c, bool chunked) : c_(c), chunked_(chunked) {}
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override {
+    for (size_t i = 0; i < n; ) {
+      size_t take = sizeof(buf_) - len_;
+      if (take > n - i) take = n - i;
+      memcpy(buf_ + len_, buf + i, take);
+      len_ += take;
+      i    += take;
+      if (len_ == sizeof(buf_)) emit();
+    }
+    return failed_ ? 0 : n;
+  }
+
+  // Send the tail (and the terminating chunk). False when the socket failed.
+  bool finish() {
+    emit();
+    if (chunked_ && !failed_) send("0\r\n\r\n", 5);
+    return !failed_;
+  }
+
+private:
+  void emit() {
+    if (len_ == 0 || failed_) { len_ = 0; return; }
+    if (chunked_) {
+      char head[12];
+      const int h = snprintf(head, sizeof(head), "%X\r\n", (unsigned)len_);
+      send(head, (size_t)h);
+    }
+    send(reinterpret_cast<const char*>(buf_), len_);
+    if (chunked_) send("\r\n", 2);
+    len_ = 0;
+  }
+  void send(const char* p, size_t n) {
+    if (!failed_ && c_.write(reinterpret_cast<const uint8_t*>(p), n) != n) failed_ = true;
+  }
+
+  Print&  c_;
+  bool    chunked_;
+  bool    failed_ = false;
+  size_t  len_    = 0;
+  uint8_t buf_[OTEL_STREAM_CHUNK_BYTES];
+};
+} // namespace
+
+ExportResult Exporter::exportStream(OTelSignal signal, const char* path,
+                                    const PayloadSource& source) {
+  String payload;
+  if (source.size()) payload.reserve(source.size());
+  StringPrint out(payload);
+  source.writeTo(out);
+  return exportRequest(signal, path, payload);
+}
+
+// ---------- OTLP/HTTP ----------
+// Begin HTTP on all platforms (ESP8266 requires WiFiClient)
+static bool httpBeginCompat(HTTPClient& http, const String& url) {
+#if defined(ESP8266)
+  WiFiClient client;                // or WiFiClientSecure if you later do HTTPS
+  return http.begin(client, url);   // new API on ESP8266
+#else
+  return http.begin(url);           // ESP32 / RP2040
+#endif
+}
+
+HttpExporter::HttpExporter(const char* baseUrl) { setBaseUrl(baseUrl); }
+
+HttpExporter::~HttpExporter() {
+  if (client_) client_->stop();
+  delete client_;
+}
+
+void HttpExporter::setBaseUrl(const char* baseUrl) {
+  // Avoid double slashes if a user accidentally sets a trailing slash
+  base_ = baseUrl ? baseUrl : "";
+  if (base_.endsWith("/")) base_.remove(base_.length() - 1);
+
+  // Split plain http:// URLs for the streaming path; TLS stays on HTTPClient
+  host_ = ""; prefix_ = ""; port_ = 0;
+  if (client_) client_->stop();
+  if (!base_.startsWith("http://")) return;
+  const int hostAt = 7;
+  int slash = base_.indexOf('/', hostAt);
+  if (slash < 0) slash = base_.length();
+  String authority = base_.substring(hostAt, slash);
+  const int colon = authority.lastIndexOf(':');
+  long port = 80;
+  if (colon >= 0) {
+    port = authority.substring(colon + 1).toInt();
+    authority.remove(colon);
+  }
+  if (authority.length() == 0 || port <= 0 || port > 65535) return;
+  host_   = authority;
+  port_   = (uint16_t)port;
+  prefix_ = base_.substring(slash);
+}
+
+// Build "http://host:4318" + "/v1/…"
+String HttpExporter::url(const char* path) const {
+  if (path && *path == '/') return base_ + String(path);
+  return base_ + "/" + String(path ? path : "");
+}
+
+ExportResult HttpExporter::exportRequest(OTelSignal, const char* path, const String& payload) {
+  HTTPClient http;
+  // Keep-alive where supported; harmless otherwise
+  #if defined(HTTPCLIENT_1_2_COMPATIBLE) || defined(ESP8266) || defined(ESP32)
+  http.setReuse(true);
+  #endif
+  int code = -1;
+  if (httpBeginCompat(http, url(path))) {
+    http.addHeader("Content-Type", "application/json");
+    code = http.POST(payload);
+    http.end();
+  }
+  lastStatus_ = code;
+  return classify(code);
+}
+
+ExportResult HttpExporter::exportStream(OTelSignal signal, const char* path,
+                                        const PayloadSource& source) {
+  if (!streams()) return Exporter::exportStream(signal, path, source);
+
+  // The collector may have closed an idle kept-alive connection without us
+  // noticing yet; if writing the request failed on it, resend once on a fresh
+  // one. A missing response is not retried here: the collector may have
+  // received the request.
+  const bool reused = client_ && client_->connected();
+  int code = post(path, source);
+  if (code == kNotSent && reused) code = post(path, source);
+  lastStatus_ = code;
+  return classify(code);
+}
+
+// One request/response on the kept-alive connection. Returns the HTTP status,
+// kNotSent if the request could not be written, or -1 on other transport
+// errors (the connection is then closed).
+int HttpExporter::post(const char* path, const PayloadSource& source) {
+  if (!client_) client_ = new WiFiClient();
+  WiFiClient& client = *client_;
+  if (!client.connected()) {
+    client.stop();
+    if (!client.connect(host_.c_str(), port_)) return -1;
+    ++connects_;
+  }
+
+  const size_t length = source.size();
+  client.print("POST ");
+  client.print(prefix_);
+  if (!path || *path != '/') client.print('/');
+  client.print(path ? path : "");
+  client.print(" HTTP/1.1\r\nHost: ");
+  client.print(host_);
+  client.print("\r\nContent-Type: application/json\r\n");
+  if (length) {
+    client.print("Content-Length: ");
+    client.print((unsigned long)length);
+    client.print("\r\n\r\n");
+  } else {
+    client.print("Transfer-Encoding: chunked\r\n\r\n");
+  }
+
+  ChunkedWriter body(client, length == 0);
+  source.writeTo(body);
+  if (!body.finish()) {
+    client.stop();
+    return kNotSent;
+  }
+
+  client.setTimeout(OTEL_HTTP_TIMEOUT_MS);
+  String line = client.readStringUntil('\n');
+  int code = -1;
+  if (line.startsWith("HTTP/1.")) {
+    const int sp = line.indexOf(' ');
+    code = sp > 0 ? line.substring(sp + 1).toInt() : -1;
+  }
+
+  // Read the response to its end so the next request can use the connection;
+  // anything but a Content-Length body closes it instead
+  long contentLength = -1;
+  bool keep = code > 0;
+  while (keep) {
+    line = client.readStringUntil('\n');
+    line.trim();
+    if (line.length() == 0) break;  // end of headers (or timeout)
+    line.toLowerCase();
+    if (line.startsWith("content-length:")) {
+      contentLength = line.substring(15).toInt();
+    } else if (line.startsWith("connection:") && line.indexOf("close") > 0) {
+      keep = false;
+    }
+  }
+  if (contentLength < 0) keep = false;
+  uint8_t sink[64];
+  while (keep && contentLength > 0) {
+    const size_t want = contentLength < (long)sizeof(sink) ? (size_t)contentLength : sizeof(sink);
+    if (client.readBytes(sink, want) != want) keep = false;
+    contentLength -= (long)want;
+  }
+  if (!keep) client.stop();
+  return code;
+}
+
+ExportResult HttpExporter::classify(int code) {
+  // OTLP/HTTP: only throttling, gateway errors and transport failures are retryable
+  if (code >= 200 && code < 300) return ExportResult::Success;
+  if (code <= 0 || code == 429 || code == 502 || code == 503 || code == 504) {
+    return ExportResult::RetryableFailure;
+  }
+  return ExportResult::Failure;
+}
+
+// ---------- File ----------
+ExportResult FileExporter::exportRequest(OTelSignal, const char*, const String& payload) {
+  File f = fs_.open(path_, "a");
+  if (!f) return ExportResult::Failure;
+
+  const size_t len = payload.length();
+  size_t expected  = len;
+  size_t written   = 0;
+  if (format_ == Format::LengthDelimited) {
+    uint8_t prefix[5];
+    size_t  n = 0;
+    uint32_t v = (uint32_t)len;
+    do {
+      prefix[n] = (uint8_t)(v & 0x7F);
+      v >>= 7;
+      if (v) prefix[n] |= 0x80;
+      ++n;
+    } while (v);
+    expected += n;
+    written  += f.write(prefix, n);
+    written  += f.write((const uint8_t*)payload.c_str(), len);
+  } else {
+    expected += 1;
+    written  += f.write((const uint8_t*)payload.c_str(), len);
+    written  += f.write((uint8_t)'\n');
+  }
+  f.close();
+  // A short write means the filesystem is full: retrying will not help
+  return written == expected ? ExportResult::Success : ExportResult::Failure;
+}
+
+// ---------- Serial / stdout ----------
+ExportResult SerialExporter::exportRequest(OTelSignal, const char*, const String& payload) {
+  out_.write((const uint8_t*)payload.c_str(), payload.length());
+  out_.write((uint8_t)'\n');
+  return ExportResult::Success;
+}
+
+// ---------- In-memory ----------
+ExportResult MemoryExporter::exportRequest(OTelSignal signal, const char* path,
+                                           const String& payload) {
+  requests_.fetch_add(1, std::memory_order_relaxed);
+  bytes_.fetch_add(payload.length(), std::memory_order_relaxed);
+  if (max_) {
+    MutexLock lock(m_);
+    if (captured_.size() >= max_) captured_.erase(captured_.begin()); // keep the newest
+    Request r;
+    r.signal  = signal;
+    r.path    = path;
+    r.payload = payload;
+    captured_.push_back(std::move(r));
+  }
+  return result_;
+}
+
+size_t MemoryExporter::size() {
+  MutexLock lock(m_);
+  return captured_.size();
+}
+
+MemoryExporter::Request MemoryExporter::at(size_t i) {
+  MutexLock lock(m_);
+  return i < captured_.size() ? captured_[i] : Request();
+}
+
+void MemoryExporter::clear() {
+  MutexLock lock(m_);
+  captured_.clear();
+}
+
+// ---------- Relay (UDP / TCP) ----------
+static const size_t kFrameHeader = 5;
+
+static void frameHeader(uint8_t* out, OTelSignal signal, size_t bodyLen) {
+  const uint32_t n = (uint32_t)bodyLen + 1;  // the signal byte counts
+  out[0] = (uint8_t)(n >> 24);
+  out[1] = (uint8_t)(n >> 16);
+  out[2] = (uint8_t)(n >> 8);
+  out[3] = (uint8_t)n;
+  out[4] = (uint8_t)signal;
+}
+
+UdpExporter::~UdpExporter() { delete udp_; }
+
+bool UdpExporter::sendFrame(OTelSignal signal, const char* prefix, size_t prefixLen,
+                            const char* body, size_t bodyLen, const char* suffix, size_t suffixLen) {
+  const size_t len = prefixLen + bodyLen + suffixLen;
+  if (kFrameHeader + len > max_) {
+    ++oversize_;
+    return false;
+  }
+  uint8_t hdr[kFrameHeader];
+  frameHeader(hdr, signal, len);
+  if (!udp_->beginPacket(host_, port_)) return false;
+  udp_->write(hdr, sizeof hdr);
+  udp_->write((const uint8_t*)prefix, prefixLen);
+  udp_->write((const uint8_t*)body, bodyLen);
+  udp_->write((const uint8_t*)suffix, suffixLen);
+  const bool sent = udp_->endPacket() != 0;
+  if (sent) ++datagrams_;
+  return sent;
+}
+
+ExportResult UdpExporter::exportRequest(OTelSignal signal, const char*, const String& payload) {
+  if (!udp_) udp_ = new WiFiUDP();
+  const char*    p         = payload.c_str();
+  const size_t   len       = payload.length();
+  const uint32_t sentAt    = datagrams_;
+  const uint32_t droppedAt = oversize_;
+  size_t records = 0;
+
+  // Fire-and-forget: records that can never fit are dropped and counted, the
+  // rest of the request is still delivered. Failure only when a datagram could
+  // not be sent or nothing was.
+  auto result = [&]() {
+    const uint32_t sent = datagrams_ - sentAt;
+    return sent && sent + (oversize_ - droppedAt) == records ? ExportResult::Success
+                                                             : ExportResult::Failure;
+  };
+
+  // Requests look like {"resourceX":[rec,rec,...]}: send each rec as
+  // {"resourceX":[rec]}, written straight from the payload without copying
+  const char* open = (const char*)memchr(p, '[', len);
+  if (!open || len < 2 || p[len - 1] != '}' || p[len - 2] != ']') {
+    ++records;
+    sendFrame(signal, p, len, "", 0, "", 0);
+    return result();
+  }
+  const size_t prefixLen = (size_t)(open - p) + 1;
+  const char*  end       = p + len - 2;  // the closing ']'
+
+  int  depth = 0;
+  bool inString = false;
+  const char* rec = open + 1;
+  for (const char* c = rec; c <= end; ++c) {
+    if (inString) {
+      if (*c == '\\') ++c;
+      else if (*c == '"') inString = false;
+      continue;
+    }
+    if (*c == '"') { inString = true; continue; }
+    if (*c == '{' || *c == '[') { ++depth; continue; }
+    if (*c == '}' || (*c == ']' && c != end)) { --depth; continue; }
+    if ((*c == ',' && depth == 0) || c == end) {
+      if (c > rec) {
+        ++records;
+        sendFrame(signal, p, prefixLen, rec, (size_t)(c - rec), "]}", 2);
+      }
+      rec = c + 1;
+    }
+  }
+  return result();
+}
+
+TcpExporter::~TcpExporter() {
+  if (client_) client_->stop();
+  delete client_;
+}
+
+ExportResult TcpExporter::exportRequest(OTelSignal signal, const char*, const String& payload) {
+  if (!client_) client_ = new WiFiClient();
+  if (!client_->connected()) {
+    client_->stop();
+    if (!client_->connect(host_, port_)) return ExportResult::RetryableFailure;
+    client_->setNoDelay(true);
+    ++connects_;
+  }
+
+  uint8_t hdr[kFrameHeader];
+  frameHeader(hdr, signal, payload.length());
+  size_t written = client_->write(hdr, sizeof hdr);
+  written += client_->write((const uint8_t*)payload.c_str(), payload.length());
+  if (written != sizeof hdr + payload.length()) {
+    client_->stop();  // the relay discards the partial frame with the connection
+    return ExportResult::RetryableFailure;
+  }
+  return ExportResult::Success;
+}
+
+// ---------- Failover / fan-out ----------
+void EndpointHealth::record(ExportResult result, uint32_t nowMs) {
+  if (result == ExportResult::Success) {
+    ++successes;
+    consecutiveFailures = 0;
+    healthy = true;
+    return;
+  }
+  ++failures;
+  lastFailureMs = nowMs;
+  // A rejected request says nothing about whether the endpoint is reachable
+  if (result == ExportResult::RetryableFailure) {
+    ++consecutiveFailures;
+    healthy = false;
+  }
+}
+
+FailoverExporter::FailoverExporter(std::initializer_list<Exporter*> endpoints, uint32_t reprobeMs)
+: reprobeMs_(reprobeMs) {
+  for (Exporter* e : endpoints) {
+    if (e && count_ < OTEL_MAX_ENDPOINTS) endpoints_[count_++] = e;
+  }
+}
+
+bool FailoverExporter::backingOff(size_t i, uint32_t now) const {
+  return !health_[i].healthy && now - health_[i].lastFailureMs < reprobeMs_;
+}
+
+template <typename Send>
+ExportResult FailoverExporter::run(Send send) {
+  if (count_ == 0) return ExportResult::Failure;
+  const uint32_t now = Scheduler::now();
+
+  // Only a transport failure moves on to the next endpoint
+  auto attempt = [&](size_t i, ExportResult& r) {
+    r = send(endpoints_[i]);
+    health_[i].record(r, now);
+    if (r == ExportResult::RetryableFailure) return false;
+    active_ = i;
+    return true;
+  };
+
+  // In order of preference, skipping endpoints that failed less than
+  // reprobeMs ago; after that they are probed again with a real request
+  ExportResult r = ExportResult::RetryableFailure;
+  bool tried = false;
+  for (size_t i = 0; i < count_; ++i) {
+    if (backingOff(i, now)) continue;
+    tried = true;
+    if (attempt(i, r)) return r;
+  }
+  if (tried) return r;
+
+  // Every endpoint is backing off: probe the one that failed longest ago, so
+  // each request still gets a real attempt
+  size_t oldest = 0;
+  for (size_t i = 1; i < count_; ++i) {
+    if (now - health_[i].lastFailureMs > now - health_[oldest].lastFailureMs) oldest = i;
+  }
+  attempt(oldest, r);
+  return r;  // RetryableFailure: all unreachable, the sender retries later
+}
+
+ExportResult FailoverExporter::exportRequest(OTelSignal signal, const char* path,
+                                             const String& payload) {
+  return run([&](Exporter* e) { return e->exportRequest(signal, path, payload); });
+}
+
+ExportResult FailoverExporter::exportStream(OTelSignal signal, const char* path,
+                                            const PayloadSource& source) {
+  return run([&](Exporter* e) { return e->exportStream(signal, path, source); });
+}
+
+bool FailoverExporter::streams() const {
+  for (size_t i = 0; i < count_; ++i) if (!endpoints_[i]->streams()) return false;
+  return count_ > 0;
+}
+
+FanoutExporter::FanoutExporter(std::initializer_list<Exporter*> endpoints) {
+  for (Exporter* e : endpoints) {
+    if (e && count_ < OTEL_MAX_ENDPOINTS) endpoints_[count_++] = e;
+  }
+}
+
+template <typename Send>
+ExportResult FanoutExporter::run(Send send) {
+  const uint32_t now = Scheduler::now();
+  bool delivered = false;
+  bool retryable = count_ > 0;
+  for (size_t i = 0; i < count_; ++i) {
+    const ExportResult r = send(endpoints_[i]);
+    health_[i].record(r, now);
+    if (r == ExportResult::Success) delivered = true;
+    if (r != ExportResult::RetryableFailure) retryable = false;
+  }
+  if (delivered) return ExportResult::Success;
+  return retryable ? ExportResult::RetryableFailure : ExportResult::Failure;
+}
+
+ExportResult FanoutExporter::exportRequest(OTelSignal signal, const char* path,
+                                           const String& payload) {
+  return run([&](Exporter* e) { return e->exportRequest(signal, path, payload); });
+}
+
+ExportResult FanoutExporter::exportStream(OTelSignal signal, const char* path,
+                                          const PayloadSource& source) {
+  return run([&](Exporter* e) { return e->exportStream(signal, path, source); });
+}
+
+bool FanoutExporter::streams() const {
+  for (size_t i = 0; i < count_; ++i) if (!endpoints_[i]->streams()) return false;
+  return count_ > 0;
+}
+
+} // namespace OTel
@@ -0,0 +1,455 @@
+#include "OtelFlightRecorder.h"
+#include "OtelMutex.h"
+#include "OtelScheduler.h"
+#include "OtelLogger.h"   // logScopeConfig(), defaultLabels(); pulls in OtelTracer.h
+#include <atomic>
+#include <vector>
+
+#if defined(ESP32)
+  #include <esp_attr.h>
+  #include <esp_system.h>
+  #define OTEL_FLIGHT_NOINIT __NOINIT_ATTR
+#elif defined(ARDUINO_ARCH_RP2040)
+  #include <hardware/watchdog.h>
+  #define OTEL_FLIGHT_NOINIT __attribute__((section(".uninitialized_data.otel_flight")))
+#else
+  #define OTEL_FLIGHT_NOINIT
+#endif
+
+namespace OTel {
+
+namespace {
+
+constexpr uint32_t kMagic  = 0x4F46524Cu;  // "OFRL"
+constexpr uint32_t kSize   = OTEL_FLIGHT_RECORDER_BYTES ? OTEL_FLIGHT_RECORDER_BYTES : 1;
+constexpr uint32_t kHeader = 3;            // u16 payload bytes + u8 kind
+
+// Plain data, so it is neither zeroed nor constructed at boot where it lives in
+// no-init RAM. `check` is rewritten after every change: a window torn by a
+// crash mid-update, or garbage after power-on, fails validation.
+struct Ring {
+  uint32_t magic;
+  uint32_t head;   // next write offset
+  uint32_t tail;   // oldest record
+  uint32_t used;
+  uint32_t check;
+  uint8_t  bytes[kSize];
+};
+
+OTEL_FLIGHT_NOINIT Ring s_ring;
+
+std::atomic<bool>     s_active{false};
+std::atomic<uint8_t>  s_pending{0};      // FlightTrigger + 1, 0 = none
+std::atomic<uint32_t> s_dropped{0};
+uint32_t              s_lastErrorDumpMs = 0;
+bool                  s_errorDumped     = false;
+
+Mutex& recorderMutex() {
+  static Mutex m;
+  return m;
+}
+
+uint32_t checksum(const Ring& r) {
+  return r.magic ^ (r.head * 0x9E3779B1u) ^ (r.tail * 0x85EBCA77u) ^ (r.used * 0xC2B2AE3Du) ^ kSize;
+}
+
+void seal() { s_ring.check = checksum(s_ring); }
+
+void clear() {
+  s_ring.magic = kMagic;
+  s_ring.head = s_ring.tail = s_ring.used = 0;
+  seal();
+}
+
+bool valid() {
+  const Ring& r = s_ring;
+  return r.magic == kMagic && r.check == checksum(r) && r.head < kSize && r.tail < kSize &&
+         r.used <= kSize && (r.tail + r.used) % kSize == r.head;
+}
+
+// Wrapping copies; callers hold recorderMutex()
+void copyIn(uint32_t at, const void* data, size_t n) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  const size_t first = n < kSize - at ? n : kSize - at;
+  memcpy(s_ring.bytes + at, p, first);
+  memcpy(s_ring.bytes, p + first, n - first);
+}
+
+void copyOut(uint32_t at, void* data, size_t n) {
+  uint8_t* p = static_cast<uint8_t*>(data);
+  const size_t first = n < kSize - at ? n : kSize - at;
+  memcpy(p, s_ring.bytes + at, first);
+  memcpy(p + first, s_ring.bytes, n - first);
+}
+
+void evictOldest() {
+  uint16_t len = 0;
+  copyOut(s_ring.tail, &len, 2);
+  const uint32_t n = kHeader + len;
+  s_ring.tail = (s_ring.tail + n) % kSize;
+  s_ring.used = n < s_ring.used ? s_ring.used - n : 0;
+  if (!s_ring.used) s_ring.tail = s_ring.head;
+}
+
+bool resetWasCrash() {
+#if defined(ESP32)
+  switch (esp_reset_reason()) {
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+    case ESP_RST_BROWNOUT:
+      return true;
+    default:
+      return false;
+  }
+#elif defined(ARDUINO_ARCH_RP2040)
+  return watchdog_caused_reboot();
+#else
+  return false;
+#endif
+}
+
+const char* triggerName(FlightTrigger why) {
+  switch (why) {
+    case FlightTrigger::Manual:   return "manual";
+    case FlightTrigger::ErrorLog: return "error_log";
+    case FlightTrigger::Reset:    return "reset";
+  }
+  return "";
+}
+
+void servicePending() {
+  const uint8_t p = s_pending.exchange(0, std::memory_order_acq_rel);
+  if (p) (void)FlightRecorder::dump((FlightTrigger)(p - 1));
+}
+
+// ---- Decoding ---------------------------------------------------------------
+
+// Bounds-checked reader over one record: a torn window stops decoding rather
+// than reading past it
+struct Reader {
+  const uint8_t* p;
+  const uint8_t* end;
+  bool ok = true;
+
+  bool take(void* out, size_t n) {
+    if (!ok || (size_t)(end - p) < n) { ok = false; return false; }
+    memcpy(out, p, n);
+    p += n;
+    return true;
+  }
+  uint8_t  u8()  { uint8_t v = 0;  take(&v, 1); return v; }
+  uint64_t u64() { uint64_t v = 0; take(&v, 8); return v; }
+  String str() {
+    uint16_t n = 0;
+    if (!take(&n, 2) || (size_t)(end - p) < n) { ok = false; return String(); }
+    String s;
+    s.reserve(n);
+    for (uint16_t i = 0; i < n; ++i) s += (char)p[i];
+    p += n;
+    return s;
+  }
+  String hexId(size_t n) {
+    uint8_t b[16] = {};
+    take(b, n);
+    for (size_t i = 0; i < n; ++i) if (b[i]) return toHex(b, n);
+    return String();
+  }
+};
+
+String u64Str(uint64_t v) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%llu", (unsigned long long)v);
+  return String(buf);
+}
+
+void readAttrs(Reader& r, JsonObject owner) {
+  const uint8_t n = r.u8();
+  if (!n) return;
+  JsonArray attrs = owner["attributes"].to<JsonArray>();
+  for (uint8_t i = 0; i < n && r.ok; ++i) {
+    const uint8_t type = r.u8();
+    JsonObject a = attrs.add<JsonObject>();
+    a["key"] = r.str();
+    JsonObject v = a["value"].to<JsonObject>();
+    switch (type) {
+      case FlightRecorder::kAttrStr:  v["stringValue"] = r.str(); break;
+      case FlightRecorder::kAttrInt:  { int64_t x = 0; r.take(&x, 8); v["intValue"] = x; } break;
+      case FlightRecorder::kAttrDbl:  { double x = 0;  r.take(&x, 8); v["doubleValue"] = x; } break;
+      case FlightRecorder::kAttrBool: v["boolValue"] = r.u8() != 0; break;
+      default: r.ok = false; break;
+    }
+  }
+}
+
+void readSpan(Reader& r, JsonObject s) {
+  s["traceId"] = r.hexId(16);
+  s["spanId"]  = r.hexId(8);
+  const String parent = r.hexId(8);
+  if (parent.length()) s["parentSpanId"] = parent;
+  s["kind"] = 2;
+  s["startTimeUnixNano"] = u64Str(r.u64());
+  s["endTimeUnixNano"]   = u64Str(r.u64());
+  const uint8_t status = r.u8();
+  s["name"] = r.str();
+  const String message = r.str();
+  if (status) {
+    JsonObject st = s["status"].to<JsonObject>();
+    st["code"] = status;
+    if (message.length()) st["message"] = message;
+  }
+  readAttrs(r, s);
+  const uint8_t nEvents = r.u8();
+  if (!nEvents) return;
+  JsonArray evs = s["events"].to<JsonArray>();
+  for (uint8_t i = 0; i < nEvents && r.ok; ++i) {
+    JsonObject e = evs.add<JsonObject>();
+    e["timeUnixNano"] = u64Str(r.u64());
+    e["name"] = r.str();
+    readAttrs(r, e);
+  }
+}
+
+void readLog(Reader& r, JsonObject lr) {
+  const String traceId = r.hexId(16);
+  const String spanId  = r.hexId(8);
+  lr["timeUnixNano"]   = u64Str(r.u64());
+  lr["severityNumber"] = r.u8();
+  lr["severityText"]   = r.str();
+  lr["body"].to<JsonObject>()["stringValue"] = r.str();
+  if (traceId.length() && spanId.length()) {
+    lr["traceId"] = traceId;
+    lr["spanId"]  = spanId;
+  }
+  JsonArray attrs = lr["attributes"].to<JsonArray>();
+  for (const auto& kv : defaultLabels()) {
+    JsonObject a = attrs.add<JsonObject>();
+    a["key"] = kv.first;
+    a["value"].to<JsonObject>()["stringValue"] = kv.second;
+  }
+  const uint8_t n = r.u8();
+  for (uint8_t i = 0; i < n && r.ok; ++i) {
+    JsonObject a = attrs.add<JsonObject>();
+    a["key"] = r.str();
+    a["value"].to<JsonObject>()["stringValue"] = r.str();
+  }
+}
+
+// One request per signal, sent whenever the next record might not fit
+struct DumpRequest {
+  const char*  path;
+  JsonDocument doc;
+  size_t       bytes = 0;
+  size_t       count = 0;
+
+  explicit DumpRequest(const char* p) : path(p) {}
+
+  void send() {
+    if (count) OTelSender::sendJson(path, doc, OTelPriority::High);
+    doc.clear();
+    bytes = count = 0;
+  }
+};
+
+void setScope(JsonObject scope, const String& name, const String& version, FlightTrigger why) {
+  scope["name"] = name;
+  if (version.length()) scope["version"] = version;
+  JsonObject a = scope["attributes"].to<JsonArray>().add<JsonObject>();
+  a["key"] = "flight_recorder.trigger";
+  a["value"].to<JsonObject>()["stringValue"] = triggerName(why);
+}
+
+JsonObject nextSpan(DumpRequest& req, FlightTrigger why) {
+  if (!req.count++) {
+    (void)beginTracesRequest(req.doc);
+    setScope(req.doc["resourceSpans"][0]["scopeSpans"][0]["scope"].to<JsonObject>(),
+             tracerConfig().scopeName, tracerConfig().scopeVersion, why);
+  }
+  return req.doc["resourceSpans"][0]["scopeSpans"][0]["spans"].add<JsonObject>();
+}
+
+JsonObject nextLog(DumpRequest& req, FlightTrigger why) {
+  if (!req.count++) {
+    JsonObject rl = req.doc["resourceLogs"].to<JsonArray>().add<JsonObject>();
+    JsonArray rattrs = rl["resource"]["attributes"].to<JsonArray>();
+    addResAttr(rattrs, "service.name",        defaultServiceName());
+    addResAttr(rattrs, "service.instance.id", defaultServiceInstanceId());
+    addResAttr(rattrs, "host.name",           defaultHostName());
+    JsonObject sl = rl["scopeLogs"].to<JsonArray>().add<JsonObject>();
+    setScope(sl["scope"].to<JsonObject>(), logScopeConfig().scopeName,
+             logScopeConfig().scopeVersion, why);
+    sl["logRecords"].to<JsonArray>();
+  }
+  return req.doc["resourceLogs"][0]["scopeLogs"][0]["logRecords"].add<JsonObject>();
+}
+
+// Room left for records under OTEL_MAX_REQUEST_BYTES, after the envelope
+constexpr size_t kDumpBudget = OTEL_MAX_REQUEST_BYTES - 512;
+
+} // namespace
+
+bool FlightRecorder::active() { return s_active.load(std::memory_order_relaxed); }
+
+bool FlightRecorder::begin() {
+  if (!OTEL_FLIGHT_RECORDER_BYTES) return false;
+  if (s_active.load(std::memory_order_acquire)) return true;
+  const bool survived = valid() && s_ring.used && resetWasCrash();
+  if (!survived) {
+    MutexLock lock(recorderMutex());
+    clear();
+  }
+  const bool hooked = OTelSender::addHooks("flight recorder", servicePending, servicePending);
+  OTelSender::beginAsyncWorker();
+  // Queued now, sent once the exporter can reach the collector
+  if (survived) (void)dump(FlightTrigger::Reset);
+  // Without its hooks trigger() would never be served: stay off
+  if (!hooked) return false;
+  s_active.store(true, std::memory_order_release);
+  return true;
+}
+
+void FlightRecorder::trigger(FlightTrigger why) {
+  if (!OTEL_FLIGHT_RECORDER_BYTES || !active()) return;
+  if (why == FlightTrigger::ErrorLog) {
+    MutexLock lock(recorderMutex());
+    const uint32_t nowMs = Scheduler::now();
+    if (s_errorDumped && nowMs - s_lastErrorDumpMs < OTEL_FLIGHT_RECORDER_COOLDOWN_MS) return;
+    s_errorDumped     = true;
+    s_lastErrorDumpMs = nowMs;
+  }
+  uint8_t none = 0;
+  s_pending.compare_exchange_strong(none, (uint8_t)why + 1, std::memory_order_acq_rel);
+  OTelSender::wake();
+}
+
+size_t FlightRecorder::dump(FlightTrigger why) {
+  if (!OTEL_FLIGHT_RECORDER_BYTES) return 0;
+  // Copy the window out and empty the ring, so recording goes on while the
+  // copy is encoded
+  std::vector<uint8_t> window;
+  {
+    MutexLock lock(recorderMutex());
+    if (!valid()) { clear(); return 0; }
+    window.resize(s_ring.used);
+    if (s_ring.used) copyOut(s_ring.tail, window.data(), s_ring.used);
+    clear();
+  }
+
+  DumpRequest spans("/v1/traces");
+  DumpRequest logs("/v1/logs");
+  size_t n = 0;
+  const uint8_t* p   = window.data();
+  const uint8_t* end = p + window.size();
+  while ((size_t)(end - p) >= kHeader) {
+    uint16_t len = 0;
+    memcpy(&len, p, 2);
+    const uint8_t kind = p[2];
+    p += kHeader;
+    if ((size_t)(end - p) < len) break;
+    Reader r{p, p + len};
+    p += len;
+
+    DumpRequest& req = kind == kSpan ? spans : logs;
+    if (kind != kSpan && kind != kLog) continue;
+    if (req.count && req.bytes + 4u * len + 128 > kDumpBudget) req.send();
+    JsonObject rec = kind == kSpan ? nextSpan(req, why) : nextLog(req, why);
+    if (kind == kSpan) readSpan(r, rec); else readLog(r, rec);
+    if (!r.ok) break;
+    req.bytes += measureJson(rec) + 1;
+    ++n;
+  }
+  spans.send();
+  logs.send();
+  return n;
+}
+
+void FlightRecorder::recordLog(int severityNumber, const char* severity, const String& body,
+                               const std::map<String, String>& labels, uint64_t timeUnixNano,
+                               const char* traceId, const char* spanId) {
+  size_t n = 16 + 8 + 8 + 1 + Record::strBytes(strlen(severity)) + Record::strBytes(body.length()) + 1;
+  size_t nLabels = 0;
+  for (const auto& kv : labels) {
+    if (nLabels == 255) break;
+    n += Record::strBytes(kv.first.length()) + Record::strBytes(kv.second.length());
+    ++nLabels;
+  }
+  Record r(kLog, n);
+  if (!r) return;
+  r.putHexId(traceId, 16);
+  r.putHexId(spanId, 8);
+  r.putU64(timeUnixNano);
+  r.putU8((uint8_t)severityNumber);
+  r.putStr(severity, strlen(severity));
+  r.putStr(body);
+  r.putU8((uint8_t)nLabels);
+  for (const auto& kv : labels) {
+    if (!nLabels--) break;
+    r.putStr(kv.first);
+    r.putStr(kv.second);
+  }
+}
+
+size_t FlightRecorder::usedBytes() {
+  MutexLock lock(recorderMutex());
+  return active() ? s_ring.used : 0;
+}
+
+uint32_t FlightRecorder::droppedCount() { return s_dropped.load(std::memory_order_relaxed); }
+
+// ---- Record -----------------------------------------------------------------
+
+FlightRecorder::Record::Record(uint8_t kind, size_t payloadBytes) {
+  if (!enabled()) return;
+  const size_t total = kHeader + payloadBytes;
+  if (payloadBytes > 0xFFFF || total > kSize) {
+    s_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  recorderMutex().lock();
+  while (kSize - s_ring.used < total) evictOldest();
+  seal();
+  const uint16_t len = (uint16_t)payloadBytes;
+  copyIn(s_ring.head, &len, 2);
+  copyIn((s_ring.head + 2) % kSize, &kind, 1);
+  at_    = (s_ring.head + kHeader) % kSize;
+  total_ = (uint32_t)total;
+  left_  = payloadBytes;
+  ok_    = true;
+}
+
+FlightRecorder::Record::~Record() {
+  if (!ok_) return;
+  static const uint8_t kZeros[16] = {};
+  while (left_) put(kZeros, left_ < sizeof(kZeros) ? left_ : sizeof(kZeros));
+  // The record joins the window only once fully written
+  s_ring.head  = (s_ring.head + total_) % kSize;
+  s_ring.used += total_;
+  seal();
+  recorderMutex().unlock();
+}
+
+void FlightRecorder::Record::put(const void* data, size_t n) {
+  if (!ok_ || n > left_) return;
+  copyIn(at_, data, n);
+  at_    = (uint32_t)((at_ + n) % kSize);
+  left_ -= n;
+}
+
+void FlightRecorder::Record::putStr(const char* s, size_t n) {
+  const uint16_t len = (uint16_t)(n > 0xFFFF ? 0xFFFF : n);
+  put(&len, 2);
+  put(s, len);
+}
+
+void FlightRecorder::Record::putHexId(const char* hex, size_t bytes) {
+  uint8_t b[16] = {};
+  if (hex && strlen(hex) == 2 * bytes && bytes <= sizeof(b)) {
+    for (size_t i = 0; i < bytes; ++i) {
+      b[i] = (uint8_t)((hexNibble(hex[2 * i]) << 4) | hexNibble(hex[2 * i + 1]));
+    }
+  }
+  put(b, bytes);
+}
+
+} // namespace OTel
@@ -0,0 +1,159 @@
+#include "OtelHistogram.h"
+#include <string.h>
+
+static_assert(OTEL_EXPO_HISTOGRAM_MAX_BUCKETS >= 4 && OTEL_EXPO_HISTOGRAM_MAX_BUCKETS <= 65535,
+              "need 4..65535 buckets (scale -10 spans up to 3)");
+static_assert(OTEL_EXPO_HISTOGRAM_MAX_SCALE >= OTel::ExponentialHistogram::kMinScale &&
+              OTEL_EXPO_HISTOGRAM_MAX_SCALE <= 20, "scale out of the OTLP range");
+
+namespace OTel {
+
+// Floor division by 2^change (arithmetic shift on every supported compiler)
+static inline int32_t shiftDown(int32_t index, int change) { return index >> change; }
+
+int32_t ExponentialHistogram::indexOf(double value, int scale) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof bits);
+  int32_t  exp  = (int32_t)((bits >> 52) & 0x7FF);
+  uint64_t mant = bits & ((1ULL << 52) - 1);
+
+  if (exp == 0) {
+    // Subnormal: normalise so the leading 1 moves into the implicit bit
+    int lead = 63;
+    while (!(mant >> lead)) --lead;
+    const int shift = 52 - lead;
+    mant = (mant << shift) & ((1ULL << 52) - 1);
+    exp  = 1 - shift;
+  }
+  exp -= 1023;
+
+  // Boundaries are upper-inclusive, so an exact power of two belongs to the
+  // bucket below
+  if (scale <= 0) return shiftDown(mant ? exp : exp - 1, -scale);
+  if (mant == 0)  return exp * (1 << scale) - 1;
+
+  // floor(2^scale * log2(1.m)): each squaring of the mantissa yields one more
+  // bit of its base-2 logarithm
+  double  m   = 1.0 + (double)mant * (1.0 / 4503599627370496.0); // 2^-52
+  int32_t sub = 0;
+  for (int k = 0; k < scale; ++k) {
+    m *= m;
+    sub <<= 1;
+    if (m >= 2.0) { m *= 0.5; sub |= 1; }
+  }
+  return exp * (1 << scale) + sub;
+}
+
+int ExponentialHistogram::changeFor(const Buckets& b, int32_t lo, int32_t hi, int change) {
+  if (b.size) {
+    const int32_t end = b.offset + b.size - 1;
+    if (b.offset < lo) lo = b.offset;
+    if (end > hi)      hi = end;
+  }
+  // At scale 20 the indices of 4.9e-324 and 1e308 are over 2^31 apart
+  while ((int64_t)shiftDown(hi, change) - shiftDown(lo, change) + 1 > OTEL_EXPO_HISTOGRAM_MAX_BUCKETS) ++change;
+  return change;
+}
+
+void ExponentialHistogram::downscale(Buckets& b, int change) {
+  if (change <= 0 || b.size == 0) return;
+  const int32_t newOffset = shiftDown(b.offset, change);
+  // Target slots never run ahead of the source, so this folds in place
+  for (uint16_t i = 0; i < b.size; ++i) {
+    const uint32_t c = b.counts[i];
+    const int32_t  j = shiftDown(b.offset + i, change) - newOffset;
+    b.counts[i] = 0;
+    b.counts[j] += c;
+  }
+  b.size   = (uint16_t)(shiftDown(b.offset + b.size - 1, change) - newOffset + 1);
+  b.offset = newOffset;
+}
+
+void ExponentialHistogram::downscale(int change) {
+  if (change <= 0) return;
+  if (scale_ - change < kMinScale) change = scale_ - kMinScale;
+  downscale(pos_, change);
+  downscale(neg_, change);
+  scale_ -= change;
+}
+
+void ExponentialHistogram::add(Buckets& b, int32_t index, uint32_t n) {
+  if (b.size == 0) {
+    b.offset = index;
+    b.size   = 1;
+  } else if (index < b.offset) {
+    const uint16_t shift = (uint16_t)(b.offset - index);
+    memmove(b.counts + shift, b.counts, b.size * sizeof b.counts[0]);
+    memset(b.counts, 0, shift * sizeof b.counts[0]);
+    b.offset = index;
+    b.size  += shift;
+  } else if (index >= b.offset + b.size) {
+    b.size = (uint16_t)(index - b.offset + 1);  // slots past size are kept zero
+  }
+  b.counts[index - b.offset] += n;
+}
+
+void ExponentialHistogram::record(double value) {
+  if (value != value || value - value != 0) return; // NaN / +-inf
+
+  if (count_ == 0 || value < min_) min_ = value;
+  if (count_ == 0 || value > max_) max_ = value;
+  ++count_;
+  sum_ += value;
+  if (value == 0) { ++zero_; return; }
+
+  Buckets& b = value > 0 ? pos_ : neg_;
+  int32_t index = indexOf(value > 0 ? value : -value, scale_);
+  const int change = changeFor(b, index, index, 0);
+  if (change) {
+    const int before = scale_;
+    downscale(change);
+    index = shiftDown(index, before - scale_);  // buckets nest across scales
+  }
+  add(b, index, 1);
+}
+
+void ExponentialHistogram::merge(const ExponentialHistogram& other) {
+  if (other.count_ == 0) return;
+
+  // Common scale: the coarser one, then coarser until both ranges fit
+  const int target = scale_ < other.scale_ ? scale_ : other.scale_;
+  const int mine   = scale_ - target;
+  const int theirs = other.scale_ - target;
+  int change = 0;
+  const Buckets* bs[2][2] = { { &pos_, &other.pos_ }, { &neg_, &other.neg_ } };
+  for (auto& pair : bs) {
+    const Buckets& a = *pair[0];
+    const Buckets& o = *pair[1];
+    if (o.size == 0) continue;
+    Buckets scaled;  // only offset/size matter for the range check
+    if (a.size) {
+      scaled.offset = shiftDown(a.offset, mine);
+      scaled.size   = (uint16_t)(shiftDown(a.offset + a.size - 1, mine) - scaled.offset + 1);
+    }
+    change = changeFor(scaled, shiftDown(o.offset, theirs),
+                       shiftDown(o.offset + o.size - 1, theirs), change);
+  }
+  if (target - change < kMinScale) change = target - kMinScale;
+  downscale(mine + change);
+
+  const int shift = other.scale_ - scale_;
+  for (uint16_t i = 0; i < other.pos_.size; ++i) {
+    if (other.pos_.counts[i]) add(pos_, shiftDown(other.pos_.offset + i, shift), other.pos_.counts[i]);
+  }
+  for (uint16_t i = 0; i < other.neg_.size; ++i) {
+    if (other.neg_.counts[i]) add(neg_, shiftDown(other.neg_.offset + i, shift), other.neg_.counts[i]);
+  }
+
+  if (count_ == 0 || other.min_ < min_) min_ = other.min_;
+  if (count_ == 0 || other.max_ > max_) max_ = other.max_;
+  count_ += other.count_;
+  zero_  += other.zero_;
+  sum_   += other.sum_;
+}
+
+void ExponentialHistogram::reset() {
+  *this = ExponentialHistogram();
+}
+
+} // namespace OTel
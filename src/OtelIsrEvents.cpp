@@ -0,0 +1,104 @@
+#include "OtelIsrEvents.h"
+
+namespace OTel {
+
+namespace {
+std::atomic<IsrEventSource*> s_sources{nullptr};
+
+void drainAll() {
+  for (IsrEventSource* s = IsrEventSource::first(); s; s = s->next()) {
+    if (s->target() == IsrEventTarget::Log) (void)s->drainToLogs();
+  }
+}
+
+void toHex(const uint8_t* in, size_t n, char* out) {
+  static const char kHex[] = "0123456789abcdef";
+  for (size_t i = 0; i < n; ++i) {
+    out[2 * i]     = kHex[in[i] >> 4];
+    out[2 * i + 1] = kHex[in[i] & 0x0F];
+  }
+  out[2 * n] = '\0';
+}
+
+// Wall time of a capture, from the age of its micros() stamp
+uint64_t capturedAt(const IsrEvent& e) {
+  const uint32_t ageUs = (uint32_t)micros() - e.capturedUs;
+  return nowUnixNano() - (uint64_t)ageUs * 1000ULL;
+}
+} // namespace
+
+IsrEventSource* IsrEventSource::first() { return s_sources.load(std::memory_order_acquire); }
+
+OTEL_ISR_ATTR void IsrEventSource::link() {
+  // Same protocol as ProfileSite::link()
+  uint8_t expected = kUnlinked;
+  if (!state_.compare_exchange_strong(expected, kLinking, std::memory_order_acq_rel)) return;
+  IsrEventSource* head = s_sources.load(std::memory_order_relaxed);
+  do {
+    next_ = head;
+  } while (!s_sources.compare_exchange_weak(head, this, std::memory_order_release,
+                                            std::memory_order_relaxed));
+  state_.store(kLinked, std::memory_order_release);
+  if (target_ == IsrEventTarget::Log && !detail::inInterrupt()) enableIsrEventDrain();
+}
+
+bool IsrEventSource::pop(IsrEvent& out) {
+  const uint16_t t = tail_.load(std::memory_order_relaxed);
+  if (t == head_.load(std::memory_order_acquire)) return false;  // empty
+  out = ring_[t];
+  tail_.store((uint16_t)((t + 1) % kSlots), std::memory_order_release);
+  return true;
+}
+
+size_t IsrEventSource::pending() const {
+  const uint16_t h = head_.load(std::memory_order_acquire);
+  const uint16_t t = tail_.load(std::memory_order_acquire);
+  return (size_t)((h + kSlots - t) % kSlots);
+}
+
+String IsrEventSource::fieldName(uint8_t i) const {
+  if (fieldNames_ && fieldNames_[i]) return String(fieldNames_[i]);
+  return i ? String("value") + String(i) : String("value");
+}
+
+size_t IsrEventSource::drainToLogs(size_t max) {
+  size_t n = 0;
+  IsrEvent e;
+  char traceId[33], spanId[17];
+  while (n < max && pop(e)) {
+    ++n;
+    std::map<String, String> labels;
+    labels["isr.source"] = source_;
+    for (uint8_t i = 0; i < e.nFields; ++i) labels[fieldName(i)] = String(e.fields[i]);
+    if (e.hasContext) {
+      toHex(e.traceId, 16, traceId);
+      toHex(e.spanId,  8,  spanId);
+    } else {
+      traceId[0] = spanId[0] = '\0';
+    }
+    Logger::logAt(severity_, String(e.name), labels, capturedAt(e), traceId, spanId);
+  }
+  return n;
+}
+
+size_t IsrEventSource::drainInto(Span& span, size_t max) {
+  size_t n = 0;
+  IsrEvent e;
+  while (n < max && pop(e)) {
+    ++n;
+    std::vector<std::pair<String, String>> attrs;
+    attrs.reserve(e.nFields);
+    for (uint8_t i = 0; i < e.nFields; ++i) attrs.emplace_back(fieldName(i), String(e.fields[i]));
+    span.addEventAt(capturedAt(e), String(e.name), attrs);
+  }
+  return n;
+}
+
+void enableIsrEventDrain() {
+  static std::atomic<bool> s_enabled{false};
+  if (s_enabled.exchange(true, std::memory_order_acq_rel)) return;
+  OTelSender::addHooks("ISR events", drainAll, drainAll);
+  OTelSender::beginAsyncWorker();
+}
+
+} // namespace OTel
@@ -0,0 +1,65 @@
+#include "OtelIsrMetrics.h"
+
+namespace OTel {
+
+namespace {
+std::atomic<IsrInstrument*> s_instruments{nullptr};
+} // namespace
+
+IsrInstrument* IsrInstrument::first() { return s_instruments.load(std::memory_order_acquire); }
+
+OTEL_ISR_ATTR void IsrInstrument::link() {
+  // Same protocol as ProfileSite::link(): the CAS winner pushes the instrument,
+  // racers record into it before it is listed, which loses nothing
+  uint8_t expected = kUnlinked;
+  if (!state_.compare_exchange_strong(expected, kLinking, std::memory_order_acq_rel)) return;
+  IsrInstrument* head = s_instruments.load(std::memory_order_relaxed);
+  do {
+    next_ = head;
+  } while (!s_instruments.compare_exchange_weak(head, this, std::memory_order_release,
+                                                std::memory_order_relaxed));
+  state_.store(kLinked, std::memory_order_release);
+  if (!detail::inInterrupt()) enableIsrMetricsExport();
+}
+
+uint32_t IsrCounter::takeDelta() {
+  // Per-core slots wrap independently; their sum wraps the same way, so the
+  // difference of two sums is exact below 2^32
+  uint32_t total = 0;
+  for (const Slot& s : slots_) total += s.count.load(std::memory_order_relaxed);
+  const uint32_t delta = total - last_;
+  last_ = total;
+  return delta;
+}
+
+IsrHistogram::Delta IsrHistogram::takeDelta() {
+  uint32_t buckets[kMaxBuckets] = {};
+  uint64_t sum = 0;
+
+  for (Slot& s : slots_) {
+    uint32_t b[kMaxBuckets];
+    uint64_t t = 0;
+    // Seqlock read; a slot updated on every try is simply read as is
+    for (int tries = 0; tries < 8; ++tries) {
+      const uint32_t before = s.seq.load(std::memory_order_acquire);
+      for (size_t i = 0; i <= nBounds_; ++i) b[i] = s.buckets[i];
+      t = s.sum;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (!(before & 1) && s.seq.load(std::memory_order_relaxed) == before) break;
+    }
+    for (size_t i = 0; i <= nBounds_; ++i) buckets[i] += b[i];
+    sum += t;
+  }
+
+  Delta out;
+  for (size_t i = 0; i <= nBounds_; ++i) {
+    out.buckets[i]  = buckets[i] - lastBuckets_[i];
+    out.count      += out.buckets[i];
+    lastBuckets_[i] = buckets[i];
+  }
+  out.sum  = sum - lastSum_;
+  lastSum_ = sum;
+  return out;
+}
+
+} // namespace OTel
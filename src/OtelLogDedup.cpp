@@ -0,0 +1,144 @@
+#include "OtelLogDedup.h"
+#include "OtelMutex.h"
+#include "OtelScheduler.h"
+#include <atomic>
+#include <string.h>
+
+namespace OTel {
+
+namespace {
+
+struct Window {
+  bool       used     = false;
+  uint32_t   hash     = 0;
+  uint32_t   openedMs = 0;
+  String     templ;
+  LogRepeats rec;
+};
+
+Window                s_windows[OTEL_LOG_DEDUP_SLOTS];
+std::atomic<uint32_t> s_windowMs{OTEL_LOG_DEDUP_WINDOW_MS};
+std::atomic<uint32_t> s_suppressed{0};
+
+// Guards s_windows; records are logged from loop() and the worker
+Mutex& dedupMutex() {
+  static Mutex m;
+  return m;
+}
+
+// FNV-1a over severity, template and the (sorted) attributes
+uint32_t hashRecord(int severityNumber, const char* templ,
+                    const std::map<String, String>& labels) {
+  uint32_t h = 2166136261u;
+  auto mix = [&h](const char* s, size_t n) {
+    for (size_t i = 0; i < n; ++i) { h ^= (uint8_t)s[i]; h *= 16777619u; }
+    h ^= 0xFF; h *= 16777619u;  // separator, so "ab"+"c" != "a"+"bc"
+  };
+  h ^= (uint8_t)severityNumber; h *= 16777619u;
+  mix(templ, strlen(templ));
+  for (const auto& kv : labels) {
+    mix(kv.first.c_str(), kv.first.length());
+    mix(kv.second.c_str(), kv.second.length());
+  }
+  return h;
+}
+
+// Caller holds dedupMutex()
+bool matches(const Window& w, uint32_t hash, int severityNumber, const char* templ,
+             const std::map<String, String>& labels) {
+  return w.used && w.hash == hash && w.rec.severityNumber == severityNumber &&
+         w.templ == templ && w.rec.labels == labels;
+}
+
+bool ended(const Window& w, uint32_t nowMs, uint32_t windowMs) {
+  return nowMs - w.openedMs >= windowMs;
+}
+
+void copyId(char* dst, size_t cap, const char* src) {
+  strncpy(dst, src ? src : "", cap - 1);
+  dst[cap - 1] = '\0';
+}
+
+} // namespace
+
+void LogDedup::setWindow(uint32_t ms) { s_windowMs.store(ms, std::memory_order_relaxed); }
+uint32_t LogDedup::window() { return s_windowMs.load(std::memory_order_relaxed); }
+uint32_t LogDedup::suppressedCount() { return s_suppressed.load(std::memory_order_relaxed); }
+
+bool LogDedup::repeat(int severityNumber, const char* templ,
+                      const std::map<String, String>& labels, uint64_t timeNs) {
+  const uint32_t windowMs = window();
+  if (!windowMs) return false;
+  const uint32_t hash = hashRecord(severityNumber, templ, labels);
+
+  MutexLock lock(dedupMutex());
+  for (Window& w : s_windows) {
+    if (!matches(w, hash, severityNumber, templ, labels)) continue;
+    if (ended(w, Scheduler::now(), windowMs)) return false;  // sent again; remember() reports the old window
+    if (w.rec.count++ == 0) w.rec.firstNs = timeNs;
+    w.rec.lastNs = timeNs;
+    s_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void LogDedup::remember(const char* severity, int severityNumber, const char* templ,
+                        const String& message, const std::map<String, String>& labels,
+                        const char* traceId, const char* spanId, LogRepeatsSink sink) {
+  if (!window()) return;
+  const uint32_t hash = hashRecord(severityNumber, templ, labels);
+  LogRepeats closed;
+
+  {
+    MutexLock lock(dedupMutex());
+    Window* target = nullptr;
+    Window* oldest = nullptr;
+    for (Window& w : s_windows) {
+      if (matches(w, hash, severityNumber, templ, labels)) { target = &w; break; }
+      if (!w.used) { if (!target) target = &w; continue; }
+      if (!oldest || (int32_t)(w.openedMs - oldest->openedMs) < 0) oldest = &w;
+    }
+    if (!target) target = oldest;  // table full: evict the oldest window
+    if (target->used && target->rec.count) closed = std::move(target->rec);
+
+    target->used     = true;
+    target->hash     = hash;
+    target->openedMs = Scheduler::now();
+    target->templ    = templ;
+    LogRepeats& r    = target->rec;
+    r.severity       = severity;
+    r.severityNumber = severityNumber;
+    r.message        = message;
+    r.labels         = labels;
+    r.count          = 0;
+    r.firstNs = r.lastNs = 0;
+    copyId(r.traceId, sizeof(r.traceId), traceId);
+    copyId(r.spanId,  sizeof(r.spanId),  spanId);
+  }
+  if (closed.count && sink) sink(closed);
+}
+
+size_t LogDedup::expire(bool all, LogRepeatsSink sink) {
+  const uint32_t windowMs = window();
+  LogRepeats closed[OTEL_LOG_DEDUP_SLOTS];
+  size_t n = 0;
+
+  {
+    MutexLock lock(dedupMutex());
+    const uint32_t nowMs = Scheduler::now();
+    for (Window& w : s_windows) {
+      if (!w.used || !(all || !windowMs || ended(w, nowMs, windowMs))) continue;
+      if (w.rec.count) closed[n++] = std::move(w.rec);
+      w.used = false;
+      w.rec.labels.clear();
+      w.rec.message = String();
+      w.templ       = String();
+    }
+  }
+  // Sent outside the lock: the sink serialises and may wait for queue space
+  for (size_t i = 0; i < n; ++i) if (sink) sink(closed[i]);
+  return n;
+}
+
+} // namespace OTel
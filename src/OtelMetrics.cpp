@@ -1,22 +1,31 @@
 #include "OtelMetrics.h"
+#include "OtelScheduler.h"
+#include "OtelMutex.h"
+#include "OtelProfile.h"
+#include "OtelIsrMetrics.h"
+#include <memory>
 
 namespace OTel {
 
+#if OTEL_ENABLE_METRICS
+
+static const char kOverflowKey[] = "otel.metric.overflow";
+
 // Helper: merge default + per-call labels into a datapoint attributes array
 static void addPointAttributes(JsonArray& attrArray,
                                const std::map<String, String>& callLabels) {
-  // Defaults first
-  for (const auto& kv : defaultMetricLabels()) {
+  // OTLP data points have no dropped-attributes count: extras are just omitted
+  auto add = [&](const String& key, const String& value) {
+    if (attrArray.size() >= OTEL_ATTRIBUTE_COUNT_LIMIT) return;
     JsonObject a = attrArray.add<JsonObject>();
-    a["key"] = kv.first;
-    a["value"].to<JsonObject>()["stringValue"] = kv.second;
-  }
+    a["key"] = key;
+    if (key == kOverflowKey) { a["value"].to<JsonObject>()["boolValue"] = true; return; }
+    setLimitedString(a["value"].to<JsonObject>()["stringValue"], value);
+  };
+  // Defaults first
+  for (const auto& kv : defaultMetricLabels()) add(kv.first, kv.second);
   // Then per-call (override by reusing key downstream in the stack)
-  for (const auto& kv : callLabels) {
-    JsonObject a = attrArray.add<JsonObject>();
-    a["key"] = kv.first;
-    a["value"].to<JsonObject>()["stringValue"] = kv.second;
-  }
+  for (const auto& kv : callLabels) add(kv.first, kv.second);
 }
 
 static void addCommonResource(JsonObject& resource) {
@@ -31,12 +40,419 @@ static void addCommonScope(JsonObject& scope) {
   scope["version"] = metricsScopeConfig().scopeVersion;
 }
 
+// collect() output. Metrics are opened on their first data point, and the
+// encoded size is tracked as points are added; a point that would take the
+// request over OTEL_MAX_REQUEST_BYTES is moved, with its metric's header, to
+// a new request and the full one is sent.
+class MetricsRequest {
+public:
+  enum class Shape : uint8_t { Gauge, Sum, Histogram, ExponentialHistogram };
+
+  explicit MetricsRequest(JsonLease& lease) : lease_(lease), doc_(lease.doc()) {}
+
+  // Following points belong to this metric. temporality: 1 delta, 2 cumulative.
+  void beginMetric(const String& name, const String& unit, Shape shape,
+                   uint8_t temporality = 2, bool monotonic = false) {
+    name_        = name;
+    unit_        = unit;
+    shape_       = shape;
+    temporality_ = temporality;
+    monotonic_   = monotonic;
+    dps_         = JsonArray();
+  }
+
+  // Fill the returned point, then hand it to endPoint()
+  JsonObject addPoint() {
+    if (dps_.isNull()) openMetric();
+    return dps_.add<JsonObject>();
+  }
+
+  void endPoint(JsonObject dp) {
+    const size_t n = measureJson(dp) + 1;
+    if (requestPoints_ && bytes_ + n > OTEL_MAX_REQUEST_BYTES) {
+      // A point alone in its request is sent as is (and refused if oversize)
+      String raw;
+      serializeJson(dp, raw);
+      dps_.remove(dps_.size() - 1);
+      if (metricPoints_ == 0) metrics_.remove(metrics_.size() - 1);
+      send();
+      openMetric();
+      dps_.add(serialized(raw));
+    }
+    bytes_ += n;
+    ++requestPoints_;
+    ++metricPoints_;
+    ++points_;
+  }
+
+  // Send what is left; returns the data points exported
+  size_t finish() {
+    send();
+    return points_;
+  }
+
+private:
+  void openMetric() {
+    if (metrics_.isNull()) {
+      JsonObject rm = doc_["resourceMetrics"].to<JsonArray>().add<JsonObject>();
+      JsonObject resource = rm["resource"].to<JsonObject>();
+      addCommonResource(resource);
+      JsonObject sm = rm["scopeMetrics"].to<JsonArray>().add<JsonObject>();
+      JsonObject scope = sm["scope"].to<JsonObject>();
+      addCommonScope(scope);
+      metrics_ = sm["metrics"].to<JsonArray>();
+      bytes_   = measureJson(doc_);
+    }
+    JsonObject metric = metrics_.add<JsonObject>();
+    metric["name"] = name_;
+    metric["unit"] = unit_;
+    const char* key = shape_ == Shape::Gauge     ? "gauge"
+                    : shape_ == Shape::Sum       ? "sum"
+                    : shape_ == Shape::Histogram ? "histogram" : "exponentialHistogram";
+    JsonObject data = metric[key].to<JsonObject>();
+    if (shape_ == Shape::Sum) data["isMonotonic"] = monotonic_;
+    if (shape_ != Shape::Gauge) data["aggregationTemporality"] = temporality_;
+    dps_ = data["dataPoints"].to<JsonArray>();
+    metricPoints_ = 0;
+    bytes_ += measureJson(metric) + 1;
+  }
+
+  void send() {
+    if (requestPoints_) {
+      OTelSender::sendJson("/v1/metrics", doc_, OTelPriority::Normal, lease_.scratch());
+    }
+    doc_.clear();
+    metrics_       = JsonArray();
+    dps_           = JsonArray();
+    bytes_         = 0;
+    requestPoints_ = 0;
+  }
+
+  JsonLease&    lease_;
+  JsonDocument& doc_;
+  JsonArray     metrics_;
+  JsonArray     dps_;            // of the current metric in this request
+  String        name_;
+  String        unit_;
+  Shape         shape_       = Shape::Gauge;
+  uint8_t       temporality_ = 2;
+  bool          monotonic_   = false;
+  size_t        bytes_         = 0;
+  size_t        requestPoints_ = 0;
+  size_t        metricPoints_  = 0;
+  size_t        points_        = 0;
+};
+
+// ----------------- VIEWS -----------------
+namespace {
+
+static_assert(OTEL_METRIC_MAX_INSTRUMENTS <= 127, "instrument ids are stored as int8_t");
+
+// Appended by the control path, read lock-free: a slot is fully written before
+// the count that publishes it is released (Views are never removed).
+MetricView          s_views[OTEL_MAX_VIEWS];
+std::atomic<size_t> s_viewCount{0};
+std::atomic<bool>   s_aggregating{false};   // some View keeps series in memory
+
+// Attribute sets seen per exported instrument. The overflow set is implied, so
+// at most limit - 1 real sets are admitted.
+struct InstrumentSeries {
+  String            name;
+  MetricAggregation aggregation = MetricAggregation::Default;
+  uint16_t          limit = OTEL_METRIC_CARDINALITY_LIMIT;
+  uint16_t          count = 0;
+  uint32_t          sets[OTEL_METRIC_CARDINALITY_LIMIT];
+};
+
+// One aggregated series (LastValue / Sum / ExponentialHistogram)
+struct AggregatedStream {
+  int8_t   instrument = -1;   // -1 = free slot
+  bool     monotonic  = false;
+  uint32_t hash       = 0;
+  std::map<String, String> attrs;
+  String   unit;
+  double   value      = 0;
+  uint64_t startNs    = 0;
+  std::unique_ptr<ExponentialHistogram> histogram;  // allocated on first use
+  DefaultExemplarReservoir exemplars;               // since the last collection
+};
+
+// Guards the two tables below; gauge()/sum() run on the caller's thread while
+// the worker collects
+Mutex& seriesMutex() {
+  static Mutex m;
+  return m;
+}
+InstrumentSeries s_instruments[OTEL_METRIC_MAX_INSTRUMENTS];
+size_t           s_instrumentCount = 0;
+AggregatedStream s_streams[OTEL_METRIC_MAX_STREAMS];
+std::atomic<uint32_t> s_overflow{0};
+
+const std::map<String, String>& overflowAttributes() {
+  static const std::map<String, String> attrs = { { kOverflowKey, "true" } };
+  return attrs;
+}
+
+bool viewMatches(const MetricView& v, const String& instrument) {
+  const size_t n = v.instrument.length();
+  if (n && v.instrument[n - 1] == '*') {
+    return strncmp(instrument.c_str(), v.instrument.c_str(), n - 1) == 0;
+  }
+  return v.instrument == instrument;
+}
+
+const MetricView* findView(const String& instrument) {
+  const size_t n = s_viewCount.load(std::memory_order_acquire);
+  for (size_t i = 0; i < n; ++i) {
+    if (viewMatches(s_views[i], instrument)) return &s_views[i];
+  }
+  return nullptr;
+}
+
+bool containsKey(const std::vector<String>& keys, const String& key) {
+  for (const auto& k : keys) if (k == key) return true;
+  return false;
+}
+
+// FNV-1a over the (sorted) key/value pairs
+uint32_t hashAttributes(const std::map<String, String>& attrs) {
+  uint32_t h = 2166136261u;
+  auto mix = [&h](const String& s) {
+    for (size_t i = 0; i < s.length(); ++i) { h ^= (uint8_t)s[i]; h *= 16777619u; }
+    h ^= 0xFF; h *= 16777619u;  // separator, so "ab"+"c" != "a"+"bc"
+  };
+  for (const auto& kv : attrs) { mix(kv.first); mix(kv.second); }
+  return h;
+}
+
+// Caller holds seriesMutex(). Returns -1 when the table is full.
+int instrumentFor(const String& name, const MetricView* view, MetricAggregation aggregation) {
+  for (size_t i = 0; i < s_instrumentCount; ++i) {
+    if (s_instruments[i].name == name) return (int)i;
+  }
+  if (s_instrumentCount >= OTEL_METRIC_MAX_INSTRUMENTS) return -1;
+
+  InstrumentSeries& inst = s_instruments[s_instrumentCount];
+  inst.name        = name;
+  inst.aggregation = aggregation;
+  inst.count       = 0;
+  inst.limit       = OTEL_METRIC_CARDINALITY_LIMIT;
+  if (view && view->cardinalityLimit && view->cardinalityLimit < inst.limit) {
+    inst.limit = view->cardinalityLimit;
+  }
+  return (int)s_instrumentCount++;
+}
+
+// Caller holds seriesMutex(). False = the set must go to the overflow series.
+bool admitSet(InstrumentSeries& inst, uint32_t hash) {
+  for (uint16_t i = 0; i < inst.count; ++i) {
+    if (inst.sets[i] == hash) return true;
+  }
+  if (inst.count + 1 >= inst.limit) return false;
+  inst.sets[inst.count++] = hash;
+  return true;
+}
+
+// Caller holds seriesMutex()
+AggregatedStream* findStream(int instrument, uint32_t hash, const std::map<String, String>& attrs) {
+  AggregatedStream* slot = nullptr;
+  for (auto& st : s_streams) {
+    if (st.instrument == instrument && st.hash == hash && st.attrs == attrs) return &st;
+    if (st.instrument < 0 && !slot) slot = &st;
+  }
+  if (slot) {
+    slot->instrument = (int8_t)instrument;
+    slot->hash       = hash;
+    slot->attrs      = attrs;
+    slot->value      = 0;
+    slot->startNs    = nowUnixNano();
+    slot->exemplars.reset();
+  }
+  return slot;
+}
+
+enum class Source : uint8_t { Call, Observable, Histogram, Counter };
+
+// One measurement after Views and the cardinality cap have been applied
+class Series {
+public:
+  Series(const String& instrument, const std::map<String, String>& labels, Source source)
+  : view_(findView(instrument)), name_(&instrument), attrs_(&labels) {
+    if (view_) {
+      aggregation_ = view_->aggregation;
+      if (view_->name.length()) name_ = &view_->name;
+    }
+    // Observables are already aggregated by their callback: only Drop applies
+    if (source == Source::Observable && aggregation_ != MetricAggregation::Drop) {
+      aggregation_ = MetricAggregation::Default;
+    }
+    // Histogram instruments aggregate by default
+    if (source == Source::Histogram && aggregation_ == MetricAggregation::Default) {
+      aggregation_ = MetricAggregation::ExponentialHistogram;
+    }
+    // Internal counters (span metrics) are summed by default
+    if (source == Source::Counter && aggregation_ == MetricAggregation::Default) {
+      aggregation_ = MetricAggregation::Sum;
+    }
+    if (aggregation_ == MetricAggregation::Drop) return;
+
+    if (view_ && (!view_->attributeKeys.empty() || !view_->excludeKeys.empty())) {
+      for (const auto& kv : labels) {
+        if (!view_->attributeKeys.empty() && !containsKey(view_->attributeKeys, kv.first)) continue;
+        if (containsKey(view_->excludeKeys, kv.first)) continue;
+        filtered_.insert(kv);
+      }
+      attrs_ = &filtered_;
+    }
+
+    hash_ = hashAttributes(*attrs_);
+    MutexLock lock(seriesMutex());
+    instrument_ = instrumentFor(*name_, view_, aggregation_);
+    // Untracked instrument: its sets cannot be capped, so every point goes to
+    // the overflow series (and an aggregated one has no stream to go to)
+    if (instrument_ < 0 || !admitSet(s_instruments[instrument_], hash_)) {
+      attrs_ = &overflowAttributes();
+      hash_  = hashAttributes(*attrs_);
+      s_overflow.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  bool dropped() const { return aggregation_ == MetricAggregation::Drop; }
+  bool aggregated() const {
+    return aggregation_ == MetricAggregation::LastValue || aggregation_ == MetricAggregation::Sum ||
+           aggregation_ == MetricAggregation::ExponentialHistogram;
+  }
+  const String& name() const { return *name_; }
+  const std::map<String, String>& attributes() const { return *attrs_; }
+
+  // Fold the value into this series' in-memory stream. `cumulative` values are
+  // running totals already and replace the sum instead of adding to it.
+  void accumulate(double value, const String& unit, bool monotonic, bool cumulative) {
+    MutexLock lock(seriesMutex());
+    AggregatedStream* st = stream(unit, monotonic);
+    if (!st) return;
+    if (st->histogram) st->histogram->record(value);
+    else if (aggregation_ == MetricAggregation::Sum && !cumulative) st->value += value;
+    else st->value = value;
+    st->exemplars.offer(value);
+  }
+
+  // Fold in a histogram recorded elsewhere. Sum Views add its sum; a LastValue
+  // View has no last value to take and ignores it. The merged histogram has no
+  // individual measurements, so it offers no exemplar.
+  void accumulate(const ExponentialHistogram& h, const String& unit) {
+    MutexLock lock(seriesMutex());
+    AggregatedStream* st = stream(unit, false);
+    if (!st) return;
+    if (st->histogram) st->histogram->merge(h);
+    else if (aggregation_ == MetricAggregation::Sum) st->value += h.sum();
+  }
+
+private:
+  // Caller holds seriesMutex()
+  AggregatedStream* stream(const String& unit, bool monotonic) {
+    AggregatedStream* st = nullptr;
+    if (instrument_ >= 0) {
+      st = findStream(instrument_, hash_, *attrs_);
+      if (!st && attrs_ != &overflowAttributes()) {
+        // Out of stream slots: keep the value in the overflow series
+        st = findStream(instrument_, hashAttributes(overflowAttributes()), overflowAttributes());
+        s_overflow.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    if (!st) return nullptr;
+    if (st->unit.length() == 0) {
+      st->unit      = unit;
+      st->monotonic = monotonic && aggregation_ == MetricAggregation::Sum;
+      if (aggregation_ == MetricAggregation::ExponentialHistogram) {
+        st->histogram.reset(new ExponentialHistogram());
+      }
+    }
+    return st;
+  }
+
+  const MetricView*               view_;
+  const String*                   name_;
+  const std::map<String, String>* attrs_;
+  std::map<String, String>        filtered_;
+  MetricAggregation aggregation_ = MetricAggregation::Default;
+  int      instrument_ = -1;
+  uint32_t hash_       = 0;
+};
+
+// Start the metric of an aggregated series in `req`
+void beginStreamMetric(MetricsRequest& req, const InstrumentSeries& inst, const AggregatedStream& st) {
+  using Shape = MetricsRequest::Shape;
+  const Shape shape = inst.aggregation == MetricAggregation::ExponentialHistogram ? Shape::ExponentialHistogram
+                    : inst.aggregation == MetricAggregation::LastValue ? Shape::Gauge : Shape::Sum;
+  req.beginMetric(inst.name, st.unit, shape, 2, st.monotonic);  // cumulative
+}
+
+void addBuckets(JsonObject out, const ExponentialHistogram::Buckets& b) {
+  out["offset"] = b.offset;
+  JsonArray counts = out["bucketCounts"].to<JsonArray>();
+  for (size_t i = 0; i < b.size; ++i) counts.add(b.at(i));
+}
+
+void addHistogramPoint(JsonObject dp, const ExponentialHistogram& h) {
+  dp["count"]     = u64ToStr(h.count());
+  dp["sum"]       = h.sum();
+  dp["scale"]     = h.scale();
+  dp["zeroCount"] = u64ToStr(h.zeroCount());
+  addBuckets(dp["positive"].to<JsonObject>(), h.positive());
+  addBuckets(dp["negative"].to<JsonObject>(), h.negative());
+  if (h.count()) {
+    dp["min"] = h.min();
+    dp["max"] = h.max();
+  }
+}
+
+// Writes every aggregated series into `req`. A full request is sent with the
+// series lock held; on the worker that only joins the batch.
+void exportStreams(MetricsRequest& req, uint64_t now) {
+  MutexLock lock(seriesMutex());
+  for (size_t i = 0; i < s_instrumentCount; ++i) {
+    const InstrumentSeries& inst = s_instruments[i];
+    if (inst.aggregation != MetricAggregation::LastValue &&
+        inst.aggregation != MetricAggregation::Sum &&
+        inst.aggregation != MetricAggregation::ExponentialHistogram) continue;
+
+    size_t first = 0;
+    while (first < OTEL_METRIC_MAX_STREAMS && s_streams[first].instrument != (int)i) ++first;
+    if (first == OTEL_METRIC_MAX_STREAMS) continue;
+    beginStreamMetric(req, inst, s_streams[first]);
+
+    for (size_t k = first; k < OTEL_METRIC_MAX_STREAMS; ++k) {
+      AggregatedStream& st = s_streams[k];
+      if (st.instrument != (int)i) continue;
+      JsonObject dp = req.addPoint();
+      if (inst.aggregation != MetricAggregation::LastValue) dp["startTimeUnixNano"] = u64ToStr(st.startNs);
+      dp["timeUnixNano"] = u64ToStr(now);
+      if (st.histogram) addHistogramPoint(dp, *st.histogram);
+      else              dp["asDouble"] = st.value;
+      JsonArray attrs = dp["attributes"].to<JsonArray>();
+      addPointAttributes(attrs, st.attrs);
+      // Exemplars describe this collection interval only
+      st.exemplars.toJson(dp);
+      st.exemplars.reset();
+      req.endPoint(dp);
+    }
+  }
+}
+
+} // namespace
+
 // ----------------- GAUGE -----------------
 void Metrics::buildAndSendGauge(const String& name, double value,
                                 const String& unit,
                                 const std::map<String,String>& labels)
 {
-  JsonDocument doc;
+  Series series(name, labels, Source::Call);
+  if (series.dropped()) return;
+  if (series.aggregated()) { series.accumulate(value, unit, false, false); return; }
+
+  JsonLease lease(OTelSignal::Metrics);
+  JsonDocument& doc = lease.doc();
 
   JsonArray resourceMetrics = doc["resourceMetrics"].to<JsonArray>();
   JsonObject rm = resourceMetrics.add<JsonObject>();
@@ -53,7 +469,7 @@ void Metrics::buildAndSendGauge(const String& name, double value,
   // metric
   JsonArray metrics = sm["metrics"].to<JsonArray>();
   JsonObject metric = metrics.add<JsonObject>();
-  metric["name"] = name;
+  metric["name"] = series.name();
   metric["unit"] = unit;
   metric["type"] = "gauge";
 
@@ -61,13 +477,18 @@ void Metrics::buildAndSendGauge(const String& name, double value,
   JsonArray dps = gauge["dataPoints"].to<JsonArray>();
   JsonObject dp = dps.add<JsonObject>();
 
-  dp["timeUnixNano"] = u64ToStr(nowUnixNano());
+  const uint64_t now = nowUnixNano();
+  dp["timeUnixNano"] = u64ToStr(now);
   dp["asDouble"]     = value;
 
   JsonArray attrs = dp["attributes"].to<JsonArray>();
-  addPointAttributes(attrs, labels);
+  addPointAttributes(attrs, series.attributes());
 
-  OTelSender::sendJson("/v1/metrics", doc);
+  // The point is this one measurement: link it to the active span if sampled
+  Exemplar exemplar;
+  if (exemplar.capture(value, now)) exemplar.toJson(dp["exemplars"].to<JsonArray>());
+
+  OTelSender::sendJson("/v1/metrics", doc, OTelPriority::Normal, lease.scratch());
 }
 
 // ----------------- SUM -------------------
@@ -77,7 +498,15 @@ void Metrics::buildAndSendSum(const String& name, double value,
                               const String& unit,
                               const std::map<String,String>& labels)
 {
-  JsonDocument doc;
+  Series series(name, labels, Source::Call);
+  if (series.dropped()) return;
+  if (series.aggregated()) {
+    series.accumulate(value, unit, isMonotonic, temporality == "CUMULATIVE");
+    return;
+  }
+
+  JsonLease lease(OTelSignal::Metrics);
+  JsonDocument& doc = lease.doc();
 
   JsonArray resourceMetrics = doc["resourceMetrics"].to<JsonArray>();
   JsonObject rm = resourceMetrics.add<JsonObject>();
@@ -94,7 +523,7 @@ void Metrics::buildAndSendSum(const String& name, double value,
   // metric
   JsonArray metrics = sm["metrics"].to<JsonArray>();
   JsonObject metric = metrics.add<JsonObject>();
-  metric["name"] = name;
+  metric["name"] = series.name();
   metric["unit"] = unit;
   metric["type"] = "sum";
 
@@ -105,14 +534,328 @@ void Metrics::buildAndSendSum(const String& name, double value,
   JsonArray dps = sum["dataPoints"].to<JsonArray>();
   JsonObject dp = dps.add<JsonObject>();
 
-  dp["timeUnixNano"] = u64ToStr(nowUnixNano());
+  const uint64_t now = nowUnixNano();
+  dp["timeUnixNano"] = u64ToStr(now);
   dp["asDouble"]     = value;
 
+  JsonArray attrs = dp["attributes"].to<JsonArray>();
+  addPointAttributes(attrs, series.attributes());
+
+  // The point is this one measurement: link it to the active span if sampled
+  Exemplar exemplar;
+  if (exemplar.capture(value, now)) exemplar.toJson(dp["exemplars"].to<JsonArray>());
+
+  OTelSender::sendJson("/v1/metrics", doc, OTelPriority::Normal, lease.scratch());
+}
+
+// ----------------- OBSERVABLES -----------
+namespace {
+
+struct ObservableInstrument {
+  ObservableKind     kind = ObservableKind::Gauge;
+  String             name;
+  String             unit;
+  ObservableCallback callback;
+  uint64_t           startNs = 0;  // start of the cumulative series
+};
+
+// Filled by the control path, read by the worker: a slot is fully written
+// before the count that publishes it is released.
+ObservableInstrument s_observables[OTEL_MAX_OBSERVABLES];
+std::atomic<size_t>  s_observableCount{0};
+std::atomic<uint32_t> s_exportIntervalMs{OTEL_METRIC_EXPORT_INTERVAL_MS};
+uint32_t             s_lastCollectMs    = 0;
+
+// Periodic collection timer; created and re-armed on the worker
+int      s_collectTimer   = Scheduler::kInvalidTimer;
+uint32_t s_armedInterval  = 0;
+
+void collectTask(void*) { (void)Metrics::collect(); }
+void collectNow() { (void)Metrics::collect(); }  // OTelSender::flush() hook
+
+// Worker hook: keeps the collection timer armed at the current export interval
+void scheduleCollection() {
+  if (s_collectTimer == Scheduler::kInvalidTimer) {
+    s_collectTimer = Scheduler::create(collectTask);
+    if (s_collectTimer == Scheduler::kInvalidTimer) return;
+  }
+  const uint32_t interval = s_exportIntervalMs.load(std::memory_order_relaxed);
+  if (interval != s_armedInterval) {
+    if (interval) Scheduler::armEvery(s_collectTimer, interval);
+    else          Scheduler::cancel(s_collectTimer); // 0 = collect() on demand only
+    s_armedInterval = interval;
+  }
+}
+
+} // namespace
+
+static void fillObservedPoint(JsonObject dp, uint64_t now, uint64_t start, double value,
+                              const std::map<String,String>& labels) {
+  if (start) dp["startTimeUnixNano"] = u64ToStr(start);
+  dp["timeUnixNano"] = u64ToStr(now);
+  dp["asDouble"]     = value;
   JsonArray attrs = dp["attributes"].to<JsonArray>();
   addPointAttributes(attrs, labels);
+}
+
+void ObservableResult::observe(double value, const std::map<String,String>& labels) {
+  auto add = [&](const std::map<String,String>& attrs) {
+    if (!request_) { fillObservedPoint(dps_.add<JsonObject>(), now_, start_, value, attrs); return; }
+    JsonObject dp = request_->addPoint();
+    fillObservedPoint(dp, now_, start_, value, attrs);
+    request_->endPoint(dp);
+  };
+  if (instrument_) {
+    Series series(*instrument_, labels, Source::Observable);
+    if (series.dropped()) return;
+    add(series.attributes());
+  } else {
+    add(labels);
+  }
+  ++count_;
+}
+
+void ObservableResult::observe(double value,
+                               std::initializer_list<std::pair<const char*, const char*>> kvs) {
+  std::map<String, String> labels;
+  for (auto &kv : kvs) labels[String(kv.first)] = String(kv.second);
+  observe(value, labels);
+}
+
+bool Metrics::registerObservable(ObservableKind kind, const String& name,
+                                 const String& unit, ObservableCallback callback) {
+  size_t n = s_observableCount.load(std::memory_order_relaxed);
+  if (n >= OTEL_MAX_OBSERVABLES || !callback) return false;
+
+  ObservableInstrument& inst = s_observables[n];
+  inst.kind     = kind;
+  inst.name     = name;
+  inst.unit     = unit;
+  inst.callback = std::move(callback);
+  inst.startNs  = nowUnixNano();
+  s_observableCount.store(n + 1, std::memory_order_release);
 
-  OTelSender::sendJson("/v1/metrics", doc);
+  // Collection is a scheduler timer on the sender worker (or OTelSender::service())
+  OTelSender::addHooks("metrics", scheduleCollection, collectNow);
+  OTelSender::beginAsyncWorker();
+  return true;
 }
 
+// Aggregated series are exported by the periodic collection
+// OTEL_PROFILE_SCOPE sites: one delta histogram (count, sum, min, max; no
+// buckets) per site, in microseconds
+static void exportProfileSites(MetricsRequest& req, uint64_t now) {
+  ProfileSite* site = ProfileSite::first();
+  if (!site) return;
+  const double perUs = profileTicksPerUs();
+
+  req.beginMetric("otel.profile.duration", "us", MetricsRequest::Shape::Histogram, 1);  // delta
+  for (; site; site = site->next()) {
+    const ProfileSample s = site->snapshot(now);
+    if (s.calls == 0) continue;
+    JsonObject dp = req.addPoint();
+    dp["startTimeUnixNano"] = u64ToStr(s.startNs ? s.startNs : now);
+    dp["timeUnixNano"]      = u64ToStr(now);
+    dp["count"]             = u64ToStr(s.calls);
+    dp["sum"]               = (double)s.ticks / perUs;
+    dp["bucketCounts"].to<JsonArray>().add(u64ToStr(s.calls));
+    dp["explicitBounds"].to<JsonArray>();
+    if (s.hasRange) {
+      dp["min"] = s.minTicks / perUs;
+      dp["max"] = s.maxTicks / perUs;
+    }
+    JsonArray attrs = dp["attributes"].to<JsonArray>();
+    addPointAttributes(attrs, { { "code.function", site->name() } });
+    req.endPoint(dp);
+  }
+}
+
+// IsrCounter / IsrHistogram: one delta sum or explicit-bucket histogram per
+// instrument, with the slots of every core merged
+static void exportIsrInstruments(MetricsRequest& req, uint64_t now) {
+  for (IsrInstrument* inst = IsrInstrument::first(); inst; inst = inst->next()) {
+    const uint64_t start = inst->swapCollectedNs(now);
+
+    if (inst->kind() == IsrInstrument::Kind::Counter) {
+      const uint32_t delta = static_cast<IsrCounter*>(inst)->takeDelta();
+      if (delta == 0) continue;
+      req.beginMetric(inst->name(), inst->unit(), MetricsRequest::Shape::Sum, 1, true);
+      JsonObject dp = req.addPoint();
+      dp["startTimeUnixNano"] = u64ToStr(start ? start : now);
+      dp["timeUnixNano"]      = u64ToStr(now);
+      dp["asInt"]             = u64ToStr(delta);
+      JsonArray attrs = dp["attributes"].to<JsonArray>();
+      addPointAttributes(attrs, {});
+      req.endPoint(dp);
+      continue;
+    }
+
+    IsrHistogram* hist = static_cast<IsrHistogram*>(inst);
+    const IsrHistogram::Delta d = hist->takeDelta();
+    if (d.count == 0) continue;
+    req.beginMetric(inst->name(), inst->unit(), MetricsRequest::Shape::Histogram, 1);
+    JsonObject dp = req.addPoint();
+    dp["startTimeUnixNano"] = u64ToStr(start ? start : now);
+    dp["timeUnixNano"]      = u64ToStr(now);
+    dp["count"]             = u64ToStr(d.count);
+    dp["sum"]               = (double)d.sum;
+    JsonArray counts = dp["bucketCounts"].to<JsonArray>();
+    JsonArray bounds = dp["explicitBounds"].to<JsonArray>();
+    for (size_t i = 0; i <= hist->nBounds(); ++i) counts.add(u64ToStr(d.buckets[i]));
+    for (size_t i = 0; i < hist->nBounds(); ++i) bounds.add(hist->bounds()[i]);
+    JsonArray attrs = dp["attributes"].to<JsonArray>();
+    addPointAttributes(attrs, {});
+    req.endPoint(dp);
+  }
+}
+
+// Periodic collection for instruments that register themselves (profile
+// sites, ISR instruments) rather than through the Metrics API
+static void enableSelfRegisteredExport() {
+  static std::atomic<bool> s_enabled{false};
+  if (s_enabled.exchange(true, std::memory_order_acq_rel)) return;
+  OTelSender::addHooks("metrics", scheduleCollection, collectNow);
+  OTelSender::beginAsyncWorker();
+}
+
+void enableProfileExport()    { enableSelfRegisteredExport(); }
+void enableIsrMetricsExport() { enableSelfRegisteredExport(); }
+
+static void enableAggregation() {
+  if (s_aggregating.exchange(true, std::memory_order_acq_rel)) return;
+  OTelSender::addHooks("metrics", scheduleCollection, collectNow);
+  OTelSender::beginAsyncWorker();
+}
+
+// ----------------- SPAN METRICS ----------
+namespace {
+
+const char* statusCodeName(SpanStatus status) {
+  switch (status) {
+    case SpanStatus::Ok:    return "STATUS_CODE_OK";
+    case SpanStatus::Error: return "STATUS_CODE_ERROR";
+    default:                return "STATUS_CODE_UNSET";
+  }
+}
+
+// Span processor: rate, errors and duration per (span name, status)
+void recordSpanMetrics(const SpanEnd& span) {
+  static const String calls("traces.span.metrics.calls");
+  static const String duration("traces.span.metrics.duration");
+
+  const std::map<String, String> labels = {
+    { "span.name",   span.name },
+    { "status.code", statusCodeName(span.status) },
+  };
+  const double ms = (double)(span.endNs - span.startNs) / 1e6;
+
+  Series count(calls, labels, Source::Counter);
+  if (!count.dropped()) count.accumulate(1, "1", true, false);
+  Series hist(duration, labels, Source::Histogram);
+  if (!hist.dropped()) hist.accumulate(ms, "ms", false, false);
+}
+
+} // namespace
+
+bool Metrics::enableSpanMetrics() {
+  if (!Tracer::addSpanProcessor(recordSpanMetrics)) return false;
+  enableAggregation();
+  return true;
+}
+
+bool Metrics::addView(const MetricView& view) {
+  size_t n = s_viewCount.load(std::memory_order_relaxed);
+  if (n >= OTEL_MAX_VIEWS || view.instrument.length() == 0) return false;
+  s_views[n] = view;
+  s_viewCount.store(n + 1, std::memory_order_release);
+
+  if (view.aggregation == MetricAggregation::LastValue ||
+      view.aggregation == MetricAggregation::Sum ||
+      view.aggregation == MetricAggregation::ExponentialHistogram) {
+    enableAggregation();
+  }
+  return true;
+}
+
+void Metrics::recordHistogram(const String& name, double value,
+                              const ExponentialHistogram* merged,
+                              const String& unit,
+                              const std::map<String,String>& labels) {
+  Series series(name, labels, Source::Histogram);  // always aggregated
+  if (series.dropped()) return;
+  enableAggregation();
+  if (merged) series.accumulate(*merged, unit);
+  else        series.accumulate(value, unit, false, false);
+}
+
+uint32_t Metrics::overflowCount() {
+  return s_overflow.load(std::memory_order_relaxed);
+}
+
+void Metrics::setExportInterval(uint32_t intervalMs) {
+  s_exportIntervalMs.store(intervalMs, std::memory_order_relaxed);
+}
+
+bool Metrics::collectIfDue() {
+  const uint32_t now = millis();
+  if (now - s_lastCollectMs < s_exportIntervalMs.load(std::memory_order_relaxed)) return false;
+  s_lastCollectMs = now;
+  collect();
+  return true;
+}
+
+size_t Metrics::collect() {
+  const size_t n = s_observableCount.load(std::memory_order_acquire);
+  if (n == 0 && !s_aggregating.load(std::memory_order_acquire) && !ProfileSite::first() &&
+      !IsrInstrument::first()) return 0;
+
+  JsonLease lease(OTelSignal::Metrics);
+  MetricsRequest req(lease);
+  const uint64_t now = nowUnixNano();
+
+  for (size_t i = 0; i < n; ++i) {
+    ObservableInstrument& inst = s_observables[i];
+    const MetricView* view = findView(inst.name);
+    if (view && view->aggregation == MetricAggregation::Drop) continue;
+
+    req.beginMetric((view && view->name.length()) ? view->name : inst.name, inst.unit,
+                    inst.kind == ObservableKind::Gauge ? MetricsRequest::Shape::Gauge
+                                                       : MetricsRequest::Shape::Sum,
+                    2, inst.kind == ObservableKind::Counter);  // cumulative
+    ObservableResult result(req, now,
+                            inst.kind == ObservableKind::Gauge ? 0 : inst.startNs,
+                            &inst.name);
+    inst.callback(result);
+  }
+  exportStreams(req, now);
+  exportProfileSites(req, now);
+  exportIsrInstruments(req, now);
+  return req.finish();
+}
+
+#else // !OTEL_ENABLE_METRICS: keep the symbols, drop the serialisation/send code
+
+void ObservableResult::observe(double, const std::map<String,String>&) {}
+void ObservableResult::observe(double, std::initializer_list<std::pair<const char*, const char*>>) {}
+bool Metrics::registerObservable(ObservableKind, const String&, const String&, ObservableCallback) { return false; }
+bool Metrics::addView(const MetricView&) { return false; }
+bool Metrics::enableSpanMetrics() { return false; }
+void Metrics::recordHistogram(const String&, double, const ExponentialHistogram*,
+                              const String&, const std::map<String,String>&) {}
+uint32_t Metrics::overflowCount() { return 0; }
+void Metrics::setExportInterval(uint32_t) {}
+bool Metrics::collectIfDue() { return false; }
+size_t Metrics::collect() { return 0; }
+void enableProfileExport() {}
+void enableIsrMetricsExport() {}
+
+void Metrics::buildAndSendGauge(const String&, double, const String&,
+                                const std::map<String,String>&) {}
+
+void Metrics::buildAndSendSum(const String&, double, bool, const String&,
+                              const String&, const std::map<String,String>&) {}
+
+#endif // OTEL_ENABLE_METRICS
+
 } // namespace OTel
 
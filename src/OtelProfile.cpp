@@ -0,0 +1,76 @@
+#include "OtelProfile.h"
+
+namespace OTel {
+
+namespace {
+std::atomic<ProfileSite*> s_sites{nullptr};
+} // namespace
+
+double profileTicksPerUs() {
+#if defined(ESP32)
+  return (double)getCpuFrequencyMhz();
+#elif defined(ESP8266)
+  return (double)ESP.getCpuFreqMHz();
+#else
+  return 1.0;   // time_us_32() / micros()
+#endif
+}
+
+ProfileSite* ProfileSite::first() { return s_sites.load(std::memory_order_acquire); }
+
+void ProfileSite::link() {
+  // Whoever wins pushes the site (lock-free, so ISRs may race for it); the
+  // others record into it before it is listed, which loses nothing
+  uint8_t expected = kUnlinked;
+  if (!state_.compare_exchange_strong(expected, kLinking, std::memory_order_acq_rel)) return;
+  ProfileSite* head = s_sites.load(std::memory_order_relaxed);
+  do {
+    next_ = head;
+  } while (!s_sites.compare_exchange_weak(head, this, std::memory_order_release,
+                                          std::memory_order_relaxed));
+  state_.store(kLinked, std::memory_order_release);
+  if (!detail::inInterrupt()) enableProfileExport();
+}
+
+ProfileSample ProfileSite::snapshot(uint64_t nowNs) {
+  ProfileSample out;
+  uint32_t count = 0;
+  uint64_t total = 0;
+  const uint32_t epoch = epoch_.load(std::memory_order_relaxed);
+
+  for (Slot& s : slots_) {
+    uint32_t c = 0, mn = 0, mx = 0, ep = 0;
+    uint64_t t = 0;
+    // Seqlock read; a slot updated on every try is simply read as is
+    for (int tries = 0; tries < 8; ++tries) {
+      const uint32_t before = s.seq.load(std::memory_order_acquire);
+      c  = s.count;
+      t  = s.total;
+      mn = s.min;
+      mx = s.max;
+      ep = s.epoch;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (!(before & 1) && s.seq.load(std::memory_order_relaxed) == before) break;
+    }
+    count += c;
+    total += t;
+    if (ep == epoch && c) {
+      if (!out.hasRange || mn < out.minTicks) out.minTicks = mn;
+      if (!out.hasRange || mx > out.maxTicks) out.maxTicks = mx;
+      out.hasRange = true;
+    }
+  }
+  // Scopes that finish between the reads above and this store fall into the
+  // next interval's min/max; their calls and time are still counted
+  epoch_.store(epoch + 1, std::memory_order_relaxed);
+
+  out.calls   = count - lastCount_;
+  out.ticks   = total - lastTotal_;
+  out.startNs = lastNs_;
+  lastCount_  = count;
+  lastTotal_  = total;
+  lastNs_     = nowNs;
+  return out;
+}
+
+} // namespace OTel
@@ -0,0 +1,189 @@
+#include "OtelScheduler.h"
+
+#if defined(ARDUINO)
+  #include <Arduino.h>
+#else
+  #include <chrono>
+#endif
+
+static_assert(OTEL_SCHED_MAX_TIMERS <= 127, "timer ids are stored as int8_t");
+static_assert(OTEL_SCHED_TICK_MS > 0 && OTEL_SCHED_WHEEL_SLOTS > 0, "empty timer wheel");
+
+namespace OTel {
+
+static uint32_t defaultClock() {
+#if defined(ARDUINO)
+  return millis();
+#else
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// ===== statics =====
+Scheduler::Timer Scheduler::timers_[OTEL_SCHED_MAX_TIMERS];
+int8_t   Scheduler::slots_[OTEL_SCHED_WHEEL_SLOTS] = {};
+uint32_t Scheduler::cursorTick_ = 0;
+bool     Scheduler::started_    = false;
+uint32_t Scheduler::alignMs_    = OTEL_EXPORT_ALIGN_MS;
+SchedulerClock Scheduler::clock_ = defaultClock;
+
+// Set while a fired timer waits for its callback in tick(); cancel() clears it
+// so one callback can stop a sibling that fell due in the same tick.
+static bool s_firing[OTEL_SCHED_MAX_TIMERS];
+
+static inline size_t slotOf(uint32_t deadline) {
+  return (deadline / OTEL_SCHED_TICK_MS) % OTEL_SCHED_WHEEL_SLOTS;
+}
+
+static inline bool isValid(int id) {
+  return id >= 0 && id < OTEL_SCHED_MAX_TIMERS;
+}
+
+uint32_t Scheduler::now() { return clock_(); }
+
+void Scheduler::setClock(SchedulerClock clock) {
+  clock_ = clock ? clock : defaultClock;
+  if (started_) cursorTick_ = now() / OTEL_SCHED_TICK_MS; // re-anchor the wheel
+}
+
+void Scheduler::setAlignment(uint32_t windowMs) { alignMs_ = windowMs; }
+uint32_t Scheduler::alignment() { return alignMs_; }
+
+uint32_t Scheduler::alignUp_(uint32_t t) {
+  if (alignMs_ == 0) return t;
+  const uint32_t r = t % alignMs_;
+  return r ? t + (alignMs_ - r) : t;
+}
+
+void Scheduler::insert_(int id, uint32_t deadline) {
+  Timer& t = timers_[id];
+  const size_t slot = slotOf(deadline);
+  t.deadline = deadline;
+  t.next     = slots_[slot];
+  t.armed    = true;
+  slots_[slot] = (int8_t)id;
+}
+
+void Scheduler::unlink_(int id) {
+  Timer& t = timers_[id];
+  if (!t.armed) return;
+  int8_t* link = &slots_[slotOf(t.deadline)];
+  while (*link >= 0) {
+    if (*link == id) { *link = t.next; break; }
+    link = &timers_[*link].next;
+  }
+  t.next  = -1;
+  t.armed = false;
+}
+
+int Scheduler::create(SchedulerTask fn, void* ctx) {
+  if (!fn) return kInvalidTimer;
+  if (!started_) reset();
+  for (int i = 0; i < OTEL_SCHED_MAX_TIMERS; ++i) {
+    if (timers_[i].inUse) continue;
+    timers_[i] = Timer();
+    timers_[i].fn    = fn;
+    timers_[i].ctx   = ctx;
+    timers_[i].inUse = true;
+    return i;
+  }
+  return kInvalidTimer;
+}
+
+void Scheduler::armAfter(int id, uint32_t delayMs) {
+  if (!isValid(id) || !timers_[id].inUse) return;
+  unlink_(id);
+  timers_[id].period = 0;
+  insert_(id, alignUp_(now() + delayMs));
+}
+
+void Scheduler::armEvery(int id, uint32_t periodMs) {
+  if (!isValid(id) || !timers_[id].inUse || periodMs == 0) return;
+  unlink_(id);
+  timers_[id].period = periodMs;
+  insert_(id, alignUp_(now() + periodMs));
+}
+
+void Scheduler::cancel(int id) {
+  if (!isValid(id)) return;
+  unlink_(id);
+  timers_[id].period = 0;
+  s_firing[id] = false;
+}
+
+bool Scheduler::armed(int id) {
+  return isValid(id) && timers_[id].armed;
+}
+
+size_t Scheduler::tick() {
+  const uint32_t nowMs   = now();
+  const uint32_t nowTick = nowMs / OTEL_SCHED_TICK_MS;
+  if (!started_) reset();
+
+  // Visit every slot between the last tick and now (inclusive), or the whole
+  // wheel once if we fell further behind than one turn (or the clock wrapped).
+  uint32_t steps = nowTick - cursorTick_ + 1;
+  if (steps > OTEL_SCHED_WHEEL_SLOTS) steps = OTEL_SCHED_WHEEL_SLOTS;
+
+  int8_t due[OTEL_SCHED_MAX_TIMERS];
+  size_t nDue = 0;
+  for (uint32_t i = 0; i < steps; ++i) {
+    int8_t* link = &slots_[(cursorTick_ + i) % OTEL_SCHED_WHEEL_SLOTS];
+    while (*link >= 0) {
+      const int8_t id = *link;
+      Timer& t = timers_[id];
+      if ((int32_t)(t.deadline - nowMs) <= 0) {
+        *link   = t.next;   // unlink in place
+        t.next  = -1;
+        t.armed = false;
+        s_firing[id] = true;
+        due[nDue++]  = id;
+      } else {
+        link = &t.next;     // a later turn of the wheel
+      }
+    }
+  }
+  cursorTick_ = nowTick;
+
+  size_t fired = 0;
+  for (size_t i = 0; i < nDue; ++i) {
+    const int id = due[i];
+    if (!s_firing[id]) continue; // cancelled by an earlier callback
+    s_firing[id] = false;
+    Timer& t = timers_[id];
+    if (t.period) {
+      // Keep the period phase; skip missed periods instead of firing a burst
+      uint32_t next = t.deadline + t.period;
+      if ((int32_t)(next - nowMs) <= 0) next = nowMs + t.period;
+      insert_(id, alignUp_(next));
+    }
+    t.fn(t.ctx);
+    ++fired;
+  }
+  return fired;
+}
+
+uint32_t Scheduler::msUntilNext(uint32_t cap) {
+  const uint32_t nowMs = now();
+  uint32_t best = cap;
+  for (int i = 0; i < OTEL_SCHED_MAX_TIMERS; ++i) {
+    if (!timers_[i].armed) continue;
+    const int32_t d = (int32_t)(timers_[i].deadline - nowMs);
+    if (d <= 0) return 0;
+    if ((uint32_t)d < best) best = (uint32_t)d;
+  }
+  return best;
+}
+
+void Scheduler::reset() {
+  for (int i = 0; i < OTEL_SCHED_MAX_TIMERS; ++i) {
+    timers_[i]  = Timer();
+    s_firing[i] = false;
+  }
+  for (size_t s = 0; s < OTEL_SCHED_WHEEL_SLOTS; ++s) slots_[s] = -1;
+  cursorTick_ = now() / OTEL_SCHED_TICK_MS;
+  started_    = true;
+}
+
+} // namespace OTel
@@ -1,136 +1,687 @@
 #include "OtelSender.h"
+#include "OtelScheduler.h"
+#include "OtelExporter.h"
 
-// --- HTTP + WiFi includes (portable) ---
-#if defined(ESP8266)
-  #include <ESP8266WiFi.h>
-  #include <ESP8266HTTPClient.h>
+#ifdef ARDUINO_ARCH_RP2040
+  #include "pico/multicore.h"
+  #include "hardware/sync.h"
+  #include "pico/sem.h"
 #elif defined(ESP32)
-  #include <WiFi.h>
-  #include <HTTPClient.h>
-#elif defined(ARDUINO_ARCH_RP2040)
-  #include <WiFi.h>        // Earle Philhower core
-  #include <HTTPClient.h>  // Arduino HTTPClient
-#else
-  #error "Unsupported platform: need WiFi + HTTPClient"
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
+  static TaskHandle_t s_workerTask = nullptr;
 #endif
 
-
-
-#ifdef ARDUINO_ARCH_RP2040
-  #include "pico/multicore.h"
+// Short critical section around queue index updates. Eviction moves the tail
+// from the producer side, so both ends take it; only String moves (no heap
+// work) happen inside.
+#if defined(ARDUINO_ARCH_RP2040)
+static spin_lock_t* queueLock() {
+  static spin_lock_t* lock = spin_lock_init(spin_lock_claim_unused(true));
+  return lock;
+}
+struct QueueGuard {
+  uint32_t irq;
+  QueueGuard() : irq(spin_lock_blocking(queueLock())) {}
+  ~QueueGuard() { spin_unlock(queueLock(), irq); }
+};
+#elif defined(ESP32)
+static portMUX_TYPE s_queueMux = portMUX_INITIALIZER_UNLOCKED;
+struct QueueGuard {
+  QueueGuard()  { portENTER_CRITICAL(&s_queueMux); }
+  ~QueueGuard() { portEXIT_CRITICAL(&s_queueMux); }
+};
+#else
+struct QueueGuard { QueueGuard() {} };  // single thread (service() from loop())
 #endif
 
 // ===== statics =====
-OTelQueuedItem OTelSender::q_[QCAP];
-std::atomic<size_t> OTelSender::head_{0};
-std::atomic<size_t> OTelSender::tail_{0};
+static_assert(OTEL_QUEUE_CAPACITY_TRACES >= 2 && OTEL_QUEUE_CAPACITY_LOGS >= 2 &&
+              OTEL_QUEUE_CAPACITY_METRICS >= 2, "each queue lane needs at least 2 slots");
+OTelQueuedItem OTelSender::qTraces_[OTEL_QUEUE_CAPACITY_TRACES];
+OTelQueuedItem OTelSender::qLogs_[OTEL_QUEUE_CAPACITY_LOGS];
+OTelQueuedItem OTelSender::qMetrics_[OTEL_QUEUE_CAPACITY_METRICS];
+// Indexed by OTelSignal
+OTelSender::Lane OTelSender::lanes_[3] = {
+  { qTraces_,  OTEL_QUEUE_CAPACITY_TRACES,  {0}, {0}, OTEL_LANE_WEIGHT_TRACES,  0, {0}, {0}, {0}, {0} },
+  { qLogs_,    OTEL_QUEUE_CAPACITY_LOGS,    {0}, {0}, OTEL_LANE_WEIGHT_LOGS,    0, {0}, {0}, {0}, {0} },
+  { qMetrics_, OTEL_QUEUE_CAPACITY_METRICS, {0}, {0}, OTEL_LANE_WEIGHT_METRICS, 0, {0}, {0}, {0}, {0} },
+};
+size_t OTelSender::rr_ = 0;
 std::atomic<uint32_t> OTelSender::drops_{0};
+std::atomic<uint32_t> OTelSender::drops_by_[3][4] = {};
+OTelQueuePolicy OTelSender::policy_ = (OTelQueuePolicy)OTEL_QUEUE_POLICY;
+uint32_t        OTelSender::block_timeout_ms_ = OTEL_QUEUE_BLOCK_TIMEOUT_MS;
 std::atomic<bool>    OTelSender::worker_started_{false};
-// Begin HTTP on all platforms (ESP8266 requires WiFiClient)
-static bool httpBeginCompat(HTTPClient& http, const String& url) {
-#if defined(ESP8266)
-  WiFiClient client;                // or WiFiClientSecure if you later do HTTPS
-  return http.begin(client, url);   // new API on ESP8266
-#else
-  return http.begin(url);           // ESP32 / RP2040
-#endif
+void (*OTelSender::hooks_[OTEL_WORKER_MAX_HOOKS])() = {};
+std::atomic<size_t>  OTelSender::hook_count_{0};
+void (*OTelSender::flush_hooks_[OTEL_WORKER_MAX_HOOKS])() = {};
+std::atomic<size_t>  OTelSender::flush_hook_count_{0};
+std::atomic<uint32_t> OTelSender::flush_requested_{0};
+std::atomic<uint32_t> OTelSender::flush_served_{0};
+std::atomic<uint32_t> OTelSender::flush_deadline_{0};
+std::atomic<bool>    OTelSender::shut_down_{false};
+std::atomic<uint32_t> OTelSender::delivered_records_{0};
+std::atomic<uint32_t> OTelSender::failed_records_{0};
+std::atomic<uint32_t> OTelSender::batched_records_{0};
+OTelSender::Batch    OTelSender::batches_[3] = {
+  { "/v1/traces",  "resourceSpans",   String(), String(), String(), 0, 0, 0, -1, -1 },
+  { "/v1/logs",    "resourceLogs",    String(), String(), String(), 0, 0, 0, -1, -1 },
+  { "/v1/metrics", "resourceMetrics", String(), String(), String(), 0, 0, 0, -1, -1 },
+};
+std::atomic<OTel::Exporter*> OTelSender::exporters_[3] = {};
+std::atomic<uint32_t> OTelSender::export_failures_{0};
+std::atomic<uint32_t> OTelSender::oversize_{0};
+bool OTelSender::servicing_   = false;
+bool OTelSender::serviced_    = false;
+bool OTelSender::window_open_ = false;
+void (*OTelSender::window_open_hook_)()  = nullptr;
+void (*OTelSender::window_close_hook_)() = nullptr;
+// ---------- Queue ----------
+static int signalOf(const char* path) {
+  if (!path) return -1;
+  if (strcmp(path, "/v1/traces")  == 0) return (int)OTelSignal::Traces;
+  if (strcmp(path, "/v1/logs")    == 0) return (int)OTelSignal::Logs;
+  if (strcmp(path, "/v1/metrics") == 0) return (int)OTelSignal::Metrics;
+  return -1;
 }
 
+namespace {
+// A flushed batch, {"key":[ body ]}, written without building the request
+class BatchPayload : public OTel::PayloadSource {
+public:
+  BatchPayload(const char* key, const String& body) : key_(key), body_(body) {}
+  size_t size() const override { return body_.length() + strlen(key_) + 7; }
+  void writeTo(Print& out) const override {
+    out.print("{\"");
+    out.print(key_);
+    out.print("\":[");
+    out.write(reinterpret_cast<const uint8_t*>(body_.c_str()), body_.length());
+    out.print("]}");
+  }
+private:
+  const char*   key_;
+  const String& body_;
+};
+
+// A record serialized straight from its JsonDocument
+class DocumentPayload : public OTel::PayloadSource {
+public:
+  DocumentPayload(JsonDocument& doc, size_t size) : doc_(doc), size_(size) {}
+  size_t size() const override { return size_; }
+  void writeTo(Print& out) const override { serializeJson(doc_, out); }
+private:
+  JsonDocument& doc_;
+  size_t        size_;
+};
+} // namespace
 
-// Build "http://host:4318" + "/v1/…"
-String OTelSender::fullUrl_(const char* path) {
-  // Avoid double slashes if a user accidentally sets a trailing slash
-  String base = String(OTEL_COLLECTOR_BASE_URL);
-  if (base.endsWith("/")) base.remove(base.length() - 1);
-  if (path && *path == '/') return base + String(path);
-  return base + "/" + String(path ? path : "");
+void OTelSender::countDrop_(const char* path, OTelPriority priority) {
+  drops_.fetch_add(1, std::memory_order_relaxed);
+  const int sig = signalOf(path);
+  if (sig >= 0) drops_by_[sig][(size_t)priority & 3].fetch_add(1, std::memory_order_relaxed);
 }
 
-// ---------- Queue (SPSC) ----------
-// Single-producer (core0) enqueue; drop oldest on overflow
-bool OTelSender::enqueue_(const char* path, String&& payload) {
-  size_t h = head_.load(std::memory_order_relaxed);
-  size_t t = tail_.load(std::memory_order_acquire);
-  size_t next = (h + 1) % QCAP;
+// Producer side; on overflow applies the configured OTelQueuePolicy within
+// the signal's own lane (unknown paths share the metrics lane)
+bool OTelSender::enqueue_(const char* path, String&& payload, OTelPriority priority) {
+  const int sig = signalOf(path);
+  Lane& lane = lanes_[sig >= 0 ? sig : (int)OTelSignal::Metrics];
 
-  if (next == t) {
-    // Full: drop oldest (advance tail)
-    size_t new_t = (t + 1) % QCAP;
-    tail_.store(new_t, std::memory_order_release);
-    drops_.fetch_add(1, std::memory_order_relaxed);
+  OTelQueuedItem item;
+  item.path       = path;
+  item.payload    = std::move(payload);
+  item.priority   = priority;
+  item.enqueuedMs = millis();
+
+  OTelQueuePolicy policy = policy_;
+  if (policy == OTelQueuePolicy::Block) {
+    // Nobody drains the queue while we wait unless a worker is running
+    if (worker_started_.load(std::memory_order_relaxed)) {
+      const uint32_t start = millis();
+      for (;;) {
+        const size_t h = lane.head.load(std::memory_order_relaxed);
+        if ((h + 1) % lane.cap != lane.tail.load(std::memory_order_acquire)) break;
+        if (millis() - start >= block_timeout_ms_) break;
+        delay(1);
+      }
+    }
+    policy = OTelQueuePolicy::DropNewest;  // still full after the wait
   }
 
-  q_[h].path = path;
-  q_[h].payload = std::move(payload);
-  head_.store(next, std::memory_order_release);
+  OTelQueuedItem evicted;  // destroyed (and freed) after the lock is released
+  bool stored = false;
+  {
+    QueueGuard guard;
+    OTelQueuedItem* q = lane.q;
+    const size_t cap  = lane.cap;
+    const size_t h    = lane.head.load(std::memory_order_relaxed);
+    const size_t t    = lane.tail.load(std::memory_order_relaxed);
+    const size_t next = (h + 1) % cap;
+
+    if (next != t) {
+      q[h] = std::move(item);
+      lane.head.store(next, std::memory_order_release);
+      stored = true;
+    } else if (policy == OTelQueuePolicy::DropOldest) {
+      evicted = std::move(q[t]);
+      lane.tail.store((t + 1) % cap, std::memory_order_release);
+      q[h] = std::move(item);
+      lane.head.store(next, std::memory_order_release);
+      stored = true;
+    } else if (policy == OTelQueuePolicy::Priority) {
+      // Oldest of the lowest-priority items. The items behind it move up
+      // over its slot, so the lane stays in arrival order and the new item
+      // joins at the head (moves only swap buffers; nothing is freed here).
+      size_t victim = t;
+      for (size_t i = t; i != h; i = (i + 1) % cap) {
+        if (q[i].priority < q[victim].priority) victim = i;
+      }
+      if (q[victim].priority <= item.priority) {
+        evicted = std::move(q[victim]);
+        size_t i = victim;
+        for (size_t n = (i + 1) % cap; n != h; i = n, n = (n + 1) % cap) q[i] = std::move(q[n]);
+        q[i]   = std::move(item);
+        stored = true;
+      }
+    }
+  }
+
+  if (!stored) {
+    countDrop_(item.path, item.priority);
+    return false;
+  }
+  if (evicted.path) countDrop_(evicted.path, evicted.priority);
+  wake();
   return true;
 }
 
-bool OTelSender::dequeue_(OTelQueuedItem& out) {
-  size_t t = tail_.load(std::memory_order_relaxed);
-  size_t h = head_.load(std::memory_order_acquire);
+// Consumer side (worker): pops the lane head only if it fits in maxBytes.
+// `size` is the head's payload size (0 when the lane is empty). `out` must be
+// empty: assigning over a payload it still holds would free it under the guard.
+bool OTelSender::dequeue_(Lane& lane, size_t maxBytes, OTelQueuedItem& out, size_t& size) {
+  QueueGuard guard;
+  const size_t t = lane.tail.load(std::memory_order_relaxed);
+  const size_t h = lane.head.load(std::memory_order_acquire);
+  size = 0;
   if (t == h) return false; // empty
 
-  out = std::move(q_[t]);
-  q_[t].payload = String();  // release memory
-  size_t next = (t + 1) % QCAP;
-  tail_.store(next, std::memory_order_release);
+  size = lane.q[t].payload.length();
+  if (size > maxBytes) return false;
+  out = std::move(lane.q[t]);   // leaves the slot empty; nothing to free here
+  lane.tail.store((t + 1) % lane.cap, std::memory_order_release);
   return true;
 }
 
-// ---------- Worker ----------
-void OTelSender::pumpOnce_() {
+// Weighted deficit round robin: every visit adds weight * quantum bytes to a
+// lane's allowance, and it dequeues while its head item fits. A saturated lane
+// therefore gets its share of the burst and no more; an idle lane forfeits its
+// allowance so it cannot save up for a later burst.
+size_t OTelSender::drainLanes_(size_t budget) {
+  size_t served = 0;
+  while (served < budget) {
+    size_t roundServed = 0;
+    bool   pending     = false;
+    for (size_t visit = 0; visit < 3 && served < budget; ++visit) {
+      Lane& lane = lanes_[rr_];
+      rr_ = (rr_ + 1) % 3;
+
+      size_t size = 0;
+      lane.deficit += (size_t)lane.weight * OTEL_LANE_QUANTUM_BYTES;
+      while (served < budget) {
+        OTelQueuedItem it;  // one per item, so its payload is freed here, unlocked
+        if (!dequeue_(lane, lane.deficit, it, size)) break;
+        lane.deficit -= size;
+        ++served;
+        ++roundServed;
+
+        const uint32_t lat = millis() - it.enqueuedMs;
+        const uint32_t n   = lane.sent.fetch_add(1, std::memory_order_relaxed);
+        const uint32_t avg = lane.latAvg.load(std::memory_order_relaxed);
+        lane.latLast.store(lat, std::memory_order_relaxed);
+        lane.latAvg.store(n == 0 ? lat : avg - avg / 8 + lat / 8, std::memory_order_relaxed);
+        if (lat > lane.latMax.load(std::memory_order_relaxed))
+          lane.latMax.store(lat, std::memory_order_relaxed);
 #if OTEL_SEND_ENABLE
-  OTelQueuedItem it;
-  if (!dequeue_(it)) return;
+        // Batch on the worker; the POST (and its blocking) happens off the control path.
+        acceptBatch_(it.path, it.payload);
+#endif
+      }
+      if (size == 0) lane.deficit = 0;  // emptied (or was idle)
+      else pending = true;              // head is larger than the allowance so far
+    }
+    if (roundServed == 0 && !pending) break;
+  }
+  return served;
+}
+
+void OTelSender::setQueuePolicy(OTelQueuePolicy policy, uint32_t blockTimeoutMs) {
+  policy_ = policy;
+  block_timeout_ms_ = blockTimeoutMs;
+}
+
+// ---------- Exporters ----------
+static OTel::HttpExporter& defaultExporter() {
+  static OTel::HttpExporter http;
+  return http;
+}
+
+void OTelSender::setExporter(OTelSignal signal, OTel::Exporter* exporter) {
+  exporters_[(size_t)signal % 3].store(exporter, std::memory_order_release);
+}
+
+void OTelSender::setExporter(OTel::Exporter* exporter) {
+  for (auto& e : exporters_) e.store(exporter, std::memory_order_release);
+}
+
+OTel::Exporter& OTelSender::exporter(OTelSignal signal) {
+  OTel::Exporter* e = exporters_[(size_t)signal % 3].load(std::memory_order_acquire);
+  return e ? *e : defaultExporter();
+}
+
+OTel::ExportResult OTelSender::deliver_(const char* path, const String& payload) {
+  const int sig = signalOf(path);
+  // Requests for other paths bypass the per-signal routing
+  if (sig < 0) return defaultExporter().exportRequest(OTelSignal::Metrics, path, payload);
+  return exporter((OTelSignal)sig).exportRequest((OTelSignal)sig, path, payload);
+}
+
+// ---------- Worker ----------
+void OTelSender::openWindow_() {
+  if (window_open_) return;
+  window_open_ = true;
+  if (window_open_hook_) window_open_hook_();
+}
+
+void OTelSender::closeWindow_() {
+  if (!window_open_) return;
+  window_open_ = false;
+  if (window_close_hook_) window_close_hook_();
+}
+
+void OTelSender::setExportWindowHooks(void (*open)(), void (*close)()) {
+  window_open_hook_  = open;
+  window_close_hook_ = close;
+}
+
+// ---------- Batches ----------
+void OTelSender::initBatches_() {
+  if (batches_[0].flushTimer >= 0) return;
+  for (Batch& b : batches_) {
+    b.flushTimer = OTel::Scheduler::create(flushTimer_, &b);
+    b.retryTimer = OTel::Scheduler::create(retryTimer_, &b);
+  }
+}
+
+void OTelSender::flushTimer_(void* batch) { flushBatch_(*static_cast<Batch*>(batch)); }
+
+void OTelSender::acceptBatch_(const char* path, String& payload) {
+  initBatches_();
+  Batch* b = nullptr;
+  for (Batch& c : batches_) {
+    if (path && strcmp(path, c.path) == 0) { b = &c; break; }
+  }
+
+  // Requests are built as {"resourceX":[...]} with a single top-level key;
+  // anything else is sent untouched.
+  const int open  = payload.indexOf('[');
+  const int close = payload.lastIndexOf(']');
+  const size_t keyLen = b ? strlen(b->key) : 0;
+  if (!b || OTEL_BATCH_DELAY_MS == 0 || open != (int)keyLen + 4 || close <= open ||
+      strncmp(payload.c_str() + 2, b->key, keyLen) != 0) {
+    if (b) {
+      export_(*b, payload);
+    } else {
+      openWindow_();
+      const OTel::ExportResult result = deliver_(path, payload);
+      if (result != OTel::ExportResult::Success) {
+        export_failures_.fetch_add(1, std::memory_order_relaxed);
+      }
+      tally_(result, 1);
+    }
+    return;
+  }
+
+  const size_t innerLen = (size_t)(close - open - 1);
+  if (innerLen == 0) return;
+  // Split at record boundaries: the request is {"key":[ body ]}
+  const size_t envelope = keyLen + 7;
+  if (b->body.length() && b->body.length() + 1 + innerLen + envelope > OTEL_MAX_REQUEST_BYTES) {
+    flushBatch_(*b);
+  }
+
+  if (b->body.length()) b->body += ',';
+  b->body.concat(payload.c_str() + open + 1, innerLen);
+  ++b->items;
+  batched_records_.fetch_add(1, std::memory_order_relaxed);
+
+  if (!OTel::Scheduler::armed(b->flushTimer)) {
+    OTel::Scheduler::armAfter(b->flushTimer, OTEL_BATCH_DELAY_MS);
+  }
+}
+
+void OTelSender::buildRequest_(String& out, const Batch& b) {
+  out = "";
+  out.reserve(b.body.length() + strlen(b.key) + 7);
+  out += "{\"";
+  out += b.key;
+  out += "\":[";
+  out += b.body;
+  out += "]}";
+}
+
+void OTelSender::flushBatch_(Batch& b) {
+  OTel::Scheduler::cancel(b.flushTimer);
+  if (!b.body.length()) return;
+  openWindow_();
+  const OTelSignal signal = (OTelSignal)signalOf(b.path);
+  OTel::Exporter& out = exporter(signal);
+  const uint16_t items = b.items;
+  if (out.streams()) {
+    // The envelope is written around the body on the way to the socket; the
+    // full request only exists if it has to wait for a retry
+    const OTel::ExportResult result = out.exportStream(signal, b.path, BatchPayload(b.key, b.body));
+    if (claimRetry_(b, result, items)) buildRequest_(b.retry, b);
+  } else {
+    // Both buffers keep their capacity, so steady-state flushes do not allocate
+    buildRequest_(b.request, b);
+    const OTel::ExportResult result = out.exportRequest(signal, b.path, b.request);
+    if (claimRetry_(b, result, items)) b.retry = b.request;  // copied only on failure
+  }
+  b.body  = "";
+  b.items = 0;
+  batched_records_.fetch_sub(items, std::memory_order_relaxed);
+}
+
+void OTelSender::export_(Batch& b, const String& payload) {
+  openWindow_();
+  if (claimRetry_(b, deliver_(b.path, payload), 1)) b.retry = payload;
+}
+
+bool OTelSender::claimRetry_(Batch& b, OTel::ExportResult result, uint16_t items) {
+  if (result == OTel::ExportResult::Success) {
+    tally_(result, items);
+    return false;
+  }
+  // One retry slot per signal: a second failure while it is taken is dropped
+  if (OTEL_RETRY_MAX == 0 || result != OTel::ExportResult::RetryableFailure || b.retry.length()) {
+    export_failures_.fetch_add(1, std::memory_order_relaxed);
+    tally_(result, items);
+    return false;
+  }
+  b.retryItems = items;
+  b.attempts   = 0;
+  batched_records_.fetch_add(items, std::memory_order_relaxed);
+  OTel::Scheduler::armAfter(b.retryTimer, OTEL_RETRY_BASE_MS);
+  return true;
+}
+
+void OTelSender::tally_(OTel::ExportResult result, uint32_t items) {
+  if (result == OTel::ExportResult::Success) delivered_records_.fetch_add(items, std::memory_order_relaxed);
+  else                                       failed_records_.fetch_add(items, std::memory_order_relaxed);
+}
+
+void OTelSender::retryTimer_(void* batch) {
+  Batch& b = *static_cast<Batch*>(batch);
+  if (!b.retry.length()) return;
+  openWindow_();
+  const OTel::ExportResult result = deliver_(b.path, b.retry);
+  if (result != OTel::ExportResult::Success) {
+    if (result == OTel::ExportResult::RetryableFailure && ++b.attempts < OTEL_RETRY_MAX) {
+      OTel::Scheduler::armAfter(b.retryTimer, (uint32_t)OTEL_RETRY_BASE_MS << b.attempts);
+      return;
+    }
+    export_failures_.fetch_add(1, std::memory_order_relaxed);
+  }
+  tally_(result, b.retryItems);
+  batched_records_.fetch_sub(b.retryItems, std::memory_order_relaxed);
+  b.retry = String();
+  b.retryItems = 0;
+  b.attempts = 0;
+}
+
+// ---------- Flush / shutdown ----------
+// Records queued, batched or waiting for a retry
+uint32_t OTelSender::pendingRecords_() {
+  uint32_t n = batched_records_.load(std::memory_order_relaxed);
+  for (const Lane& lane : lanes_) {
+    const size_t h = lane.head.load(std::memory_order_acquire);
+    const size_t t = lane.tail.load(std::memory_order_acquire);
+    n += (uint32_t)((h + lane.cap - t) % lane.cap);
+  }
+  return n;
+}
+
+// Runs on the worker (or inline without one). The deadline is checked between
+// requests; a request already on the wire finishes first.
+void OTelSender::flushNow_(uint32_t deadline, bool discard) {
+  initBatches_();
+  const size_t nFlush = flush_hook_count_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < nFlush; ++i) flush_hooks_[i]();
+  runHooks_();
+
+  const auto due = [deadline] { return (int32_t)(OTel::Scheduler::now() - deadline) >= 0; };
+  // Failed requests first: they hold the oldest data
+  for (Batch& b : batches_) {
+    if (due()) break;
+    if (!b.retry.length()) continue;
+    OTel::Scheduler::cancel(b.retryTimer);
+    retryTimer_(&b);
+  }
+  // Queued records join their batches (full batches go out on the way)...
+  while (!due() && drainLanes_(OTEL_WORKER_BURST)) {}
+  // ...and the open batches are closed
+  for (Batch& b : batches_) {
+    if (due()) break;
+    flushBatch_(b);
+  }
+  closeWindow_();
+
+  if (discard) {
+    for (Lane& lane : lanes_) {
+      for (;;) {
+        OTelQueuedItem it;  // freed at the end of each pass, outside the guard
+        size_t size;
+        if (!dequeue_(lane, (size_t)-1, it, size)) break;
+        failed_records_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    for (Batch& b : batches_) {
+      OTel::Scheduler::cancel(b.flushTimer);
+      OTel::Scheduler::cancel(b.retryTimer);
+      batched_records_.fetch_sub(b.items + b.retryItems, std::memory_order_relaxed);
+      failed_records_.fetch_add(b.items + b.retryItems, std::memory_order_relaxed);
+      b.body  = String();
+      b.retry = String();
+      b.items = b.retryItems = b.attempts = 0;
+    }
+  }
+}
+
+OTelFlushResult OTelSender::flush_(uint32_t timeoutMs, bool discard) {
+  const uint32_t deadline  = OTel::Scheduler::now() + timeoutMs;
+  const uint32_t delivered = delivered_records_.load(std::memory_order_relaxed);
+  const uint32_t failed    = failed_records_.load(std::memory_order_relaxed);
 
-  HTTPClient http;
-  if (httpBeginCompat(http, fullUrl_(it.path))) {
-    http.addHeader("Content-Type", "application/json");
-    // Fire the POST; the blocking happens on core 1, not in the control path.
-    (void)http.POST(it.payload);
-    http.end();
+  bool finished = true;
+  if (worker_started_.load(std::memory_order_relaxed) && !inWorker_()) {
+    // The worker owns the queue and batches: hand it the deadline and wait.
+    // The release on the ticket publishes the deadline (and for shutdown(),
+    // shut_down_) to the worker's acquire of flush_requested_.
+    flush_deadline_.store(deadline, std::memory_order_relaxed);
+    const uint32_t ticket = flush_requested_.fetch_add(1, std::memory_order_release) + 1;
+    wake();
+    const auto served = [ticket] {
+      return (int32_t)(flush_served_.load(std::memory_order_acquire) - ticket) >= 0;
+    };
+    while (!served() && (int32_t)(OTel::Scheduler::now() - deadline) < 0) delay(1);
+    finished = served();
+  } else {
+    const bool nested = servicing_;
+    servicing_ = true;     // records produced by flush hooks are batched here
+    flushNow_(deadline, discard);
+    servicing_ = nested;
   }
+
+  OTelFlushResult r;
+  r.delivered = delivered_records_.load(std::memory_order_relaxed) - delivered;
+  // Past the deadline the worker may still be sending; what it has not
+  // delivered yet counts as abandoned
+  r.abandoned = failed_records_.load(std::memory_order_relaxed) - failed + pendingRecords_();
+  r.complete  = finished && r.abandoned == 0;
+  return r;
+}
+
+OTelFlushResult OTelSender::flush(uint32_t timeoutMs) {
+  return flush_(timeoutMs, false);
+}
+
+OTelFlushResult OTelSender::shutdown(uint32_t timeoutMs) {
+  shut_down_.store(true, std::memory_order_release);
+  return flush_(timeoutMs, true);
+}
+
+void OTelSender::runHooks_() {
+  size_t n = hook_count_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < n; ++i) hooks_[i]();
+}
+
+void OTelSender::workerPass_() {
+  // One pass serves every ticket taken so far
+  const uint32_t requested = flush_requested_.load(std::memory_order_acquire);
+  if (requested != flush_served_.load(std::memory_order_relaxed)) {
+    flushNow_(flush_deadline_.load(std::memory_order_relaxed),
+              shut_down_.load(std::memory_order_relaxed));
+    flush_served_.store(requested, std::memory_order_release);
+  }
+  initBatches_();
+  runHooks_();
+  drainLanes_(OTEL_WORKER_BURST);
+  OTel::Scheduler::tick();
+  closeWindow_();
+}
+
+// Worker wakeup: producers release a binary semaphore (RP2040, shared by both
+// cores) or notify the task (ESP32); the worker blocks on it with a timeout.
+#if defined(ARDUINO_ARCH_RP2040)
+static semaphore_t* wakeSem() {
+  static semaphore_t sem;
+  static bool ready = (sem_init(&sem, 0, 1), true);
+  (void)ready;
+  return &sem;
+}
+#endif
+
+void OTelSender::wake() {
+#if defined(ARDUINO_ARCH_RP2040)
+  if (worker_started_.load(std::memory_order_relaxed)) sem_release(wakeSem());
+#elif defined(ESP32)
+  if (s_workerTask) xTaskNotifyGive(s_workerTask);
+#endif
+}
+
+bool OTelSender::lanesPending_() {
+  for (const Lane& lane : lanes_) {
+    if (lane.head.load(std::memory_order_acquire) != lane.tail.load(std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void OTelSender::waitForWork_(uint32_t ms) {
+#if defined(ARDUINO_ARCH_RP2040)
+  if (ms) (void)sem_acquire_timeout_ms(wakeSem(), ms);  // WFE while waiting
+#elif defined(ESP32)
+  // Block for at least a tick, or the idle task (and its watchdog) starves
+  TickType_t ticks = pdMS_TO_TICKS(ms);
+  (void)ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1);
 #else
-  // If globally disabled, just drain the queue without sending.
-  OTelQueuedItem sink;
-  (void)dequeue_(sink);
+  delay(ms);
 #endif
 }
 
 void OTelSender::workerLoop_() {
   for (;;) {
-    for (int i = 0; i < OTEL_WORKER_BURST; ++i) {
-      OTelQueuedItem it;
-      if (!dequeue_(it)) break;
-
-      HTTPClient http;
-      // Keep-alive where supported; harmless otherwise
-      #if defined(HTTPCLIENT_1_2_COMPATIBLE) || defined(ESP8266) || defined(ESP32)
-      http.setReuse(true);
-      #endif
-      if (httpBeginCompat(http,fullUrl_(it.path))) {
-        http.addHeader("Content-Type", "application/json");
-        (void)http.POST(it.payload);
-        http.end();
-      }
-    }
+    workerPass_();
+#if OTEL_WORKER_SLEEP_MS > 0
     delay(OTEL_WORKER_SLEEP_MS);
+#else
+    // More than one burst queued: carry on. Otherwise sleep until a send
+    // wakes us or the next batch flush / retry / collection falls due.
+    waitForWork_(lanesPending_() ? 0 : OTel::Scheduler::msUntilNext(OTEL_WORKER_IDLE_MS));
+#endif
   }
 }
 
+void OTelSender::service() {
+  // The background worker owns the queue and scheduler once it is running
+  if (worker_started_.load(std::memory_order_relaxed)) return;
+  serviced_  = true;
+  servicing_ = true;
+  workerPass_();
+  servicing_ = false;
+}
 
-#ifdef ARDUINO_ARCH_RP2040
+static bool addHook(void (*table[])(), std::atomic<size_t>& count, void (*fn)()) {
+  if (!fn) return false;
+  size_t n = count.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < n; ++i) {
+    if (table[i] == fn) return true; // already registered
+  }
+  if (n >= OTEL_WORKER_MAX_HOOKS) return false;
+  table[n] = fn;
+  count.store(n + 1, std::memory_order_release);
+  return true;
+}
+
+bool OTelSender::addWorkerHook(void (*fn)()) { return addHook(hooks_, hook_count_, fn); }
+bool OTelSender::addFlushHook(void (*fn)())  { return addHook(flush_hooks_, flush_hook_count_, fn); }
+
+static_assert(OTEL_WORKER_MAX_HOOKS >= OTEL_BUILTIN_WORKER_HOOKS,
+              "OTEL_WORKER_MAX_HOOKS must leave room for the built-in hooks");
+
+bool OTelSender::addHooks(const char* owner, void (*worker)(), void (*flushFn)()) {
+  const bool ok = (!worker || addWorkerHook(worker)) && (!flushFn || addFlushHook(flushFn));
+  if (!ok) Serial.printf("[otel] %s: no free hook slot, raise OTEL_WORKER_MAX_HOOKS\n", owner);
+  return ok;
+}
+
+
+#if defined(ARDUINO_ARCH_RP2040) || defined(ESP32)
 void otel_worker_entry() { OTelSender::workerLoop_(); }
 #endif
 
+#if defined(ESP32)
+static void otel_worker_task(void*) { otel_worker_entry(); }
+#endif
+
 
 void OTelSender::launchWorkerOnce_() {
-#ifdef ARDUINO_ARCH_RP2040
+#if defined(ARDUINO_ARCH_RP2040)
   bool expected = false;
   if (worker_started_.compare_exchange_strong(expected, true)) {
+    (void)queueLock();  // claim the spin lock before core 1 can race for it
+    (void)wakeSem();
     multicore_launch_core1(otel_worker_entry);
   }
+#elif defined(ESP32)
+  bool expected = false;
+  if (worker_started_.compare_exchange_strong(expected, true)) {
+    xTaskCreatePinnedToCore(otel_worker_task, "otel-worker", OTEL_WORKER_STACK, nullptr,
+                            OTEL_WORKER_PRIORITY, &s_workerTask, OTEL_WORKER_CORE);
+  }
+#endif
+}
+
+bool OTelSender::inWorker_() {
+  if (servicing_) return true;
+#if defined(ARDUINO_ARCH_RP2040)
+  return worker_started_.load(std::memory_order_relaxed) && get_core_num() == 1;
+#elif defined(ESP32)
+  return s_workerTask != nullptr && xTaskGetCurrentTaskHandle() == s_workerTask;
+#else
+  return false;
 #endif
 }
 
@@ -142,35 +693,121 @@ uint32_t OTelSender::droppedCount() {
   return drops_.load(std::memory_order_relaxed);
 }
 
+uint32_t OTelSender::droppedCount(OTelSignal signal, OTelPriority priority) {
+  return drops_by_[(size_t)signal % 3][(size_t)priority & 3].load(std::memory_order_relaxed);
+}
+
+OTelLaneStats OTelSender::laneStats(OTelSignal signal) {
+  const size_t sig = (size_t)signal % 3;
+  const Lane& lane = lanes_[sig];
+  const size_t h = lane.head.load(std::memory_order_acquire);
+  const size_t t = lane.tail.load(std::memory_order_acquire);
+
+  OTelLaneStats st;
+  st.depth         = (h + lane.cap - t) % lane.cap;
+  st.capacity      = lane.cap - 1;  // one slot always stays free
+  st.sent          = lane.sent.load(std::memory_order_relaxed);
+  st.dropped       = 0;
+  for (size_t p = 0; p < 4; ++p) st.dropped += drops_by_[sig][p].load(std::memory_order_relaxed);
+  st.lastLatencyMs = lane.latLast.load(std::memory_order_relaxed);
+  st.avgLatencyMs  = lane.latAvg.load(std::memory_order_relaxed);
+  st.maxLatencyMs  = lane.latMax.load(std::memory_order_relaxed);
+  return st;
+}
+
+void OTelSender::setLaneWeight(OTelSignal signal, uint8_t weight) {
+  lanes_[(size_t)signal % 3].weight = weight ? weight : 1;
+}
+
 bool OTelSender::queueIsHealthy() {
   return worker_started_.load(std::memory_order_relaxed);
 }
 
+uint32_t OTelSender::exportFailures() {
+  return export_failures_.load(std::memory_order_relaxed);
+}
+
+uint32_t OTelSender::oversizeCount() {
+  return oversize_.load(std::memory_order_relaxed);
+}
+
 // ---------- Public send API ----------
-void OTelSender::sendJson(const char* path, JsonDocument& doc) {
+// Appends into a String that was reserved to the exact size (ArduinoJson's own
+// String writer resets the String first, discarding the reservation)
+namespace {
+struct StringSink {
+  String& s;
+  size_t write(uint8_t c) { s += (char)c; return 1; }
+  size_t write(const uint8_t* p, size_t n) { return s.concat((const char*)p, n) ? n : 0; }
+};
+} // namespace
+
+void OTelSender::sendJson(const char* path, JsonDocument& doc, OTelPriority priority,
+                          String* scratch) {
 #if !OTEL_SEND_ENABLE
   // Compile-time: completely disable sends (useful for latency tests)
-  (void)path; (void)doc;
+  (void)path; (void)doc; (void)priority; (void)scratch;
   return;
 #else
   // Serialize on the caller's core (cheap), then:
   //  - RP2040: enqueue for core-1 worker to POST (non-blocking for control path)
-  //  - others: POST synchronously (unchanged behaviour)
-  String payload;
-  serializeJson(doc, payload);
+  //  - ESP32: same, once beginAsyncWorker() has started the worker task
+  //  - others: queue once service() is being called from loop(), else POST synchronously
+  // Size first: oversized records never allocate, and the payload is
+  // allocated at most once instead of growing chunk by chunk. A workspace
+  // scratch buffer (JsonLease) that is already large enough is reused as is.
+  if (shut_down_.load(std::memory_order_relaxed)) {
+    countDrop_(path, priority);
+    return;
+  }
+  const size_t size = measureJson(doc);
+  if (size > OTEL_MAX_REQUEST_BYTES) {
+    oversize_.fetch_add(1, std::memory_order_relaxed);
+    countDrop_(path, priority);
+    return;
+  }
+
+  #ifndef ARDUINO_ARCH_RP2040
+  // Synchronous export to a streaming exporter: serialize into the socket and
+  // never hold the payload in RAM
+  const int sig = signalOf(path);
+  if (sig >= 0 && !inWorker_() && !serviced_ &&
+      !worker_started_.load(std::memory_order_relaxed) &&
+      exporter((OTelSignal)sig).streams()) {
+    exporter((OTelSignal)sig).exportStream((OTelSignal)sig, path, DocumentPayload(doc, size));
+    return;
+  }
+  #endif
+
+  String local;
+  String& payload = scratch ? *scratch : local;
+  payload = "";
+  if (!payload.reserve(size)) {
+    countDrop_(path, priority);  // no heap block that large right now
+    return;
+  }
+  StringSink sink{payload};
+  serializeJson(doc, sink);
+
+  // Worker hooks and timers (deferred logs, metric collection) already run off
+  // the control path: batch directly rather than re-entering the SPSC queue.
+  if (inWorker_()) {
+    acceptBatch_(path, payload);
+    return;
+  }
 
   #ifdef ARDUINO_ARCH_RP2040
     // Ensure worker is launched (safe to call repeatedly)
     launchWorkerOnce_();
-    enqueue_(path, std::move(payload));
+    enqueue_(path, std::move(payload), priority);
   #else
-    HTTPClient http;
-    if (httpBeginCompat(http, fullUrl_(path))) {
-      http.addHeader("Content-Type", "application/json");
-      (void)http.POST(payload);
-      http.end();
+    // Once a worker task is running (ESP32) or loop() drives service(),
+    // hand off to it like on RP2040
+    if (worker_started_.load(std::memory_order_relaxed) || serviced_) {
+      enqueue_(path, std::move(payload), priority);
+      return;
     }
+    deliver_(path, payload);
   #endif
 #endif
 }
-
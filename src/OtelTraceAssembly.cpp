@@ -0,0 +1,113 @@
+#include "OtelTraceAssembly.h"
+#include "OtelMutex.h"
+#include "OtelScheduler.h"
+#include "OtelSender.h"   // worker and flush hooks
+#include <atomic>
+
+namespace OTel {
+
+namespace {
+
+struct HeldTrace {
+  String    traceId;    // empty = free slot
+  uint32_t  openedMs = 0;
+  size_t    bytes    = 0;
+  HeldSpans spans;
+};
+
+HeldTrace         s_traces[OTEL_TRACE_ASSEMBLY_SLOTS];
+std::atomic<bool> s_enabled{OTEL_TRACE_ASSEMBLY != 0};
+std::atomic<HeldSpansSink> s_sink{nullptr};
+
+// Guards s_traces; spans end on loop() while the worker expires traces
+Mutex& assemblyMutex() {
+  static Mutex m;
+  return m;
+}
+
+// Caller holds assemblyMutex()
+void take(HeldTrace& t, HeldSpans& out) {
+  out.swap(t.spans);
+  t.spans.clear();
+  t.bytes = 0;
+}
+
+void expireTimedOut() { (void)TraceAssembly::expire(false); }
+void expireAll()      { (void)TraceAssembly::expire(true); }
+
+} // namespace
+
+void TraceAssembly::setEnabled(bool on) { s_enabled.store(on, std::memory_order_relaxed); }
+bool TraceAssembly::enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+void TraceAssembly::hold(const String& traceId, String&& spanJson, HeldSpansSink sink) {
+  static const bool hooked = [] {
+    const bool ok = OTelSender::addHooks("trace assembly", expireTimedOut, expireAll);
+    OTelSender::beginAsyncWorker();
+    return ok;
+  }();
+  s_sink.store(sink, std::memory_order_release);
+  if (!hooked) {
+    // Nothing would expire held traces: send spans as they end instead
+    setEnabled(false);
+    HeldSpans now;
+    now.push_back(std::move(spanJson));
+    if (sink) sink(now);
+    return;
+  }
+  HeldSpans early;
+  {
+    MutexLock lock(assemblyMutex());
+    HeldTrace* slot   = nullptr;
+    HeldTrace* free   = nullptr;
+    HeldTrace* oldest = nullptr;
+    for (HeldTrace& t : s_traces) {
+      if (t.traceId == traceId) { slot = &t; break; }
+      if (!t.traceId.length()) { if (!free) free = &t; continue; }
+      if (!oldest || (int32_t)(t.openedMs - oldest->openedMs) < 0) oldest = &t;
+    }
+    if (!slot) {
+      slot = free ? free : oldest;  // all slots busy: the oldest trace leaves now
+      if (slot == oldest) take(*slot, early);
+      slot->traceId  = traceId;
+      slot->openedMs = Scheduler::now();
+    } else if (slot->bytes + spanJson.length() + 1 > OTEL_TRACE_ASSEMBLY_BYTES) {
+      take(*slot, early);           // over budget: send what is held, keep going
+    }
+    slot->bytes += spanJson.length() + 1;
+    slot->spans.push_back(std::move(spanJson));
+  }
+  if (!early.empty() && sink) sink(early);
+}
+
+void TraceAssembly::release(const String& traceId, HeldSpans& out) {
+  MutexLock lock(assemblyMutex());
+  for (HeldTrace& t : s_traces) {
+    if (t.traceId != traceId) continue;
+    take(t, out);
+    t.traceId = String();
+    return;
+  }
+}
+
+size_t TraceAssembly::expire(bool all) {
+  const HeldSpansSink sink = s_sink.load(std::memory_order_acquire);
+  HeldSpans out[OTEL_TRACE_ASSEMBLY_SLOTS];
+  size_t n = 0;
+  {
+    MutexLock lock(assemblyMutex());
+    const uint32_t nowMs = Scheduler::now();
+    for (HeldTrace& t : s_traces) {
+      if (!t.traceId.length()) continue;
+      if (!all && nowMs - t.openedMs < OTEL_TRACE_ASSEMBLY_TIMEOUT_MS) continue;
+      take(t, out[n]);
+      t.traceId = String();
+      if (!out[n].empty()) ++n;
+    }
+  }
+  // Sent outside the lock: the sink serialises and may wait for queue space
+  for (size_t i = 0; i < n; ++i) if (sink) sink(out[i]);
+  return n;
+}
+
+} // namespace OTel
@@ -0,0 +1,100 @@
+#include "OtelWorkspace.h"
+#include "OtelDefaults.h"   // OTEL_ENABLE_*
+#include <stdlib.h>
+#include <string.h>
+
+namespace OTel {
+
+// Each block is preceded by a header holding its requested size
+struct ArenaHeader { size_t size; };
+static constexpr size_t kHeader = (sizeof(ArenaHeader) + 7) & ~(size_t)7;
+
+void* JsonArena::allocate(size_t size) {
+  const size_t need = kHeader + alignUp(size);
+  if (buf_ && top_ + need <= cap_) {
+    reinterpret_cast<ArenaHeader*>(buf_ + top_)->size = size;
+    last_ = top_;
+    top_ += need;
+    if (top_ > high_) high_ = top_;
+    return buf_ + last_ + kHeader;
+  }
+  ++spills_;
+  return malloc(size);
+}
+
+void JsonArena::deallocate(void* ptr) {
+  if (!ptr) return;
+  if (!inArena(ptr)) { free(ptr); return; }
+  // Only the most recent block can be given back before reset()
+  const size_t off = (size_t)((uint8_t*)ptr - buf_) - kHeader;
+  if (off == last_) {
+    top_  = last_;
+    last_ = kNone;
+  }
+}
+
+void* JsonArena::reallocate(void* ptr, size_t newSize) {
+  if (!ptr) return allocate(newSize);
+  if (!inArena(ptr)) return realloc(ptr, newSize);
+
+  const size_t off = (size_t)((uint8_t*)ptr - buf_) - kHeader;
+  ArenaHeader* hdr = reinterpret_cast<ArenaHeader*>(buf_ + off);
+  const size_t oldSize = hdr->size;
+
+  // Most recent block: grow or shrink in place
+  if (off == last_ && off + kHeader + alignUp(newSize) <= cap_) {
+    hdr->size = newSize;
+    top_ = off + kHeader + alignUp(newSize);
+    if (top_ > high_) high_ = top_;
+    return ptr;
+  }
+  if (newSize <= oldSize) {
+    hdr->size = newSize;
+    return ptr;
+  }
+  void* moved = allocate(newSize);
+  if (moved) memcpy(moved, ptr, oldSize);
+  return moved;  // the old block is reclaimed by reset()
+}
+
+JsonWorkspace::JsonWorkspace(uint8_t* arena, size_t arenaBytes)
+: arena_(arena, arenaBytes),
+  doc_(&arena_) {}
+
+void JsonWorkspace::release() {
+  // Drop the document's pools before rewinding the arena underneath them
+  doc_.clear();
+  arena_.reset();
+  busy_.store(false, std::memory_order_release);
+}
+
+namespace {
+// Compiled-out signals (OTEL_ENABLE_*=0) get no arena
+constexpr size_t kTracesArena  = OTEL_ENABLE_TRACES  ? OTEL_JSON_ARENA_BYTES : 0;
+constexpr size_t kLogsArena    = OTEL_ENABLE_LOGS    ? OTEL_JSON_ARENA_BYTES : 0;
+constexpr size_t kMetricsArena = OTEL_ENABLE_METRICS ? OTEL_JSON_ARENA_BYTES : 0;
+
+alignas(8) uint8_t s_arenaTraces [kTracesArena  ? kTracesArena  : 1];
+alignas(8) uint8_t s_arenaLogs   [kLogsArena    ? kLogsArena    : 1];
+alignas(8) uint8_t s_arenaMetrics[kMetricsArena ? kMetricsArena : 1];
+
+JsonWorkspace s_workspaces[3] = {   // indexed by OTelSignal
+  { kTracesArena  ? s_arenaTraces  : nullptr, kTracesArena  },
+  { kLogsArena    ? s_arenaLogs    : nullptr, kLogsArena    },
+  { kMetricsArena ? s_arenaMetrics : nullptr, kMetricsArena },
+};
+} // namespace
+
+JsonWorkspace& workspaceFor(OTelSignal signal) {
+  return s_workspaces[(size_t)signal % 3];
+}
+
+size_t arenaHighWater(OTelSignal signal) {
+  return workspaceFor(signal).arena().highWater();
+}
+
+uint32_t arenaSpills(OTelSignal signal) {
+  return workspaceFor(signal).arena().spills();
+}
+
+} // namespace OTel
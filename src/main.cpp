@@ -66,11 +66,11 @@ void setup() {
 }
 
 void loop() {
-  // Heartbeat trace
-  auto span = OTel::Tracer::startSpan("heartbeat");
+  // Heartbeat trace (the OTEL_* macros compile away when a signal is disabled)
+  OTEL_SPAN(span, "heartbeat");
 
-  OTel::Logger::logInfo("Heartbeat event");
-  OTel::Metrics::gauge(
+  OTEL_LOG_INFO("Heartbeat event");
+  OTEL_METRIC_GAUGE(
           "heartbeat.gauge",                              // The name of the gauge
           1.0,                                            // The value 
           "1",                                            // The unit - "1" means no default unit
@@ -0,0 +1,51 @@
+// Fuzz target for the context propagation parsers in OtelTracer.h. Every input
+// goes through each parser; a parser may reject it, but must stay inside the
+// input and only accept well-formed IDs. Built as a libFuzzer target with
+// OTEL_FUZZ=ON (clang), and replayed over corpus/propagation by ctest.
+#include "OtelTracer.h"
+#include <cstdlib>
+
+using namespace OTel;
+
+namespace {
+
+void require(bool ok) {
+  if (!ok) abort();
+}
+
+void requireIds(const RawTraceContext& c) {
+  require(strlen(c.traceId) == 32 && isValidHexId(c.traceId, 32));
+  require(strlen(c.spanId) == 16 && isValidHexId(c.spanId, 16));
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  const char* in  = reinterpret_cast<const char*>(data);
+  const char* end = in + size;
+  RawTraceContext out;
+
+  if (parseTraceparent(in, size, out)) requireIds(out);
+  if (parseB3Single(in, size, out)) requireIds(out);
+
+  const bool hasState = setTracestate(in, size, out);
+  require(out.tracestateLen <= OTEL_TRACESTATE_MAX_LEN);
+  require(strlen(out.tracestate) == out.tracestateLen);
+  require(hasState == (out.tracestateLen > 0));
+  for (size_t i = 0; i < out.tracestateLen; ++i) {
+    require(out.tracestate[i] >= 0x20 && out.tracestate[i] <= 0x7e);
+  }
+
+  json_scan::forEachMember(in, size,
+    [&](const char* k, size_t kn, const char* v, size_t vn, bool) {
+      require(k >= in && k + kn <= end);
+      require(v >= in && v + vn <= end);
+      return true;
+    });
+
+  if (Propagators::extractFromJson(in, size, out)) {
+    requireIds(out);
+    require(out.tracestateLen <= OTEL_TRACESTATE_MAX_LEN);
+  }
+  return 0;
+}
@@ -0,0 +1,84 @@
+// Corpus-driven stand-in for libFuzzer: runs every file of the given corpus
+// directories through LLVMFuzzerTestOneInput, then a fixed number of seeded
+// mutations of them (byte flips, inserts, deletes and truncation). Inputs are
+// copied into exact-size heap buffers so ASan catches any over-read.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace {
+
+void run(const std::string& s) {
+  uint8_t* buf = static_cast<uint8_t*>(malloc(s.size() ? s.size() : 1));
+  memcpy(buf, s.data(), s.size());
+  LLVMFuzzerTestOneInput(buf, s.size());
+  free(buf);
+}
+
+bool readFile(const std::string& path, std::string& out) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  char b[512];
+  size_t n;
+  out.clear();
+  while ((n = fread(b, 1, sizeof b, f)) > 0) out.append(b, n);
+  fclose(f);
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::vector<std::string> seeds;
+  for (int a = 1; a < argc; ++a) {
+    DIR* d = opendir(argv[a]);
+    if (!d) {
+      fprintf(stderr, "cannot open corpus %s\n", argv[a]);
+      return 1;
+    }
+    while (dirent* e = readdir(d)) {
+      if (e->d_name[0] == '.') continue;
+      std::string s;
+      if (readFile(std::string(argv[a]) + "/" + e->d_name, s)) seeds.push_back(s);
+    }
+    closedir(d);
+  }
+  if (seeds.empty()) {
+    fprintf(stderr, "usage: %s <corpus dir>...\n", argv[0]);
+    return 1;
+  }
+
+  // A long tracestate exercises truncation on a member boundary
+  std::string longState;
+  for (int i = 0; i < 100; ++i) longState += "k" + std::to_string(i) + "=vvvvvv,";
+  seeds.push_back(longState);
+  seeds.push_back(std::string());
+
+  for (const std::string& s : seeds) run(s);
+
+  const char* env = getenv("OTEL_FUZZ_RUNS");
+  const long runs = env ? atol(env) : 200000;
+  std::mt19937 rng(1);
+  for (long i = 0; i < runs; ++i) {
+    std::string s = seeds[i % seeds.size()];
+    for (int k = (int)(rng() % 6); k > 0; --k) {
+      const size_t pos = s.empty() ? 0 : rng() % s.size();
+      switch (rng() % 3) {
+        case 0: if (!s.empty()) s[pos] = (char)rng(); break;
+        case 1: s.insert(pos, 1, "-{}[]\",:\\ 0af"[rng() % 14]); break;
+        default: if (!s.empty()) s.erase(pos, 1 + rng() % 8); break;
+      }
+    }
+    if (rng() % 4 == 0) s.resize(rng() % (s.size() + 1));
+    run(s);
+  }
+  printf("%zu seeds, %ld mutations\n", seeds.size(), runs);
+  return 0;
+}
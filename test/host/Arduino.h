@@ -0,0 +1,162 @@
+// Host stand-in for the parts of the Arduino core the library uses, so src/
+// can be compiled and unit-tested on Linux. Not a general Arduino emulation.
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdarg>
+#include <cctype>
+#include <chrono>
+#include <thread>
+
+class String {
+public:
+  std::string s;
+
+  String() {}
+  String(const char* c) : s(c ? c : "") {}
+  String(const std::string& x) : s(x) {}
+  explicit String(char c) : s(1, c) {}
+  String(int v) : s(std::to_string(v)) {}
+  String(unsigned v) : s(std::to_string(v)) {}
+  String(long v) : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+  String(double v, unsigned char decimals = 2) {
+    char b[64];
+    snprintf(b, sizeof b, "%.*f", decimals, v);
+    s = b;
+  }
+
+  unsigned length() const { return (unsigned)s.size(); }
+  const char* c_str() const { return s.c_str(); }
+  bool reserve(unsigned n) { s.reserve(n); return true; }
+
+  int indexOf(char c, unsigned from = 0) const { return pos(s.find(c, from)); }
+  int indexOf(const String& x, unsigned from = 0) const { return pos(s.find(x.s, from)); }
+  int lastIndexOf(char c) const { return pos(s.rfind(c)); }
+  String substring(unsigned a) const { return a >= s.size() ? String() : String(s.substr(a)); }
+  String substring(unsigned a, unsigned b) const {
+    return a >= s.size() || b <= a ? String() : String(s.substr(a, b - a));
+  }
+  bool startsWith(const String& x) const { return s.compare(0, x.s.size(), x.s) == 0; }
+  bool endsWith(const String& x) const {
+    return s.size() >= x.s.size() && s.compare(s.size() - x.s.size(), x.s.size(), x.s) == 0;
+  }
+  void remove(unsigned i) { if (i < s.size()) s.erase(i); }
+  void remove(unsigned i, unsigned n) { if (i < s.size()) s.erase(i, n); }
+  void toLowerCase() { for (auto& c : s) c = (char)tolower((unsigned char)c); }
+  void trim() {
+    const size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos) { s.clear(); return; }
+    s = s.substr(a, s.find_last_not_of(" \t\r\n") - a + 1);
+  }
+  long toInt() const { return atol(s.c_str()); }
+
+  bool concat(const char* c, unsigned n) { s.append(c, n); return true; }
+  bool concat(const String& x) { s += x.s; return true; }
+  bool concat(const char* c) { s += c; return true; }
+  bool concat(char c) { s += c; return true; }
+
+  char operator[](unsigned i) const { return i < s.size() ? s[i] : '\0'; }
+  char& operator[](unsigned i) { return s[i]; }
+  String& operator+=(const String& x) { s += x.s; return *this; }
+  String& operator+=(const char* x) { s += x; return *this; }
+  String& operator+=(char c) { s += c; return *this; }
+  bool operator==(const String& x) const { return s == x.s; }
+  bool operator==(const char* x) const { return s == (x ? x : ""); }
+  bool operator!=(const String& x) const { return s != x.s; }
+  bool operator!=(const char* x) const { return !(*this == x); }
+  bool operator<(const String& x) const { return s < x.s; }
+
+  // Print-like sink, as Arduino's StreamString
+  size_t write(uint8_t c) { s += (char)c; return 1; }
+  size_t write(const uint8_t* b, size_t n) { s.append((const char*)b, n); return n; }
+
+private:
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+};
+
+inline String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+inline String operator+(const String& a, const char* b) { return String(a.s + b); }
+inline String operator+(const char* a, const String& b) { return String(a + b.s); }
+inline String operator+(const String& a, char b) { return String(a.s + b); }
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* b, size_t n) {
+    for (size_t i = 0; i < n; ++i) write(b[i]);
+    return n;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return print(String(v)); }
+  size_t print(unsigned v) { return print(String(v)); }
+  size_t print(long v) { return print(String(v)); }
+  size_t print(unsigned long v) { return print(String(v)); }
+  size_t print(double v) { return print(String(v)); }
+  template <class T> size_t println(const T& v) { return print(v) + write("\n"); }
+  size_t println() { return write("\n"); }
+  size_t printf(const char* fmt, ...) {
+    char b[512];
+    va_list a;
+    va_start(a, fmt);
+    const int n = vsnprintf(b, sizeof b, fmt, a);
+    va_end(a);
+    write((const uint8_t*)b, strlen(b));
+    return n < 0 ? 0 : (size_t)n;
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+};
+
+// Serial output is discarded unless OTEL_HOST_SERIAL is set in the environment
+struct HardwareSerial : Stream {
+  size_t write(uint8_t c) override;
+  using Print::write;
+  void begin(unsigned long) {}
+  void flush() {}
+};
+extern HardwareSerial Serial;
+
+inline unsigned long millis() {
+  using namespace std::chrono;
+  static const auto t0 = steady_clock::now();
+  return (unsigned long)duration_cast<milliseconds>(steady_clock::now() - t0).count();
+}
+inline unsigned long micros() {
+  using namespace std::chrono;
+  static const auto t0 = steady_clock::now();
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now() - t0).count();
+}
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(unsigned us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+inline void yield() { std::this_thread::yield(); }
+inline long random(long a, long b) { return a + rand() % (b - a); }
+inline long random() { return rand(); }
+inline void randomSeed(unsigned long s) { srand((unsigned)s); }
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline uint32_t getCpuFrequencyMhz() { return 240; }
+
+struct EspClass {
+  uint64_t getEfuseMac() { return 0x1234567890ULL; }
+  uint32_t getChipId() { return 1234; }
+  uint32_t getFreeHeap() { return 100000; }
+  uint32_t getMaxAllocHeap() { return 50000; }
+  uint32_t getCycleCount() { return (uint32_t)(micros() * 240); }
+};
+extern EspClass ESP;
+
+#define IRAM_ATTR
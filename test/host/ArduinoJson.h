@@ -0,0 +1,297 @@
+// Host stand-in for the subset of the ArduinoJson 7 API the library uses:
+// documents built through JsonVariant/JsonObject/JsonArray handles, raw
+// `serialized()` values and compact serialisation. Output is compact JSON in
+// insertion order; number formatting may differ from ArduinoJson in the last
+// digit of doubles, so tests compare structure rather than exact doubles.
+#pragma once
+
+#include <Arduino.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ArduinoJson {
+struct Allocator {
+  virtual void* allocate(size_t) = 0;
+  virtual void  deallocate(void*) = 0;
+  virtual void* reallocate(void*, size_t) = 0;
+protected:
+  ~Allocator() {}
+};
+} // namespace ArduinoJson
+using ArduinoJson::Allocator;
+
+namespace otel_host_json {
+
+struct Node {
+  enum Type { Null, Obj, Arr, Str, Int, UInt, Dbl, Bool, Raw } t = Null;
+  std::string s;
+  int64_t  i = 0;
+  uint64_t u = 0;
+  double   d = 0;
+  bool     b = false;
+  std::vector<std::pair<std::string, Node*>> o;
+  std::vector<Node*> a;
+};
+
+struct Pool {
+  std::deque<Node> nodes;
+  Node* make() { nodes.emplace_back(); return &nodes.back(); }
+};
+
+inline void copy(Node* d, const Node* s, Pool* p) {
+  d->t = s->t; d->s = s->s; d->i = s->i; d->u = s->u; d->d = s->d; d->b = s->b;
+  d->o.clear();
+  d->a.clear();
+  for (auto& kv : s->o) { Node* c = p->make(); copy(c, kv.second, p); d->o.push_back({kv.first, c}); }
+  for (auto* x : s->a)  { Node* c = p->make(); copy(c, x, p); d->a.push_back(c); }
+}
+
+inline void escape(std::string& out, const std::string& s) {
+  out += '"';
+  for (unsigned char c : s) {
+    switch (c) {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (c < 0x20) { char b[8]; snprintf(b, sizeof b, "\\u%04x", c); out += b; }
+        else out += (char)c;
+    }
+  }
+  out += '"';
+}
+
+inline void write(std::string& out, const Node* n) {
+  switch (n->t) {
+    case Node::Null: out += "null"; break;
+    case Node::Str:  escape(out, n->s); break;
+    case Node::Raw:  out += n->s; break;
+    case Node::Int:  out += std::to_string(n->i); break;
+    case Node::UInt: out += std::to_string(n->u); break;
+    case Node::Dbl:  { char b[32]; snprintf(b, sizeof b, "%.9g", n->d); out += b; break; }
+    case Node::Bool: out += n->b ? "true" : "false"; break;
+    case Node::Obj: {
+      out += '{';
+      for (size_t k = 0; k < n->o.size(); ++k) {
+        if (k) out += ',';
+        escape(out, n->o[k].first);
+        out += ':';
+        write(out, n->o[k].second);
+      }
+      out += '}';
+      break;
+    }
+    case Node::Arr: {
+      out += '[';
+      for (size_t k = 0; k < n->a.size(); ++k) {
+        if (k) out += ',';
+        write(out, n->a[k]);
+      }
+      out += ']';
+      break;
+    }
+  }
+}
+
+} // namespace otel_host_json
+
+struct SerializedValue { std::string s; };
+inline SerializedValue serialized(const String& s) { return SerializedValue{ s.c_str() }; }
+inline SerializedValue serialized(const char* s) { return SerializedValue{ s ? s : "" }; }
+
+class JsonObject;
+class JsonArray;
+
+// Handle to a node. Assigning a value through a handle sets the node;
+// JsonObject/JsonArray variables rebind on copy-assignment, as in ArduinoJson.
+class JsonVariant {
+public:
+  using Node = otel_host_json::Node;
+  using Pool = otel_host_json::Pool;
+
+  JsonVariant(Node* n = nullptr, Pool* p = nullptr) : n_(n), p_(p) {}
+  JsonVariant(const JsonVariant&) = default;
+
+  JsonVariant operator[](const char* k) const;
+  JsonVariant operator[](const String& k) const { return (*this)[k.c_str()]; }
+  JsonVariant operator[](int i) const;
+  template <class T> T to() const;
+  template <class T> T add() const;
+  template <class T> bool is() const;
+  template <class T> T as() const;
+  bool isNull() const { return !n_ || n_->t == Node::Null; }
+
+  const JsonVariant& operator=(const char* v) const { if (n_) { reset(Node::Str); n_->s = v ? v : ""; } return *this; }
+  const JsonVariant& operator=(const String& v) const { return *this = v.c_str(); }
+  const JsonVariant& operator=(bool v) const { if (n_) { reset(Node::Bool); n_->b = v; } return *this; }
+  const JsonVariant& operator=(double v) const { if (n_) { reset(Node::Dbl); n_->d = v; } return *this; }
+  const JsonVariant& operator=(float v) const { return *this = (double)v; }
+  const JsonVariant& operator=(int8_t v) const { return *this = (long long)v; }
+  const JsonVariant& operator=(int16_t v) const { return *this = (long long)v; }
+  const JsonVariant& operator=(int v) const { return *this = (long long)v; }
+  const JsonVariant& operator=(long v) const { return *this = (long long)v; }
+  const JsonVariant& operator=(long long v) const { if (n_) { reset(Node::Int); n_->i = v; } return *this; }
+  const JsonVariant& operator=(uint8_t v) const { return *this = (unsigned long long)v; }
+  const JsonVariant& operator=(uint16_t v) const { return *this = (unsigned long long)v; }
+  const JsonVariant& operator=(unsigned v) const { return *this = (unsigned long long)v; }
+  const JsonVariant& operator=(unsigned long v) const { return *this = (unsigned long long)v; }
+  const JsonVariant& operator=(unsigned long long v) const { if (n_) { reset(Node::UInt); n_->u = v; } return *this; }
+  const JsonVariant& operator=(const SerializedValue& v) const { if (n_) { reset(Node::Raw); n_->s = v.s; } return *this; }
+  const JsonVariant& operator=(const JsonVariant& v) const {
+    if (n_ && v.n_ && n_ != v.n_) otel_host_json::copy(n_, v.n_, p_);
+    return *this;
+  }
+
+  Node* n_;
+  Pool* p_;
+
+private:
+  void reset(Node::Type t) const { *n_ = Node(); n_->t = t; }
+};
+
+class JsonObject : public JsonVariant {
+public:
+  using JsonVariant::JsonVariant;
+  using JsonVariant::operator=;
+  JsonObject() {}
+  JsonObject(const JsonVariant& v) : JsonVariant(v) {}
+  JsonObject(const JsonObject&) = default;
+  JsonObject& operator=(const JsonObject& o) { n_ = o.n_; p_ = o.p_; return *this; }
+  size_t size() const { return n_ && n_->t == Node::Obj ? n_->o.size() : 0; }
+};
+
+class JsonArray : public JsonVariant {
+public:
+  using JsonVariant::JsonVariant;
+  JsonArray() {}
+  JsonArray(const JsonVariant& v) : JsonVariant(v) {}
+  JsonArray(const JsonArray&) = default;
+  JsonArray& operator=(const JsonArray& o) { n_ = o.n_; p_ = o.p_; return *this; }
+  template <class T> T add() const { return JsonVariant::add<T>(); }
+  template <class V> bool add(const V& v) const {
+    JsonVariant x = JsonVariant::add<JsonVariant>();
+    x = v;
+    return !x.isNull() || true;
+  }
+  size_t size() const { return n_ && n_->t == Node::Arr ? n_->a.size() : 0; }
+  void remove(size_t i) const { if (n_ && i < n_->a.size()) n_->a.erase(n_->a.begin() + i); }
+};
+
+using JsonObjectConst  = JsonObject;
+using JsonArrayConst   = JsonArray;
+using JsonVariantConst = JsonVariant;
+
+inline JsonVariant JsonVariant::operator[](const char* k) const {
+  if (!n_) return JsonVariant();
+  if (n_->t == Node::Null) n_->t = Node::Obj;
+  if (n_->t != Node::Obj) return JsonVariant();
+  for (auto& kv : n_->o) if (kv.first == k) return JsonVariant(kv.second, p_);
+  Node* c = p_->make();
+  n_->o.push_back({k, c});
+  return JsonVariant(c, p_);
+}
+
+inline JsonVariant JsonVariant::operator[](int i) const {
+  if (!n_ || i < 0) return JsonVariant();
+  if (n_->t == Node::Null) n_->t = Node::Arr;
+  if (n_->t != Node::Arr) return JsonVariant();
+  while ((int)n_->a.size() <= i) n_->a.push_back(p_->make());
+  return JsonVariant(n_->a[i], p_);
+}
+
+template <> inline JsonObject JsonVariant::to<JsonObject>() const { if (n_) reset(Node::Obj); return JsonObject(n_, p_); }
+template <> inline JsonArray JsonVariant::to<JsonArray>() const { if (n_) reset(Node::Arr); return JsonArray(n_, p_); }
+template <> inline JsonVariant JsonVariant::to<JsonVariant>() const { if (n_) reset(Node::Null); return *this; }
+
+template <> inline JsonVariant JsonVariant::add<JsonVariant>() const {
+  if (!n_) return JsonVariant();
+  if (n_->t == Node::Null) n_->t = Node::Arr;
+  if (n_->t != Node::Arr) return JsonVariant();
+  Node* c = p_->make();
+  n_->a.push_back(c);
+  return JsonVariant(c, p_);
+}
+template <> inline JsonObject JsonVariant::add<JsonObject>() const { return add<JsonVariant>().to<JsonObject>(); }
+template <> inline JsonArray JsonVariant::add<JsonArray>() const { return add<JsonVariant>().to<JsonArray>(); }
+
+template <> inline bool JsonVariant::is<const char*>() const { return n_ && n_->t == Node::Str; }
+template <> inline bool JsonVariant::is<JsonObject>() const { return n_ && n_->t == Node::Obj; }
+template <> inline bool JsonVariant::is<JsonArray>() const { return n_ && n_->t == Node::Arr; }
+template <> inline bool JsonVariant::is<int>() const { return n_ && (n_->t == Node::Int || n_->t == Node::UInt); }
+template <> inline bool JsonVariant::is<uint8_t>() const { return is<int>(); }
+
+template <> inline const char* JsonVariant::as<const char*>() const { return n_ && n_->t == Node::Str ? n_->s.c_str() : nullptr; }
+template <> inline String JsonVariant::as<String>() const { return n_ && n_->t == Node::Str ? String(n_->s) : String(); }
+template <> inline int JsonVariant::as<int>() const { return n_ ? (int)(n_->t == Node::Int ? n_->i : (int64_t)n_->u) : 0; }
+template <> inline uint8_t JsonVariant::as<uint8_t>() const { return (uint8_t)as<int>(); }
+
+class JsonDocument {
+public:
+  JsonDocument() { root_ = pool_.make(); }
+  explicit JsonDocument(Allocator*) : JsonDocument() {}
+  JsonDocument(const JsonDocument&) = delete;
+  JsonDocument& operator=(const JsonDocument&) = delete;
+
+  JsonVariant operator[](const char* k) { return root()[k]; }
+  JsonVariant operator[](const String& k) { return root()[k.c_str()]; }
+  JsonVariant operator[](int i) { return root()[i]; }
+  template <class T> T to() { return root().to<T>(); }
+  template <class T> T as() { return T(root_, &pool_); }
+  void clear() { pool_.nodes.clear(); root_ = pool_.make(); }
+  bool overflowed() const { return false; }
+  void shrinkToFit() {}
+  JsonVariant root() { return JsonVariant(root_, &pool_); }
+  const JsonVariant::Node* rootNode() const { return root_; }
+
+private:
+  otel_host_json::Pool pool_;
+  JsonVariant::Node*   root_;
+};
+
+inline std::string toJsonString(const JsonDocument& d) {
+  std::string o;
+  otel_host_json::write(o, d.rootNode());
+  return o;
+}
+inline std::string toJsonString(const JsonVariant& v) {
+  std::string o;
+  if (v.n_) otel_host_json::write(o, v.n_); else o = "null";
+  return o;
+}
+
+template <class Src> inline size_t serializeJson(const Src& d, String& out) {
+  const std::string s = toJsonString(d);
+  out.s += s;
+  return s.size();
+}
+template <class Src> inline size_t serializeJson(const Src& d, char* b, size_t n) {
+  const std::string s = toJsonString(d);
+  const size_t k = s.size() < n ? s.size() : (n ? n - 1 : 0);
+  memcpy(b, s.data(), k);
+  if (n) b[k] = 0;
+  return k;
+}
+// Any writer with write(const uint8_t*, size_t): Print, custom sinks
+template <class Src, class Writer> inline size_t serializeJson(const Src& d, Writer& w) {
+  const std::string s = toJsonString(d);
+  w.write((const uint8_t*)s.data(), s.size());
+  return s.size();
+}
+template <class Src> inline size_t measureJson(const Src& d) { return toJsonString(d).size(); }
+
+class DeserializationError {
+public:
+  enum Code { Ok, InvalidInput };
+  DeserializationError(Code c = Ok) : c_(c) {}
+  explicit operator bool() const { return c_ != Ok; }
+  const char* c_str() const { return c_ == Ok ? "Ok" : "InvalidInput"; }
+private:
+  Code c_;
+};
+// Not needed by the library; present so sketches that include it compile
+inline DeserializationError deserializeJson(JsonDocument&, const String&) { return DeserializationError::InvalidInput; }
+inline DeserializationError deserializeJson(JsonDocument&, const char*) { return DeserializationError::InvalidInput; }
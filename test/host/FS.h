@@ -0,0 +1,30 @@
+// Host stand-in for the Arduino FS API on top of stdio
+#pragma once
+
+#include <Arduino.h>
+#include <cstdio>
+
+namespace fs {
+
+class File : public Print {
+public:
+  File(FILE* f = nullptr) : f_(f) {}
+  explicit operator bool() const { return f_ != nullptr; }
+  size_t write(uint8_t c) override { return fputc(c, f_) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* b, size_t n) override { return fwrite(b, 1, n, f_); }
+  using Print::write;
+  void close() { if (f_) fclose(f_); f_ = nullptr; }
+
+private:
+  FILE* f_;
+};
+
+class FS {
+public:
+  File open(const char* path, const char* mode) { return File(fopen(path, mode)); }
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
@@ -0,0 +1,37 @@
+// Host stand-in for HTTPClient: records each POST and answers with the next
+// queued status code (200 when none is queued)
+#pragma once
+
+#include <WiFi.h>
+#include <string>
+#include <vector>
+
+#define HTTP_CODE_OK 200
+
+class HTTPClient {
+public:
+  static std::vector<std::string>& posts() { static std::vector<std::string> v; return v; }
+  static std::vector<std::string>& urls()  { static std::vector<std::string> v; return v; }
+  static std::vector<int>&         codes() { static std::vector<int> v; return v; }
+
+  bool begin(const String& u) { urls().push_back(u.s); return true; }
+  bool begin(WiFiClient&, const String& u) { return begin(u); }
+  void addHeader(const String&, const String&) {}
+  int POST(const String& p) { posts().push_back(p.s); return next(); }
+  int POST(uint8_t* p, size_t n) { posts().push_back(std::string((char*)p, n)); return next(); }
+  int sendRequest(const char*, Stream*, size_t) { return next(); }
+  void end() {}
+  void setReuse(bool) {}
+  void setTimeout(uint16_t) {}
+  void setConnectTimeout(int32_t) {}
+  WiFiClient* getStreamPtr() { return &client_; }
+
+private:
+  static int next() {
+    if (codes().empty()) return 200;
+    const int c = codes().front();
+    codes().erase(codes().begin());
+    return c;
+  }
+  WiFiClient client_;
+};
@@ -0,0 +1,92 @@
+// Host stand-in for the WiFi core: a loopback WiFiClient whose sent bytes and
+// canned response (queued once per request) are visible to tests through HostNet
+#pragma once
+
+#include <Arduino.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define WL_CONNECTED 3
+
+struct HostNet {
+  static std::string& tcpSent()      { static std::string s; return s; }
+  static std::string& tcpResponse()  { static std::string s = tcpOk(); return s; }
+  static int&         tcpConnects()  { static int n = 0; return n; }
+  static bool&        tcpRefuse()    { static bool b = false; return b; }
+  static bool&        tcpBroken()    { static bool b = false; return b; }  // writes fail until the next connect
+  static const char*  tcpOk()        { return "HTTP/1.1 200 OK\r\n\r\n"; }
+  static std::vector<std::string>& udpPackets() { static std::vector<std::string> v; return v; }
+  static void reset() {
+    tcpSent().clear();
+    tcpConnects() = 0;
+    tcpRefuse()   = false;
+    tcpBroken()   = false;
+    tcpResponse() = tcpOk();
+    udpPackets().clear();
+  }
+};
+
+class WiFiClient : public Stream {
+public:
+  int connect(const char*, uint16_t) {
+    if (HostNet::tcpRefuse()) return 0;
+    open_ = true;
+    in_.clear();
+    sending_ = false;
+    HostNet::tcpBroken() = false;
+    ++HostNet::tcpConnects();
+    return 1;
+  }
+  int connect(const String& host, uint16_t port) { return connect(host.c_str(), port); }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* b, size_t n) override {
+    if (HostNet::tcpBroken()) return 0;
+    // The first write after a read starts a request: its canned response
+    // queues behind anything the previous one left unread
+    if (!sending_) in_ += HostNet::tcpResponse();
+    sending_ = true;
+    HostNet::tcpSent().append((const char*)b, n);
+    return n;
+  }
+  using Print::write;
+
+  String readStringUntil(char term) {
+    sending_ = false;
+    size_t e = in_.find(term);
+    if (e == std::string::npos) e = in_.size();
+    const std::string line = in_.substr(0, e);
+    in_.erase(0, std::min(e + 1, in_.size()));
+    return String(line);
+  }
+  size_t readBytes(uint8_t* b, size_t n) {
+    sending_ = false;
+    const size_t k = std::min(n, in_.size());
+    memcpy(b, in_.data(), k);
+    in_.erase(0, k);
+    return k;
+  }
+  bool connected() { return open_; }
+  void stop() { open_ = false; in_.clear(); sending_ = false; }
+  void setNoDelay(bool) {}
+  void setTimeout(unsigned long) {}
+  operator bool() { return open_; }
+
+private:
+  bool        open_    = false;
+  bool        sending_ = false;
+  std::string in_;  // response bytes not read yet
+};
+
+class IPAddress {
+public:
+  IPAddress() {}
+  IPAddress(uint8_t, uint8_t, uint8_t, uint8_t) {}
+  bool fromString(const char*) { return true; }
+};
+
+struct WiFiClass {
+  int  status() { return WL_CONNECTED; }
+  void begin(const char*, const char*) {}
+};
+extern WiFiClass WiFi;
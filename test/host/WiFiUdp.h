@@ -0,0 +1,17 @@
+// Host stand-in for WiFiUDP: every datagram lands in HostNet::udpPackets()
+#pragma once
+
+#include <WiFi.h>
+
+class WiFiUDP {
+public:
+  uint8_t begin(uint16_t) { return 1; }
+  int beginPacket(const char*, uint16_t) { cur_.clear(); return 1; }
+  int beginPacket(IPAddress, uint16_t) { cur_.clear(); return 1; }
+  size_t write(const uint8_t* b, size_t n) { cur_.append((const char*)b, n); return n; }
+  int endPacket() { HostNet::udpPackets().push_back(cur_); return 1; }
+  void stop() {}
+
+private:
+  std::string cur_;
+};
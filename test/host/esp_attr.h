@@ -0,0 +1,4 @@
+// Host stand-in: no-init RAM is ordinary zero-initialised data on the host
+#pragma once
+
+#define __NOINIT_ATTR
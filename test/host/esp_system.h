@@ -0,0 +1,18 @@
+// Host stand-in for the ESP-IDF system API; tests set the reset reason
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+inline uint32_t esp_random() { return (uint32_t)rand(); }
+inline void esp_fill_random(void* b, size_t n) {
+  for (size_t i = 0; i < n; ++i) static_cast<uint8_t*>(b)[i] = (uint8_t)rand();
+}
+
+typedef enum {
+  ESP_RST_UNKNOWN, ESP_RST_POWERON, ESP_RST_EXT, ESP_RST_SW, ESP_RST_PANIC, ESP_RST_INT_WDT,
+  ESP_RST_TASK_WDT, ESP_RST_WDT, ESP_RST_DEEPSLEEP, ESP_RST_BROWNOUT, ESP_RST_SDIO
+} esp_reset_reason_t;
+
+inline esp_reset_reason_t& hostResetReason() { static esp_reset_reason_t r = ESP_RST_POWERON; return r; }
+inline esp_reset_reason_t esp_reset_reason() { return hostResetReason(); }
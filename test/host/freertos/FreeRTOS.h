@@ -0,0 +1,33 @@
+// Host stand-in for the FreeRTOS primitives the library uses. Each thread has
+// a "core" id (hostCoreId()); masking interrupts on a core excludes the other
+// threads bound to it, which is what per-core slots rely on.
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+typedef void*    TaskHandle_t;
+typedef int      BaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t UBaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define portMAX_DELAY 0xffffffffu
+#define pdMS_TO_TICKS(x) (x)
+#define portTICK_PERIOD_MS 1
+
+typedef std::recursive_mutex portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(m) (m)->lock()
+#define portEXIT_CRITICAL(m)  (m)->unlock()
+
+inline int& hostCoreId() { static thread_local int id = 0; return id; }
+inline std::mutex& hostCoreMask(int core) { static std::mutex m[2]; return m[core & 1]; }
+
+inline UBaseType_t portSET_INTERRUPT_MASK_FROM_ISR() { hostCoreMask(hostCoreId()).lock(); return 0; }
+inline void portCLEAR_INTERRUPT_MASK_FROM_ISR(UBaseType_t) { hostCoreMask(hostCoreId()).unlock(); }
+inline BaseType_t xPortGetCoreID() { return hostCoreId(); }
+inline bool xPortInIsrContext() { return false; }
@@ -0,0 +1,50 @@
+// Host stand-in for FreeRTOS tasks: detached std::threads with task notifications
+#pragma once
+
+#include "FreeRTOS.h"
+#include <chrono>
+#include <condition_variable>
+
+struct HostTask {
+  std::mutex              m;
+  std::condition_variable cv;
+  uint32_t                notes = 0;
+};
+
+inline HostTask*& hostCurrentTask() { static thread_local HostTask* t = nullptr; return t; }
+
+inline BaseType_t xTaskCreatePinnedToCore(void (*fn)(void*), const char*, uint32_t, void* arg,
+                                          UBaseType_t, TaskHandle_t* handle, int core) {
+  HostTask* t = new HostTask();
+  if (handle) *handle = t;
+  std::thread([=] {
+    hostCurrentTask() = t;
+    hostCoreId()      = core;
+    fn(arg);
+  }).detach();
+  return pdPASS;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return hostCurrentTask(); }
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t h) {
+  HostTask* t = static_cast<HostTask*>(h);
+  {
+    std::lock_guard<std::mutex> lock(t->m);
+    ++t->notes;
+  }
+  t->cv.notify_one();
+  return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+  HostTask* t = hostCurrentTask();
+  std::unique_lock<std::mutex> lock(t->m);
+  t->cv.wait_for(lock, std::chrono::milliseconds(ticks == portMAX_DELAY ? 1000000 : ticks),
+                 [&] { return t->notes > 0; });
+  const uint32_t n = t->notes;
+  if (clear) t->notes = 0; else if (n) --t->notes;
+  return n;
+}
+
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
@@ -0,0 +1,13 @@
+// Globals of the host stand-ins
+#include <Arduino.h>
+#include <WiFi.h>
+
+HardwareSerial Serial;
+EspClass       ESP;
+WiFiClass      WiFi;
+
+size_t HardwareSerial::write(uint8_t c) {
+  static const bool echo = getenv("OTEL_HOST_SERIAL") != nullptr;
+  if (echo) fputc(c, stdout);
+  return 1;
+}
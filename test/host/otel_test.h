@@ -0,0 +1,114 @@
+// Minimal test registry for the host tests: TEST(name) { CHECK(...); }, plus
+// the exporter fixture and payload helpers the suites share
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include "OtelExporter.h"
+
+namespace otel_test {
+
+struct Case {
+  const char*           name;
+  std::function<void()> fn;
+};
+
+inline std::vector<Case>& cases() { static std::vector<Case> v; return v; }
+inline int& failures() { static int n = 0; return n; }
+
+struct Register {
+  Register(const char* name, std::function<void()> fn) { cases().push_back({name, fn}); }
+};
+
+// The suite's MemoryExporter, declared at namespace scope:
+//   otel_test::ExporterFixture exporter([] { Metrics::setExportInterval(0); });
+// exporter() installs it for every signal on first use, then runs `setup`
+// once (virtual clock, export interval, subsystems to start).
+class ExporterFixture {
+public:
+  explicit ExporterFixture(void (*setup)() = nullptr) : setup_(setup) {}
+
+  OTel::MemoryExporter& operator()() {
+    if (!m_) {
+      m_ = new OTel::MemoryExporter(64);  // lives as long as the sender uses it
+      OTelSender::setExporter(m_);
+      if (setup_) setup_();
+    }
+    return *m_;
+  }
+
+  // Requests exported since the last call, after a flush()
+  std::vector<String> requests() {
+    OTel::MemoryExporter& m = (*this)();
+    OTelSender::flush(1000);
+    std::vector<String> out;
+    for (size_t i = 0; i < m.size(); ++i) out.push_back(m.at(i).payload);
+    m.clear();
+    return out;
+  }
+
+  // The same, concatenated
+  String exported() {
+    String all;
+    for (const String& r : requests()) all += r;
+    return all;
+  }
+
+private:
+  void (*setup_)();
+  OTel::MemoryExporter* m_ = nullptr;
+};
+
+// Occurrences of `needle` in `s`
+inline int count(const String& s, const char* needle) {
+  int n = 0;
+  for (int i = s.indexOf(String(needle)); i >= 0; i = s.indexOf(String(needle), i + 1)) ++n;
+  return n;
+}
+
+// The part of an OTLP metrics payload describing metric `name`, up to the next metric
+inline String metricJson(const String& s, const char* name) {
+  const int at = s.indexOf(String("\"name\":\"") + name + "\"");
+  if (at < 0) return String();
+  const int next = s.indexOf(String("{\"name\":"), at + 1);
+  return next < 0 ? s.substring(at) : s.substring(at, next);
+}
+
+} // namespace otel_test
+
+#define OTEL_TEST_CAT2(a, b) a##b
+#define OTEL_TEST_CAT(a, b) OTEL_TEST_CAT2(a, b)
+
+#define TEST(name)                                                              \
+  static void name();                                                           \
+  static otel_test::Register OTEL_TEST_CAT(reg_, name)(#name, name);            \
+  static void name()
+
+#define CHECK(cond)                                                             \
+  do {                                                                          \
+    if (!(cond)) {                                                              \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);  \
+      ++otel_test::failures();                                                  \
+    }                                                                           \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                          \
+  do {                                                                          \
+    const auto va_ = (a);                                                       \
+    const auto vb_ = (b);                                                       \
+    if (!(va_ == vb_)) {                                                        \
+      fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s (%lld vs %lld)\n",      \
+              __FILE__, __LINE__, #a, #b, (long long)va_, (long long)vb_);      \
+      ++otel_test::failures();                                                  \
+    }                                                                           \
+  } while (0)
+
+#define CHECK_CONTAINS(haystack, needle)                                        \
+  do {                                                                          \
+    if (String(haystack).indexOf(String(needle)) < 0) {                         \
+      fprintf(stderr, "%s:%d: \"%s\" not found in %s\n", __FILE__, __LINE__,    \
+              needle, #haystack);                                               \
+      ++otel_test::failures();                                                  \
+    }                                                                           \
+  } while (0)
@@ -0,0 +1,21 @@
+// Runs every TEST() linked into the executable; a test name may be given to
+// run just that one.
+#include "otel_test.h"
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+  int run = 0;
+  for (const otel_test::Case& c : otel_test::cases()) {
+    if (argc > 1 && strcmp(argv[1], c.name) != 0) continue;
+    const int before = otel_test::failures();
+    c.fn();
+    printf("%s %s\n", otel_test::failures() == before ? "ok  " : "FAIL", c.name);
+    ++run;
+  }
+  printf("%d tests, %d failed checks\n", run, otel_test::failures());
+  fflush(stdout);
+  // The sender worker never stops, as on a device: leave without running the
+  // static destructors of state it may still be touching
+  _Exit(run == 0 || otel_test::failures() ? 1 : 0);
+}
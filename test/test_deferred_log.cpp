@@ -0,0 +1,87 @@
+// Deferred logging: formatDeferred() renders captured arguments as snprintf
+// would, including string precision and '*' widths, and logf() records come
+// out of the worker with that text as their body
+#include "otel_test.h"
+#include "OtelLogger.h"
+#include "OtelExporter.h"
+
+using namespace OTel;
+
+namespace {
+
+template <typename... Args>
+String deferred(const char* fmt, const Args&... args) {
+  DeferredLogRecord rec;
+  rec.fmt = fmt;
+  DeferredArgWriter w(rec);
+  int expand[] = {0, (w.put(args), 0)...};
+  (void)expand;
+  char out[OTEL_DEFERRED_LOG_MSG_MAX];
+  formatDeferred(out, sizeof(out), rec);
+  return String(out);
+}
+
+template <typename... Args>
+String direct(const char* fmt, const Args&... args) {
+  char out[OTEL_DEFERRED_LOG_MSG_MAX];
+  snprintf(out, sizeof(out), fmt, args...);
+  return String(out);
+}
+
+#define CHECK_FORMAT(...) CHECK(deferred(__VA_ARGS__) == direct(__VA_ARGS__))
+
+otel_test::ExporterFixture exporter;
+
+} // namespace
+
+TEST(strings_take_their_precision) {
+  CHECK_FORMAT("[%s]", "hello");
+  CHECK_FORMAT("[%.3s]", "hello");
+  CHECK_FORMAT("[%.9s]", "hello");
+  CHECK_FORMAT("[%.0s]", "hello");
+  CHECK_FORMAT("[%.s]", "hello");
+  CHECK_FORMAT("[%8.2s]", "hello");
+  CHECK_FORMAT("[%-8s]", "hello");
+  CHECK(deferred("[%s]", String("copied")) == "[copied]");
+}
+
+TEST(star_width_and_precision_come_from_arguments) {
+  CHECK_FORMAT("[%*d]", 6, 42);
+  CHECK_FORMAT("[%-*d]", 6, 42);
+  CHECK_FORMAT("[%*d]", -6, 42);
+  CHECK_FORMAT("[%.*s]", 2, "hello");
+  CHECK_FORMAT("[%.*s]", -1, "hello");
+  CHECK_FORMAT("[%*.*f]", 9, 2, 3.14159);
+  CHECK_FORMAT("[%0*x]", 8, 0xbeefu);
+  CHECK_FORMAT("[%*s|%d]", 7, "ab", 5);  // the '*' argument is consumed
+}
+
+TEST(numbers_match_snprintf) {
+  CHECK_FORMAT("%d %i %u %x %X %o %c", -7, 8, 9u, 255, 255, 8, 'z');
+  CHECK_FORMAT("%+5d|%-5d|%05d", 3, 3, 3);
+  CHECK_FORMAT("%.2f %e %g", 1.005, 12345.678, 0.0001);
+  CHECK_FORMAT("%ld %lu", -123456L, 123456UL);
+  CHECK_FORMAT("100%%");
+  CHECK(deferred("%lld", (long long)-9000000000LL) == "-9000000000");
+  CHECK(deferred("%llu", 18446744073709551615ULL) == "18446744073709551615");
+  CHECK(deferred("%llx", 0x123456789abcULL) == "123456789abc");
+}
+
+TEST(missing_arguments_and_small_buffers) {
+  CHECK(deferred("a=%d b=%d", 1) == "a=1 b=?");
+  DeferredLogRecord rec;
+  rec.fmt = "value %s";
+  DeferredArgWriter w(rec);
+  w.put("long enough");
+  char out[10];
+  CHECK_EQ(formatDeferred(out, sizeof(out), rec), 9u);
+  CHECK(String(out) == "value lon");
+}
+
+TEST(logf_sends_the_formatted_body) {
+  exporter.exported();
+  CHECK(Logger::logf(Severity::Warn, "sensor %s read %.*s at %5.1f", "bme280", 3, "okay", 21.46));
+  const String all = exporter.exported();
+  CHECK_CONTAINS(all, "\"body\":{\"stringValue\":\"sensor bme280 read oka at  21.5\"}");
+  CHECK_CONTAINS(all, "\"severityText\":\"WARN\"");
+}
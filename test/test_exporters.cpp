@@ -0,0 +1,359 @@
+// Exporters: framing of the file/serial/relay/HTTP transports and the composite
+// exporters' delivery rules
+#include "otel_test.h"
+#include "OtelExporter.h"
+#include "OtelScheduler.h"
+#include <FS.h>
+#include <WiFi.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace OTel;
+
+namespace {
+
+// Print that keeps what is written
+struct Capture : Print {
+  std::string out;
+  size_t write(uint8_t c) override { out += (char)c; return 1; }
+  using Print::write;
+};
+
+// Exporter answering with a fixed result and counting calls
+struct Fixed : Exporter {
+  ExportResult result;
+  int          calls = 0;
+  explicit Fixed(ExportResult r) : result(r) {}
+  ExportResult exportRequest(OTelSignal, const char*, const String&) override {
+    ++calls;
+    return result;
+  }
+};
+
+// Request body for the streaming exporters; `known` reports its size
+struct Text : PayloadSource {
+  std::string body;
+  bool        known;
+  Text(const std::string& b, bool k = true) : body(b), known(k) {}
+  size_t size() const override { return known ? body.size() : 0; }
+  void writeTo(Print& out) const override { out.write((const uint8_t*)body.data(), body.size()); }
+};
+
+const char* kKeepAlive = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+
+int requests(const std::string& sent) {
+  int n = 0;
+  for (size_t at = sent.find("POST "); at != std::string::npos; at = sent.find("POST ", at + 1)) ++n;
+  return n;
+}
+
+uint32_t s_now = 0;
+uint32_t virtualClock() { return s_now; }
+
+std::string readFile(const char* path) {
+  std::string s;
+  FILE* f = fopen(path, "rb");
+  if (!f) return s;
+  char b[256];
+  size_t n;
+  while ((n = fread(b, 1, sizeof b, f)) > 0) s.append(b, n);
+  fclose(f);
+  return s;
+}
+
+} // namespace
+
+TEST(memory_exporter_keeps_newest) {
+  MemoryExporter mem(2);
+  mem.exportRequest(OTelSignal::Logs, "/v1/logs", "a");
+  mem.exportRequest(OTelSignal::Metrics, "/v1/metrics", "bb");
+  mem.exportRequest(OTelSignal::Traces, "/v1/traces", "ccc");
+  CHECK_EQ(mem.size(), 2u);
+  CHECK(mem.at(0).payload == "bb");
+  CHECK(mem.at(1).signal == OTelSignal::Traces);
+  CHECK(mem.at(5).payload == "");
+  CHECK_EQ(mem.requests(), 3u);
+  CHECK_EQ(mem.bytes(), 6u);
+
+  mem.setResult(ExportResult::RetryableFailure);
+  CHECK(mem.exportRequest(OTelSignal::Logs, "/v1/logs", "d") == ExportResult::RetryableFailure);
+  mem.clear();
+  CHECK_EQ(mem.size(), 0u);
+}
+
+TEST(memory_exporter_counts_only) {
+  MemoryExporter mem(0);
+  mem.exportRequest(OTelSignal::Logs, "/v1/logs", "abcd");
+  CHECK_EQ(mem.size(), 0u);
+  CHECK_EQ(mem.bytes(), 4u);
+}
+
+TEST(serial_exporter_writes_lines) {
+  Capture out;
+  SerialExporter ser(out);
+  CHECK(ser.exportRequest(OTelSignal::Logs, "/v1/logs", "{\"a\":1}") == ExportResult::Success);
+  ser.exportRequest(OTelSignal::Logs, "/v1/logs", "{}");
+  CHECK(out.out == "{\"a\":1}\n{}\n");
+}
+
+TEST(file_exporter_json_lines) {
+  const char* path = "test_exporters_lines.jsonl";
+  remove(path);
+  fs::FS disk;
+  FileExporter file(disk, path);
+  CHECK(file.exportRequest(OTelSignal::Logs, "/v1/logs", "{\"x\":1}") == ExportResult::Success);
+  file.exportRequest(OTelSignal::Logs, "/v1/logs", "{\"x\":2}");
+  CHECK(readFile(path) == "{\"x\":1}\n{\"x\":2}\n");
+  remove(path);
+}
+
+TEST(file_exporter_length_delimited) {
+  const char* path = "test_exporters_framed.bin";
+  remove(path);
+  fs::FS disk;
+  FileExporter file(disk, path, FileExporter::Format::LengthDelimited);
+  const std::string big(300, 'z');  // needs a two-byte varint
+  file.exportRequest(OTelSignal::Logs, "/v1/logs", "{}");
+  file.exportRequest(OTelSignal::Logs, "/v1/logs", String(big));
+  const std::string got = readFile(path);
+  CHECK_EQ(got.size(), 1u + 2u + 2u + 300u);
+  CHECK_EQ((uint8_t)got[0], 2u);
+  CHECK(got.compare(1, 2, "{}") == 0);
+  CHECK_EQ((uint8_t)got[3], (300u & 0x7F) | 0x80);
+  CHECK_EQ((uint8_t)got[4], 300u >> 7);
+  CHECK(got.compare(5, std::string::npos, big) == 0);
+  remove(path);
+}
+
+TEST(file_exporter_unwritable_path_fails) {
+  fs::FS disk;
+  FileExporter file(disk, "no-such-dir/out.jsonl");
+  CHECK(file.exportRequest(OTelSignal::Logs, "/v1/logs", "{}") == ExportResult::Failure);
+}
+
+TEST(tcp_exporter_frames_and_reconnects) {
+  HostNet::reset();
+  TcpExporter tcp("relay", 4000);
+  CHECK(tcp.exportRequest(OTelSignal::Metrics, "/v1/metrics", "{}") == ExportResult::Success);
+  const std::string& s = HostNet::tcpSent();
+  CHECK_EQ(s.size(), 5u + 2u);
+  CHECK_EQ((uint8_t)s[3], 3u);  // body + signal byte
+  CHECK_EQ((uint8_t)s[4], (uint8_t)OTelSignal::Metrics);
+  CHECK(s.compare(5, 2, "{}") == 0);
+  tcp.exportRequest(OTelSignal::Metrics, "/v1/metrics", "{}");
+  CHECK_EQ(tcp.connects(), 1u);  // the connection is kept
+
+  TcpExporter down("relay", 4000);
+  HostNet::tcpRefuse() = true;
+  CHECK(down.exportRequest(OTelSignal::Logs, "/v1/logs", "{}") == ExportResult::RetryableFailure);
+  HostNet::reset();
+}
+
+TEST(udp_exporter_drops_only_oversize_records) {
+  HostNet::reset();
+  UdpExporter udp("relay", 4000, 64);
+  const String big = String("{\"body\":\"") + String(std::string(80, 'x')) + "\"}";
+  const String req = String("{\"resourceLogs\":[{\"a\":1},") + big + ",{\"b\":2}]}";
+  CHECK(udp.exportRequest(OTelSignal::Logs, "/v1/logs", req) == ExportResult::Success);
+  CHECK_EQ(udp.oversize(), 1u);
+  CHECK_EQ(udp.datagrams(), 2u);
+
+  const std::vector<std::string>& p = HostNet::udpPackets();
+  CHECK_EQ(p.size(), 2u);
+  if (p.size() == 2) {
+    CHECK(p[0].compare(5, std::string::npos, "{\"resourceLogs\":[{\"a\":1}]}") == 0);
+    CHECK(p[1].compare(5, std::string::npos, "{\"resourceLogs\":[{\"b\":2}]}") == 0);
+    CHECK_EQ((uint8_t)p[0][4], (uint8_t)OTelSignal::Logs);
+  }
+
+  // Nothing left to send
+  const String onlyBig = String("{\"resourceLogs\":[") + big + "]}";
+  CHECK(udp.exportRequest(OTelSignal::Logs, "/v1/logs", onlyBig) == ExportResult::Failure);
+  CHECK_EQ(udp.oversize(), 2u);
+  CHECK_EQ(HostNet::udpPackets().size(), 2u);
+  HostNet::reset();
+}
+
+TEST(fanout_succeeds_when_any_endpoint_accepts) {
+  Fixed ok(ExportResult::Success), down(ExportResult::RetryableFailure);
+  FanoutExporter fan{&down, &ok};
+  CHECK(fan.exportRequest(OTelSignal::Logs, "/v1/logs", "{}") == ExportResult::Success);
+  CHECK_EQ(down.calls, 1);
+  CHECK_EQ(ok.calls, 1);
+  CHECK(!fan.health(0).healthy);
+  CHECK_EQ(fan.health(1).successes, 1u);
+}
+
+TEST(fanout_retries_only_when_all_retryable) {
+  Fixed down1(ExportResult::RetryableFailure), down2(ExportResult::RetryableFailure);
+  Fixed reject(ExportResult::Failure);
+  FanoutExporter allDown{&down1, &down2};
+  CHECK(allDown.exportRequest(OTelSignal::Logs, "/v1/logs", "{}") == ExportResult::RetryableFailure);
+  FanoutExporter mixed{&down1, &reject};
+  CHECK(mixed.exportRequest(OTelSignal::Logs, "/v1/logs", "{}") == ExportResult::Failure);
+  FanoutExporter none{};
+  CHECK(none.exportRequest(OTelSignal::Logs, "/v1/logs", "{}") == ExportResult::Failure);
+}
+
+TEST(failover_skips_endpoints_until_their_backoff_expires) {
+  Scheduler::setClock(virtualClock);
+  Fixed a(ExportResult::RetryableFailure), b(ExportResult::Success), c(ExportResult::Success);
+  FailoverExporter fo({&a, &b, &c}, 1000);
+  auto send = [&](uint32_t t) {
+    s_now = t;
+    return fo.exportRequest(OTelSignal::Logs, "/v1/logs", "{}");
+  };
+
+  CHECK(send(0) == ExportResult::Success);
+  CHECK_EQ(a.calls, 1);
+  CHECK_EQ(fo.active(), 1);
+  CHECK(send(10) == ExportResult::Success);  // a is backing off
+  CHECK_EQ(a.calls, 1);
+  CHECK_EQ(b.calls, 2);
+
+  b.result = ExportResult::RetryableFailure;
+  CHECK(send(20) == ExportResult::Success);
+  CHECK_EQ(c.calls, 1);
+  CHECK_EQ(fo.active(), 2);
+
+  // c fails too: a and b are not retried while backing off
+  c.result = ExportResult::RetryableFailure;
+  CHECK(send(30) == ExportResult::RetryableFailure);
+  CHECK_EQ(a.calls, 1);
+  CHECK_EQ(b.calls, 3);
+  CHECK_EQ(c.calls, 2);
+
+  // All backing off: only the longest-failed endpoint is probed
+  CHECK(send(40) == ExportResult::RetryableFailure);
+  CHECK_EQ(a.calls, 2);
+  CHECK_EQ(b.calls, 3);
+  CHECK_EQ(c.calls, 2);
+
+  // b's backoff (from t=20) expires first and its probe succeeds
+  b.result = ExportResult::Success;
+  CHECK(send(1025) == ExportResult::Success);
+  CHECK_EQ(a.calls, 2);
+  CHECK_EQ(b.calls, 4);
+  CHECK_EQ(fo.active(), 1);
+  CHECK(fo.health(1).healthy);
+
+  // Once a's backoff (from t=40) expires the primary gets traffic back
+  a.result = ExportResult::Success;
+  CHECK(send(1039) == ExportResult::Success);
+  CHECK_EQ(a.calls, 2);
+  CHECK(send(1040) == ExportResult::Success);
+  CHECK_EQ(a.calls, 3);
+  CHECK_EQ(fo.active(), 0);
+  CHECK_EQ(fo.health(0).consecutiveFailures, 0u);
+
+  // A rejection is about the data: no failover
+  a.result = ExportResult::Failure;
+  CHECK(send(1050) == ExportResult::Failure);
+  CHECK_EQ(b.calls, 5);
+  CHECK(fo.health(0).healthy);
+  Scheduler::setClock(nullptr);
+}
+
+TEST(http_stream_sends_content_length_when_the_size_is_known) {
+  HostNet::reset();
+  HostNet::tcpResponse() = kKeepAlive;
+  HttpExporter http("http://collector:4318/otel/");
+  CHECK(http.streams());
+  CHECK(http.exportStream(OTelSignal::Traces, "/v1/traces", Text("{\"a\":1}")) == ExportResult::Success);
+  CHECK(HostNet::tcpSent() ==
+        "POST /otel/v1/traces HTTP/1.1\r\nHost: collector\r\n"
+        "Content-Type: application/json\r\nContent-Length: 7\r\n\r\n{\"a\":1}");
+  CHECK_EQ(http.lastStatus(), 200);
+  HostNet::reset();
+}
+
+TEST(http_stream_frames_unknown_sizes_as_chunks) {
+  HostNet::reset();
+  HostNet::tcpResponse() = kKeepAlive;
+  HttpExporter http("http://collector:4318");
+  const std::string head = "POST /v1/logs HTTP/1.1\r\nHost: collector\r\n"
+                           "Content-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n";
+  const size_t full = OTEL_STREAM_CHUNK_BYTES;
+  const std::string a(full, 'a'), b(full, 'b'), c(full / 4 + 3, 'c');
+  char size[16];
+  auto chunk = [&](const std::string& s) {
+    snprintf(size, sizeof(size), "%X\r\n", (unsigned)s.size());
+    return std::string(size) + s + "\r\n";
+  };
+
+  // Full buffers go out as they fill, the tail last, then the terminator
+  CHECK(http.exportStream(OTelSignal::Logs, "/v1/logs", Text(a + b + c, false)) == ExportResult::Success);
+  CHECK(HostNet::tcpSent() == head + chunk(a) + chunk(b) + chunk(c) + "0\r\n\r\n");
+
+  // An exact multiple of the buffer has no empty chunk before the terminator
+  HostNet::tcpSent().clear();
+  CHECK(http.exportStream(OTelSignal::Logs, "v1/logs", Text(a, false)) == ExportResult::Success);
+  CHECK(HostNet::tcpSent() == head + chunk(a) + "0\r\n\r\n");
+
+  // An empty body is only the terminator
+  HostNet::tcpSent().clear();
+  CHECK(http.exportStream(OTelSignal::Logs, "/v1/logs", Text("", false)) == ExportResult::Success);
+  CHECK(HostNet::tcpSent() == head + "0\r\n\r\n");
+  CHECK_EQ(http.connects(), 1u);
+  HostNet::reset();
+}
+
+TEST(http_stream_keeps_the_connection_only_after_a_drained_response) {
+  HostNet::reset();
+  HttpExporter http("http://collector:4318");
+  auto send = [&] { return http.exportStream(OTelSignal::Metrics, "/v1/metrics", Text("{}")); };
+
+  // The response body is read to its end, so the next status line is found
+  HostNet::tcpResponse() = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                           "Content-Length: 21\r\n\r\n{\"partialSuccess\":{}}";
+  CHECK(send() == ExportResult::Success);
+  CHECK(send() == ExportResult::Success);
+  CHECK_EQ(http.connects(), 1u);
+  CHECK_EQ(requests(HostNet::tcpSent()), 2);
+
+  // Connection: close, or no Content-Length, closes it after the response
+  HostNet::tcpResponse() = "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+  CHECK(send() == ExportResult::Success);  // still on the first connection
+  CHECK(send() == ExportResult::Success);
+  CHECK_EQ(http.connects(), 2u);
+  HostNet::tcpResponse() = HostNet::tcpOk();
+  CHECK(send() == ExportResult::Success);
+  CHECK(send() == ExportResult::Success);
+  CHECK_EQ(http.connects(), 4u);
+
+  // Errors are classified from the status line
+  HostNet::tcpResponse() = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n";
+  CHECK(send() == ExportResult::RetryableFailure);
+  HostNet::tcpResponse() = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+  CHECK(send() == ExportResult::Failure);
+  CHECK_EQ(http.lastStatus(), 400);
+  CHECK_EQ(http.connects(), 5u);
+  HostNet::reset();
+}
+
+TEST(http_resends_only_requests_that_were_not_written) {
+  HostNet::reset();
+  HostNet::tcpResponse() = kKeepAlive;
+  HttpExporter http("http://collector:4318");
+  CHECK(http.exportStream(OTelSignal::Logs, "/v1/logs", Text("{}")) == ExportResult::Success);
+  CHECK_EQ(http.connects(), 1u);
+
+  // The collector closed the idle connection: the write fails, and the
+  // request goes out once on a new connection
+  HostNet::tcpBroken() = true;
+  HostNet::tcpSent().clear();
+  CHECK(http.exportStream(OTelSignal::Logs, "/v1/logs", Text("{}")) == ExportResult::Success);
+  CHECK_EQ(http.connects(), 2u);
+  CHECK_EQ(requests(HostNet::tcpSent()), 1);
+
+  // No response on a reused connection: the request may have arrived, so it
+  // is left to the sender's retry
+  HostNet::tcpResponse() = "";
+  HostNet::tcpSent().clear();
+  CHECK(http.exportStream(OTelSignal::Logs, "/v1/logs", Text("{}")) == ExportResult::RetryableFailure);
+  CHECK_EQ(http.connects(), 2u);
+  CHECK_EQ(requests(HostNet::tcpSent()), 1);
+  CHECK(http.lastStatus() <= 0);
+  HostNet::reset();
+}
@@ -0,0 +1,144 @@
+// Flight recorder (built with OTEL_FLIGHT_RECORDER_BYTES=4096): spans and logs
+// encoded into the ring come back intact in the OTLP of a dump, the ring keeps
+// the newest records, and ERROR logs dump once per cooldown
+#include "otel_test.h"
+#include "OtelLogger.h"
+#include "OtelExporter.h"
+#include "OtelScheduler.h"
+#include <atomic>
+#include <vector>
+
+using namespace OTel;
+
+namespace {
+
+std::atomic<uint32_t> s_now{0};
+uint32_t virtualClock() { return s_now.load(); }
+
+otel_test::ExporterFixture exporter([] {
+  Scheduler::setClock(virtualClock);
+  CHECK(FlightRecorder::begin());
+});
+
+// Empty ring and exporter
+void start() {
+  exporter();
+  FlightRecorder::dump();
+  exporter.requests();
+}
+
+// Dump requests (those carrying the trigger attribute) sent since start()
+std::vector<String> dumped() {
+  std::vector<String> out;
+  for (const String& r : exporter.requests()) {
+    if (r.indexOf(String("flight_recorder.trigger")) >= 0) out.push_back(r);
+  }
+  return out;
+}
+
+String joined(const std::vector<String>& v) {
+  String all;
+  for (const String& s : v) all += s;
+  return all;
+}
+
+} // namespace
+
+TEST(span_round_trips) {
+  start();
+  CHECK(FlightRecorder::enabled());
+  String traceId, parentId, childId;
+  {
+    Span parent("parent");
+    traceId  = parent.traceId();
+    parentId = parent.spanId();
+    Span child("op");
+    childId = child.spanId();
+    child.setAttribute("count", (int64_t)42);
+    child.setAttribute("ok", true);
+    child.setAttribute("ratio", 1.5);
+    child.setAttribute("who", String("me"));
+    child.addEvent("evt");
+    child.setStatus(SpanStatus::Error, "boom");
+  }
+  CHECK_EQ(FlightRecorder::dump(), 2u);
+  CHECK_EQ(FlightRecorder::usedBytes(), 0u);
+
+  const String out = joined(dumped());
+  CHECK_CONTAINS(out, "\"stringValue\":\"manual\"");
+  CHECK_CONTAINS(out, (String("\"traceId\":\"") + traceId + "\"").c_str());
+  CHECK_CONTAINS(out, (String("\"spanId\":\"") + childId + "\",\"parentSpanId\":\"" + parentId + "\"").c_str());
+  CHECK_CONTAINS(out, "\"name\":\"op\"");
+  CHECK_CONTAINS(out, "\"key\":\"count\",\"value\":{\"intValue\":42}");
+  CHECK_CONTAINS(out, "\"key\":\"ok\",\"value\":{\"boolValue\":true}");
+  CHECK_CONTAINS(out, "\"key\":\"ratio\",\"value\":{\"doubleValue\":1.5}");
+  CHECK_CONTAINS(out, "\"key\":\"who\",\"value\":{\"stringValue\":\"me\"}");
+  CHECK_CONTAINS(out, "\"status\":{\"code\":2,\"message\":\"boom\"}");
+  CHECK_CONTAINS(out, "\"events\":[{\"timeUnixNano\":");
+  CHECK_CONTAINS(out, "\"name\":\"evt\"");
+}
+
+TEST(log_round_trips) {
+  start();
+  String traceId, spanId;
+  {
+    Span s("logging");
+    traceId = s.traceId();
+    spanId  = s.spanId();
+    Logger::logWarn("disk almost full", { { "mount", "/data" } });
+  }
+  CHECK_EQ(FlightRecorder::dump(), 2u);  // the log, then its span
+
+  const String out = joined(dumped());
+  CHECK_CONTAINS(out, "\"severityNumber\":13,\"severityText\":\"WARN\"");
+  CHECK_CONTAINS(out, "\"body\":{\"stringValue\":\"disk almost full\"}");
+  CHECK_CONTAINS(out, (String("\"traceId\":\"") + traceId + "\",\"spanId\":\"" + spanId + "\"").c_str());
+  CHECK_CONTAINS(out, "\"key\":\"mount\",\"value\":{\"stringValue\":\"/data\"}");
+}
+
+TEST(ring_keeps_the_newest_records) {
+  start();
+  const int n = 200;
+  for (int i = 0; i < n; ++i) Logger::logInfo(String("record ") + String(i) + ".");
+  CHECK(FlightRecorder::usedBytes() <= 4096u);
+
+  const size_t kept = FlightRecorder::dump();
+  CHECK(kept > 0 && kept < (size_t)n);
+  const String out = joined(dumped());
+  CHECK_CONTAINS(out, "\"record 199.\"");
+  CHECK(out.indexOf(String("\"record 0.\"")) < 0);
+  CHECK_CONTAINS(out, (String("\"record ") + String(n - (int)kept) + ".\"").c_str());
+  CHECK(out.indexOf(String("\"record ") + String(n - (int)kept - 1) + ".\"") < 0);
+}
+
+TEST(record_larger_than_the_ring_is_dropped) {
+  start();
+  Logger::logInfo("small");
+  const uint32_t dropped = FlightRecorder::droppedCount();
+  Logger::logInfo(String(std::string(5000, 'x')));
+  CHECK_EQ(FlightRecorder::droppedCount() - dropped, 1u);
+  CHECK_EQ(FlightRecorder::dump(), 1u);  // the earlier record survives
+}
+
+TEST(error_log_dumps_once_per_cooldown) {
+  start();
+  s_now = 100000;
+  Logger::logInfo("before");
+  Logger::logError("it broke");
+  std::vector<String> out = dumped();
+  CHECK_EQ(out.size(), 1u);
+  const String all = joined(out);
+  CHECK_CONTAINS(all, "\"stringValue\":\"error_log\"");
+  CHECK_CONTAINS(all, "\"before\"");
+  CHECK_CONTAINS(all, "\"it broke\"");
+
+  s_now = 100000 + OTEL_FLIGHT_RECORDER_COOLDOWN_MS - 1;
+  Logger::logError("again");
+  CHECK(dumped().empty());
+
+  s_now = 100000 + OTEL_FLIGHT_RECORDER_COOLDOWN_MS;
+  Logger::logError("later");
+  out = dumped();
+  CHECK_EQ(out.size(), 1u);
+  CHECK_CONTAINS(joined(out), "\"again\"");  // kept in the ring meanwhile
+}
@@ -0,0 +1,126 @@
+// ExponentialHistogram: bucket indices against log2, range limits at the
+// extremes of double, and merge() against recording everything in one place
+#include "otel_test.h"
+#include "OtelHistogram.h"
+#include <cmath>
+#include <vector>
+
+using namespace OTel;
+
+namespace {
+
+// Bucket i holds (2^(i/2^s), 2^((i+1)/2^s)], so i = ceil(log2(v) * 2^s) - 1
+int64_t referenceIndex(double v, int scale) {
+  return (int64_t)std::ceil(std::log2(v) * std::ldexp(1.0, scale)) - 1;
+}
+
+uint64_t bucketTotal(const ExponentialHistogram::Buckets& b) {
+  uint64_t n = 0;
+  for (size_t i = 0; i < b.size; ++i) n += b.at(i);
+  return n;
+}
+
+bool sameBuckets(const ExponentialHistogram::Buckets& a, const ExponentialHistogram::Buckets& b) {
+  if (a.size != b.size || (a.size && a.offset != b.offset)) return false;
+  for (size_t i = 0; i < a.size; ++i) if (a.at(i) != b.at(i)) return false;
+  return true;
+}
+
+void checkSame(const ExponentialHistogram& a, const ExponentialHistogram& b) {
+  CHECK_EQ(a.scale(), b.scale());
+  CHECK_EQ(a.count(), b.count());
+  CHECK_EQ(a.zeroCount(), b.zeroCount());
+  CHECK(a.sum() == b.sum());
+  CHECK(a.min() == b.min());
+  CHECK(a.max() == b.max());
+  CHECK(sameBuckets(a.positive(), b.positive()));
+  CHECK(sameBuckets(a.negative(), b.negative()));
+}
+
+} // namespace
+
+TEST(index_matches_log2_at_every_scale) {
+  const double values[] = { 1.5, 3, 10, 0.3, 1e-5, 12345.678, 7.25e-200, 3.3e250 };
+  for (int s = ExponentialHistogram::kMinScale; s <= 20; ++s) {
+    for (double v : values) {
+      CHECK_EQ(ExponentialHistogram::indexOf(v, s), referenceIndex(v, s));
+    }
+  }
+}
+
+TEST(powers_of_two_belong_to_the_bucket_below) {
+  for (int s = ExponentialHistogram::kMinScale; s <= 20; ++s) {
+    for (int k = -1074; k <= 1023; k += 7) {
+      const int64_t expected = (int64_t)std::ceil(k * std::ldexp(1.0, s)) - 1;
+      CHECK_EQ(ExponentialHistogram::indexOf(std::ldexp(1.0, k), s), expected);
+    }
+  }
+}
+
+TEST(subnormals_are_normalised) {
+  CHECK_EQ(ExponentialHistogram::indexOf(4.9e-324, 0), -1075);
+  CHECK_EQ(ExponentialHistogram::indexOf(std::ldexp(1.5, -1070), 0), -1070);
+  CHECK_EQ(ExponentialHistogram::indexOf(std::ldexp(1.5, -1070), 1), referenceIndex(std::ldexp(1.5, -1070), 1));
+  CHECK_EQ(ExponentialHistogram::indexOf(4.9e-324, 20), -1074LL * (1 << 20) - 1);
+}
+
+TEST(extreme_magnitudes_fit_the_bucket_range) {
+  ExponentialHistogram h;
+  CHECK_EQ(h.scale(), OTEL_EXPO_HISTOGRAM_MAX_SCALE);
+  h.record(4.9e-324);
+  h.record(1e308);
+
+  const ExponentialHistogram::Buckets& b = h.positive();
+  CHECK_EQ(h.count(), 2);
+  CHECK_EQ(bucketTotal(b), 2);
+  CHECK(b.size <= OTEL_EXPO_HISTOGRAM_MAX_BUCKETS);
+  CHECK(h.scale() >= ExponentialHistogram::kMinScale);
+  CHECK_EQ(ExponentialHistogram::indexOf(4.9e-324, h.scale()), b.offset);
+  CHECK_EQ(ExponentialHistogram::indexOf(1e308, h.scale()), b.offset + b.size - 1);
+  CHECK(h.min() == 4.9e-324);
+  CHECK(h.max() == 1e308);
+
+  // The same range on the negative side, recorded largest first
+  ExponentialHistogram n;
+  n.record(-1e308);
+  n.record(-4.9e-324);
+  CHECK_EQ(n.scale(), h.scale());
+  CHECK(sameBuckets(n.negative(), b));
+}
+
+TEST(merge_matches_direct_recording) {
+  std::vector<double> a, b;
+  for (int i = 1; i <= 40; ++i) a.push_back(i * 0.75);
+  for (int i = 1; i <= 40; ++i) b.push_back(-i * 1024.0);
+  b.push_back(0);
+  b.push_back(3e6);
+
+  ExponentialHistogram ha, hb, direct;
+  for (double v : a) { ha.record(v); direct.record(v); }
+  for (double v : b) { hb.record(v); direct.record(v); }
+  // 0.75 and 3e6 share the positive side only after merging, so merge() has
+  // to go coarser than either input
+  CHECK(ha.scale() > direct.scale());
+  CHECK(hb.scale() > direct.scale());
+
+  ha.merge(hb);
+  checkSame(ha, direct);
+}
+
+TEST(merge_of_extremes_matches_direct_recording) {
+  ExponentialHistogram tiny, huge, direct;
+  tiny.record(4.9e-324);
+  huge.record(1e308);
+  direct.record(4.9e-324);
+  direct.record(1e308);
+
+  // Both still at the finest scale: the combined range only shows in merge()
+  CHECK_EQ(tiny.scale(), OTEL_EXPO_HISTOGRAM_MAX_SCALE);
+  CHECK_EQ(huge.scale(), OTEL_EXPO_HISTOGRAM_MAX_SCALE);
+  tiny.merge(huge);
+  checkSame(tiny, direct);
+
+  ExponentialHistogram empty;
+  empty.merge(direct);
+  checkSame(empty, direct);
+}
@@ -0,0 +1,71 @@
+// Worker and flush hooks (built with the flight recorder so every built-in
+// subsystem is present): the tables fit all of them with room to spare, and a
+// subsystem that finds them full falls back or stays off
+#include "otel_test.h"
+#include "OtelLogger.h"
+#include "OtelMetrics.h"
+#include "OtelIsrEvents.h"
+#include "OtelTraceAssembly.h"
+#include "OtelExporter.h"
+#include <vector>
+
+using namespace OTel;
+
+namespace {
+
+otel_test::ExporterFixture exporter;
+
+std::vector<HeldSpans> s_sent;
+void collect(HeldSpans& spans) { s_sent.push_back(spans); }
+
+template <int N> void app() {}
+void (*const kApp[])() = { app<0>, app<1>, app<2>, app<3>, app<4>, app<5>, app<6>, app<7> };
+
+// Registers application hooks until the table is full; returns how many fit
+size_t fill(bool (*add)(void (*)())) {
+  size_t n = 0;
+  for (void (*fn)() : kApp) {
+    if (!add(fn)) break;
+    ++n;
+  }
+  return n;
+}
+
+} // namespace
+
+TEST(builtin_hooks_leave_room_for_the_application) {
+  exporter();
+  // Every built-in except trace assembly and the flight recorder, which the
+  // next tests start against full tables: four worker hooks and three flush
+  // hooks (deferred logs have none)
+  Logger::logf("INFO", "boot %d", 1);
+  Logger::setDedupWindow(1000);
+  Metrics::histogram("hooks.test", 1.0);
+  enableIsrEventDrain();
+  CHECK(LogDedup::window() == 1000u);
+
+  CHECK_EQ(fill(OTelSender::addWorkerHook), (size_t)(OTEL_WORKER_MAX_HOOKS - OTEL_BUILTIN_WORKER_HOOKS + 2));
+  CHECK_EQ(fill(OTelSender::addFlushHook),  (size_t)(OTEL_WORKER_MAX_HOOKS - OTEL_BUILTIN_WORKER_HOOKS + 3));
+  CHECK(OTelSender::addWorkerHook(app<0>));  // already registered
+}
+
+TEST(full_table_turns_trace_assembly_off) {
+  exporter();
+  s_sent.clear();
+  TraceAssembly::setEnabled(true);
+  TraceAssembly::hold("t1", String("{\"n\":1}"), collect);
+  CHECK(!TraceAssembly::enabled());
+  CHECK_EQ(s_sent.size(), 1u);  // sent right away, not held
+  if (s_sent.size() == 1) CHECK(s_sent[0].size() == 1 && s_sent[0][0] == "{\"n\":1}");
+  HeldSpans held;
+  TraceAssembly::release("t1", held);
+  CHECK(held.empty());
+}
+
+TEST(full_table_keeps_the_flight_recorder_off) {
+  exporter();
+  CHECK(!FlightRecorder::begin());
+  CHECK(!FlightRecorder::enabled());
+  Logger::logInfo("not recorded");
+  CHECK_EQ(FlightRecorder::usedBytes(), 0u);
+}
@@ -0,0 +1,103 @@
+// ISR instruments: exact totals when threads on both host "cores" record while
+// the exporter side takes deltas, and the merged delta in the OTLP output
+#include "otel_test.h"
+#include "OtelIsrMetrics.h"
+#include "OtelMetrics.h"
+#include "OtelExporter.h"
+#include <freertos/FreeRTOS.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace OTel;
+
+namespace {
+
+const uint32_t kBounds[] = { 10, 100, 1000 };
+
+IsrCounter   g_stressCount("stress.count");
+IsrHistogram g_stressHist("stress.hist", kBounds, "us");
+IsrCounter   g_exportCount("export.count");
+IsrHistogram g_exportHist("export.hist", kBounds, "us");
+
+const int kThreads   = 8;  // four per core
+const int kPerThread = 100000;
+
+// Value recorded by `thread` at step `i`: spreads over every bucket
+uint32_t sample(int thread, int i) { return (uint32_t)((thread * 7919 + i * 31) % 2000); }
+
+otel_test::ExporterFixture exporter([] {
+  Metrics::setExportInterval(0);  // the test is the only collector
+});
+
+} // namespace
+
+TEST(concurrent_records_are_counted_exactly) {
+  exporter();
+  std::atomic<int> running{kThreads};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([t, &running] {
+      hostCoreId() = t % 2;
+      for (int i = 0; i < kPerThread; ++i) {
+        g_stressCount.add();
+        g_stressHist.record(sample(t, i));
+      }
+      running.fetch_sub(1);
+    });
+  }
+
+  // The exporter side takes deltas while the producers run
+  uint64_t counted = 0, histCount = 0, histSum = 0;
+  uint64_t buckets[IsrHistogram::kMaxBuckets] = {};
+  auto take = [&] {
+    counted += g_stressCount.takeDelta();
+    const IsrHistogram::Delta d = g_stressHist.takeDelta();
+    histCount += d.count;
+    histSum   += d.sum;
+    for (size_t i = 0; i <= g_stressHist.nBounds(); ++i) buckets[i] += d.buckets[i];
+  };
+  while (running.load() > 0) take();
+  for (auto& th : threads) th.join();
+  take();
+
+  uint64_t expectSum = 0;
+  uint64_t expectBuckets[IsrHistogram::kMaxBuckets] = {};
+  for (int t = 0; t < kThreads; ++t) {
+    for (int i = 0; i < kPerThread; ++i) {
+      const uint32_t v = sample(t, i);
+      size_t b = 0;
+      while (b < 3 && v > kBounds[b]) ++b;
+      ++expectBuckets[b];
+      expectSum += v;
+    }
+  }
+  CHECK_EQ(counted, (uint64_t)kThreads * kPerThread);
+  CHECK_EQ(histCount, (uint64_t)kThreads * kPerThread);
+  CHECK_EQ(histSum, expectSum);
+  for (size_t i = 0; i <= 3; ++i) CHECK_EQ(buckets[i], expectBuckets[i]);
+}
+
+TEST(collection_exports_the_merged_delta) {
+  exporter.exported();
+
+  std::thread core1([] {
+    hostCoreId() = 1;
+    for (int i = 0; i < 300; ++i) g_exportCount.add(2);
+    g_exportHist.record(5000);
+  });
+  for (int i = 0; i < 100; ++i) g_exportCount.add();
+  g_exportHist.record(7);
+  core1.join();
+
+  const String all = exporter.exported();  // collects once
+  CHECK_CONTAINS(all, "\"export.count\"");
+  CHECK_CONTAINS(all, "\"asInt\":\"700\"");
+  CHECK_CONTAINS(all, "\"bucketCounts\":[\"1\",\"0\",\"0\",\"1\"]");
+  CHECK_CONTAINS(all, "\"explicitBounds\":[10,100,1000]");
+
+  // Nothing new since: no point for either instrument
+  const String again = exporter.exported();
+  CHECK(again.indexOf(String("export.count")) < 0);
+  CHECK(again.indexOf(String("export.hist")) < 0);
+}
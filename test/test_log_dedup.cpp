@@ -0,0 +1,139 @@
+// Log dedup: window matching, expiry and eviction on a virtual clock, and the
+// summary record Logger sends for the counted repeats
+#include "otel_test.h"
+#include "OtelLogger.h"
+#include "OtelExporter.h"
+#include "OtelScheduler.h"
+#include <vector>
+
+using namespace OTel;
+
+namespace {
+
+uint32_t s_now = 0;
+uint32_t virtualClock() { return s_now; }
+
+std::vector<LogRepeats> s_closed;
+void collect(const LogRepeats& r) { s_closed.push_back(r); }
+
+const std::map<String, String> kNone;
+
+// Empty table, window `ms`, clock at `t`
+void startAt(uint32_t t, uint32_t ms = 1000) {
+  Scheduler::setClock(virtualClock);
+  s_now = t;
+  LogDedup::setWindow(ms);
+  LogDedup::expire(true, nullptr);
+  s_closed.clear();
+}
+
+void first(const char* templ, const std::map<String, String>& labels = kNone, int sev = 9) {
+  LogDedup::remember("INFO", sev, templ, templ, labels, "trace", "span", collect);
+}
+
+otel_test::ExporterFixture exporter;
+
+using otel_test::count;
+
+} // namespace
+
+TEST(repeats_inside_the_window_are_counted) {
+  startAt(100);
+  const uint32_t suppressed = LogDedup::suppressedCount();
+  CHECK(!LogDedup::repeat(9, "boot", kNone, 1));  // never seen: sent
+  first("boot");
+  CHECK(LogDedup::repeat(9, "boot", kNone, 10));
+  s_now = 600;
+  CHECK(LogDedup::repeat(9, "boot", kNone, 20));
+  CHECK(LogDedup::repeat(9, "boot", kNone, 30));
+  CHECK_EQ(LogDedup::suppressedCount() - suppressed, 3u);
+
+  s_now = 1099;
+  CHECK_EQ(LogDedup::expire(false, collect), 0u);
+  s_now = 1100;
+  CHECK_EQ(LogDedup::expire(false, collect), 1u);
+  CHECK_EQ(s_closed.size(), 1u);
+  if (s_closed.size() == 1) {
+    const LogRepeats& r = s_closed[0];
+    CHECK_EQ(r.count, 3u);
+    CHECK_EQ(r.firstNs, 10u);
+    CHECK_EQ(r.lastNs, 30u);
+    CHECK(r.message == "boot");
+    CHECK(strcmp(r.traceId, "trace") == 0);
+    CHECK(strcmp(r.spanId, "span") == 0);
+  }
+  // The window is closed: the next occurrence is sent again
+  CHECK(!LogDedup::repeat(9, "boot", kNone, 40));
+}
+
+TEST(severity_template_and_attributes_key_the_window) {
+  startAt(0);
+  first("read %d", { { "bus", "i2c" } });
+  CHECK(LogDedup::repeat(9, "read %d", { { "bus", "i2c" } }, 1));
+  CHECK(!LogDedup::repeat(13, "read %d", { { "bus", "i2c" } }, 1));
+  CHECK(!LogDedup::repeat(9, "read %u", { { "bus", "i2c" } }, 1));
+  CHECK(!LogDedup::repeat(9, "read %d", { { "bus", "spi" } }, 1));
+  CHECK(!LogDedup::repeat(9, "read %d", kNone, 1));
+}
+
+TEST(window_without_repeats_produces_no_summary) {
+  startAt(0);
+  first("quiet");
+  s_now = 5000;
+  CHECK_EQ(LogDedup::expire(false, collect), 0u);
+  CHECK(s_closed.empty());
+}
+
+TEST(reopening_an_ended_window_reports_it) {
+  startAt(0);
+  first("tick");
+  CHECK(LogDedup::repeat(9, "tick", kNone, 5));
+  s_now = 1000;
+  CHECK(!LogDedup::repeat(9, "tick", kNone, 6));  // ended, not yet expired
+  first("tick");
+  CHECK_EQ(s_closed.size(), 1u);
+  if (!s_closed.empty()) CHECK_EQ(s_closed[0].count, 1u);
+  CHECK(LogDedup::repeat(9, "tick", kNone, 7));   // the new window counts
+}
+
+TEST(full_table_evicts_the_oldest_window) {
+  startAt(0);
+  first("oldest");
+  CHECK(LogDedup::repeat(9, "oldest", kNone, 1));
+  for (int i = 1; i < OTEL_LOG_DEDUP_SLOTS; ++i) {
+    s_now = (uint32_t)i;
+    first((String("other ") + String(i)).c_str());
+  }
+  CHECK(s_closed.empty());
+  s_now = 100;
+  first("newcomer");
+  CHECK_EQ(s_closed.size(), 1u);
+  if (!s_closed.empty()) CHECK(s_closed[0].message == "oldest");
+  CHECK(!LogDedup::repeat(9, "oldest", kNone, 2));
+  CHECK(LogDedup::repeat(9, "newcomer", kNone, 2));
+}
+
+TEST(disabled_window_counts_nothing) {
+  startAt(0, 0);
+  first("off");
+  CHECK(!LogDedup::repeat(9, "off", kNone, 1));
+}
+
+TEST(logger_sends_one_summary_per_window) {
+  exporter();
+  startAt(0);
+  exporter.exported();
+  Logger::setDedupWindow(1000);
+  for (int i = 0; i < 5; ++i) Logger::logWarn("disk almost full", { { "mount", "/data" } });
+  Logger::logWarn("disk almost full", { { "mount", "/logs" } });
+
+  // flush() closes every open window
+  const String out = exporter.exported();
+  CHECK_EQ(count(out, "disk almost full"), 3);
+  CHECK_EQ(count(out, "log.repeat_count"), 1);
+  const int at = out.indexOf(String("log.repeat_count"));
+  CHECK(at >= 0 && out.substring(at, at + 60).indexOf(String("\"4\"")) >= 0);
+
+  Logger::setDedupWindow(0);
+  Scheduler::setClock(nullptr);
+}
@@ -0,0 +1,135 @@
+// Metrics: Views, aggregated series and their exemplars
+#include "otel_test.h"
+#include "OtelMetrics.h"
+#include "OtelExporter.h"
+
+using namespace OTel;
+
+namespace {
+
+otel_test::ExporterFixture exporter([] {
+  Metrics::setExportInterval(0);  // collect only on flush() / collect()
+});
+
+using otel_test::count;
+using otel_test::metricJson;
+
+} // namespace
+
+TEST(aggregated_sum_keeps_exemplars_per_interval) {
+  exporter();
+  MetricView v;
+  v.instrument  = "ex.sum";
+  v.aggregation = MetricAggregation::Sum;
+  CHECK(Metrics::addView(v));
+  exporter.exported();
+
+  Metrics::sum("ex.sum", 1, true);  // outside a span: no exemplar
+  {
+    Span s("work");
+    for (int i = 0; i < 10; ++i) Metrics::sum("ex.sum", 1, true);
+  }
+  String out = metricJson(exporter.exported(), "ex.sum");
+  CHECK_CONTAINS(out, "\"asDouble\":11");
+  CHECK_EQ(count(out, "\"exemplars\""), 1);
+  CHECK_EQ(count(out, "\"spanId\""), OTEL_EXEMPLAR_RESERVOIR_SIZE);
+
+  // Next interval: the cumulative value stays, the exemplars do not
+  Metrics::sum("ex.sum", 1, true);
+  out = metricJson(exporter.exported(), "ex.sum");
+  CHECK_CONTAINS(out, "\"asDouble\":12");
+  CHECK_EQ(count(out, "\"exemplars\""), 0);
+}
+
+TEST(histogram_series_offer_exemplars) {
+  exporter.exported();
+  {
+    Span s("timed");
+    Metrics::histogram("ex.latency", 4.5, "ms");
+  }
+  const String out = metricJson(exporter.exported(), "ex.latency");
+  CHECK_CONTAINS(out, "exponentialHistogram");
+  CHECK_EQ(count(out, "\"spanId\""), 1);
+  CHECK_CONTAINS(out, "\"asDouble\":4.5");
+}
+
+TEST(per_call_points_carry_their_measurement) {
+  exporter.exported();
+  {
+    Span s("reading");
+    Metrics::gauge("ex.gauge", 7);
+  }
+  Metrics::gauge("ex.gauge.nospan", 8);
+  const String out = exporter.exported();
+  CHECK_EQ(count(metricJson(out, "ex.gauge"), "\"exemplars\""), 1);
+  CHECK_EQ(count(metricJson(out, "ex.gauge.nospan"), "\"exemplars\""), 0);
+}
+
+TEST(reservoir_is_bounded_and_sampled_only) {
+  ExemplarReservoir<2> res;
+  res.offer(1);
+  CHECK_EQ(res.size(), 0u);
+  {
+    Span s("y");
+    for (int i = 0; i < 1000; ++i) res.offer(i);
+  }
+  CHECK_EQ(res.size(), 2u);
+  res.reset();
+  CHECK_EQ(res.size(), 0u);
+}
+
+namespace {
+bool s_bigObservable = false;
+} // namespace
+
+TEST(collect_splits_large_batches) {
+  MemoryExporter& m = exporter();
+  static bool registered = Metrics::createObservableGauge("split.obs", "1", [](ObservableResult& r) {
+    if (!s_bigObservable) return;
+    // Past the cardinality limit these fold into the overflow series, which
+    // still exports one point per observation
+    for (int i = 0; i < 400; ++i) r.observe(i, { { "slot", String(i).c_str() } });
+  });
+  CHECK(registered);
+  exporter.exported();
+
+  const uint32_t oversize = OTelSender::oversizeCount();
+  s_bigObservable = true;
+  const size_t points = Metrics::collect();
+  s_bigObservable = false;
+  OTelSender::flush(1000);
+
+  CHECK(points >= 400);
+  CHECK(m.size() > 1);
+  int observed = 0;
+  for (size_t i = 0; i < m.size(); ++i) {
+    const String p = m.at(i).payload;
+    CHECK(p.length() <= OTEL_MAX_REQUEST_BYTES);
+    // A batched payload may hold several requests, each naming the metric again
+    for (int at = p.indexOf("\"split.obs\""); at >= 0; at = p.indexOf("\"split.obs\"", at + 1)) {
+      observed += count(metricJson(p.substring(at - 8), "split.obs"), "\"asDouble\"");
+    }
+  }
+  CHECK_EQ(observed, 400);
+  CHECK_EQ(OTelSender::oversizeCount(), oversize);
+  m.clear();
+}
+
+// Last: fills the instrument table for the rest of the process
+TEST(untracked_instruments_use_the_overflow_series) {
+  exporter.exported();
+  for (int i = 0; i < OTEL_METRIC_MAX_INSTRUMENTS; ++i) {
+    Metrics::gauge(String("cap.fill.") + String(i), 1);
+  }
+  exporter.exported();
+
+  const uint32_t before = Metrics::overflowCount();
+  for (int i = 0; i < 5; ++i) {
+    Metrics::gauge("cap.untracked", i, "", { { "request.id", String(i) } });
+  }
+  const String out = exporter.exported();
+  CHECK_EQ(count(out, "\"cap.untracked\""), 5);
+  CHECK_EQ(count(out, "request.id"), 0);
+  CHECK_EQ(count(out, "otel.metric.overflow"), 5);
+  CHECK_EQ(Metrics::overflowCount() - before, 5);
+}
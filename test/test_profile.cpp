@@ -0,0 +1,94 @@
+// Profile sites: per-interval deltas merged over both host "cores", min/max
+// restarting at each snapshot, and the otel.profile.duration point
+#include "otel_test.h"
+#include "OtelProfile.h"
+#include "OtelMetrics.h"
+#include "OtelExporter.h"
+#include <freertos/FreeRTOS.h>
+#include <thread>
+
+using namespace OTel;
+
+namespace {
+
+ProfileSite g_deltaSite("delta.site");
+ProfileSite g_exportSite("export.site");
+
+otel_test::ExporterFixture exporter([] {
+  Metrics::setExportInterval(0);  // the test is the only collector
+});
+
+void recordOnCore1(ProfileSite& site, uint32_t a, uint32_t b) {
+  std::thread core1([&site, a, b] {
+    hostCoreId() = 1;
+    site.record(a);
+    site.record(b);
+  });
+  core1.join();
+}
+
+} // namespace
+
+TEST(snapshot_returns_the_interval_since_the_last_one) {
+  exporter();
+  g_deltaSite.record(100);
+  g_deltaSite.record(50);
+  g_deltaSite.record(300);
+  recordOnCore1(g_deltaSite, 20, 500);
+
+  ProfileSample s = g_deltaSite.snapshot(1000);
+  CHECK_EQ(s.calls, 5u);
+  CHECK_EQ(s.ticks, 970u);
+  CHECK(s.hasRange);
+  CHECK_EQ(s.minTicks, 20u);
+  CHECK_EQ(s.maxTicks, 500u);
+  CHECK_EQ(s.startNs, 0u);
+
+  // The next interval's min/max start over on both cores
+  g_deltaSite.record(200);
+  recordOnCore1(g_deltaSite, 250, 210);
+  s = g_deltaSite.snapshot(2000);
+  CHECK_EQ(s.calls, 3u);
+  CHECK_EQ(s.ticks, 660u);
+  CHECK_EQ(s.minTicks, 200u);
+  CHECK_EQ(s.maxTicks, 250u);
+  CHECK_EQ(s.startNs, 1000u);
+
+  s = g_deltaSite.snapshot(3000);
+  CHECK_EQ(s.calls, 0u);
+  CHECK_EQ(s.ticks, 0u);
+  CHECK(!s.hasRange);
+  CHECK_EQ(s.startNs, 2000u);
+}
+
+TEST(sites_are_listed_once) {
+  exporter();
+  int delta = 0, exported = 0;
+  g_exportSite.record(1);
+  g_exportSite.record(1);
+  for (ProfileSite* p = ProfileSite::first(); p; p = p->next()) {
+    if (p == &g_deltaSite)  ++delta;
+    if (p == &g_exportSite) ++exported;
+  }
+  CHECK_EQ(delta, 1);
+  CHECK_EQ(exported, 1);
+  g_exportSite.snapshot(0);
+}
+
+TEST(collection_exports_one_delta_point_per_site) {
+  exporter.exported();
+  const double perUs = profileTicksPerUs();
+  g_exportSite.record((uint32_t)(1 * perUs));
+  g_exportSite.record((uint32_t)(10 * perUs));
+  const String all = exporter.exported();  // collects once
+  CHECK_CONTAINS(all, "\"name\":\"otel.profile.duration\",\"unit\":\"us\"");
+  CHECK_CONTAINS(all, "\"aggregationTemporality\":1");
+  CHECK_CONTAINS(all, "\"count\":\"2\",\"sum\":11");
+  CHECK_CONTAINS(all, "\"min\":1,\"max\":10");
+  CHECK_CONTAINS(all, "\"key\":\"code.function\",\"value\":{\"stringValue\":\"export.site\"}");
+  CHECK(all.indexOf(String("delta.site")) < 0);  // no calls this interval
+
+  // Nothing new since: no point
+  const String again = exporter.exported();
+  CHECK(again.indexOf(String("export.site")) < 0);
+}
@@ -0,0 +1,103 @@
+// Context propagation: W3C traceparent/tracestate, B3 single and the JSON
+// member scan, on known-good and known-bad inputs
+#include "otel_test.h"
+#include "OtelTracer.h"
+
+using namespace OTel;
+
+namespace {
+const char* kTp = "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01";
+
+bool tp(const char* s, RawTraceContext& r) { return parseTraceparent(s, strlen(s), r); }
+bool b3(const char* s, RawTraceContext& r) { return parseB3Single(s, strlen(s), r); }
+bool json(const char* s, RawTraceContext& r) { return Propagators::extractFromJson(s, strlen(s), r); }
+} // namespace
+
+TEST(traceparent_valid) {
+  RawTraceContext r;
+  CHECK(tp(kTp, r));
+  CHECK(r.sampled());
+  CHECK(!strcmp(r.traceId, "0af7651916cd43dd8448eb211c80319c"));
+  CHECK(!strcmp(r.spanId, "b7ad6b7169203331"));
+  CHECK(tp("01-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-00-more", r));
+  CHECK(!r.sampled());
+}
+
+TEST(traceparent_rejects) {
+  RawTraceContext r;
+  CHECK(!tp("00-0AF7651916CD43DD8448EB211C80319C-b7ad6b7169203331-01", r));  // uppercase
+  CHECK(!tp("00-00000000000000000000000000000000-b7ad6b7169203331-01", r));  // zero trace
+  CHECK(!tp("00-0af7651916cd43dd8448eb211c80319c-0000000000000000-01", r));  // zero span
+  CHECK(!tp("ff-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01", r));  // forbidden version
+  CHECK(!tp("00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01-x", r)); // v00 is fixed size
+  CHECK(!tp("01-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01x", r));
+  CHECK(!tp("00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331", r));
+  CHECK(!parseTraceparent(nullptr, 55, r));
+}
+
+TEST(b3_single) {
+  RawTraceContext r;
+  CHECK(b3("80f198ee56343ba864fe8b2a57d3eff7-e457b5a2e4d86bd1-1-05e3ac9a4f6e3b90", r));
+  CHECK(r.sampled());
+  CHECK(b3("e457b5a2e4d86bd1-e457b5a2e4d86bd1", r));
+  CHECK(!r.sampled());
+  CHECK(!strncmp(r.traceId, "0000000000000000e457b5a2e4d86bd1", 32));  // left-padded
+  CHECK(b3("e457b5a2e4d86bd1-e457b5a2e4d86bd1-d", r));
+  CHECK(r.sampled());
+  CHECK(!b3("1", r));
+  CHECK(!b3("e457b5a2e4d86bd1-e457b5a2e4d86bd1-", r));
+  CHECK(!b3("e457b5a2e4d86bd1-e457b5a2e4d86bd1-x", r));
+  CHECK(!b3("e457b5a2e4d86bd1-e457b5a2e4d86bd1-1-05e3", r));
+}
+
+TEST(tracestate_trim_and_truncate) {
+  RawTraceContext r;
+  const char* ts = " \trojo=00f067aa0ba902b7,congo=t61rcWkgMzE ";
+  CHECK(setTracestate(ts, strlen(ts), r));
+  CHECK(!strcmp(r.tracestate, "rojo=00f067aa0ba902b7,congo=t61rcWkgMzE"));
+  CHECK(!setTracestate("a=\x01", 3, r));
+  CHECK_EQ(r.tracestateLen, 0u);
+
+  std::string lng;
+  for (int i = 0; i < 100; ++i) lng += "k" + std::to_string(i) + "=vvvvvv,";
+  CHECK(setTracestate(lng.data(), lng.size(), r));
+  CHECK(r.tracestateLen <= OTEL_TRACESTATE_MAX_LEN);
+  CHECK(r.tracestate[r.tracestateLen - 1] != ',');
+  CHECK(lng[r.tracestateLen] == ',');  // cut on a member boundary
+}
+
+TEST(json_scan_members) {
+  const char* j = "{ \"a\" : [1,{\"b\":\"]\"}], \"c\":\"x\\\"y\", \"d\":true }";
+  std::string keys;
+  CHECK(json_scan::forEachMember(j, strlen(j),
+    [&](const char* k, size_t kn, const char*, size_t, bool) {
+      keys.append(k, kn);
+      return true;
+    }));
+  CHECK(keys == "ad");  // "c" has an escape and is skipped
+  CHECK(json_scan::forEachMember("{}", 2, [](const char*, size_t, const char*, size_t, bool) { return true; }));
+  CHECK(!json_scan::forEachMember("{\"a\":", 5, [](const char*, size_t, const char*, size_t, bool) { return true; }));
+  CHECK(!json_scan::forEachMember("[1]", 3, [](const char*, size_t, const char*, size_t, bool) { return true; }));
+}
+
+TEST(extract_from_json_precedence) {
+  RawTraceContext r;
+  CHECK(json("{\"x\":{\"a\":[1,\"}\"]},\"traceparent\":\"00-0af7651916cd43dd8448eb211c80319c-"
+             "b7ad6b7169203331-00\",\"tracestate\":\"k=v,a=b\",\"b3\":\"e457b5a2e4d86bd1-e457b5a2e4d86bd1\"}", r));
+  CHECK(!r.sampled());
+  CHECK(!strcmp(r.spanId, "b7ad6b7169203331"));
+  CHECK(!strcmp(r.tracestate, "k=v,a=b"));
+
+  CHECK(json("{ \"trace_id\" : \"0af7651916cd43dd8448eb211c80319c\", \"span_id\":\"b7ad6b7169203331\", \"trace_flags\": 0 }", r));
+  CHECK(!r.sampled());
+  CHECK(json("{\"trace_id\":\"0af7651916cd43dd8448eb211c80319c\",\"span_id\":\"b7ad6b7169203331\"}", r));
+  CHECK(r.sampled());
+  CHECK(json("{\"b3\":\"e457b5a2e4d86bd1-e457b5a2e4d86bd1-1\"}", r));
+  CHECK(!json("{\"traceparent\":\"00-bad\"", r));
+  CHECK(!json("{\"other\":1}", r));
+
+  const ExtractedContext ec = Propagators::extractFromJson(String(
+      "{\"traceparent\":\"00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01\"}"));
+  CHECK(ec.valid());
+  CHECK(ec.sampled);
+}
@@ -0,0 +1,197 @@
+// Scheduler: the timer wheel on a virtual clock, and the sender's retry
+// backoff driven through it with OTelSender::service()
+#include "otel_test.h"
+#include "OtelScheduler.h"
+#include "OtelExporter.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace OTel;
+
+namespace {
+
+uint32_t    s_now = 0;
+std::string s_fired;  // ids of fired timers, in order
+
+uint32_t virtualClock() { return s_now; }
+
+void record(void* ctx) { s_fired += (char)(intptr_t)ctx; }
+
+void startAt(uint32_t t) {
+  s_now = t;
+  s_fired.clear();
+  Scheduler::setClock(virtualClock);
+  Scheduler::setAlignment(0);
+  Scheduler::reset();
+}
+
+int timer(char id) { return Scheduler::create(record, (void*)(intptr_t)id); }
+
+// Advance the clock in `step` increments up to `to`, ticking at each one
+void runUntil(uint32_t to, uint32_t step = OTEL_SCHED_TICK_MS) {
+  while ((int32_t)(to - s_now) > 0) {
+    s_now += ((int32_t)(to - s_now) < (int32_t)step) ? to - s_now : step;
+    Scheduler::tick();
+  }
+}
+
+} // namespace
+
+TEST(deadlines_fire_in_order) {
+  startAt(1000);
+  const int c = timer('c'), a = timer('a'), b = timer('b'), d = timer('d');
+  Scheduler::armAfter(c, 300);
+  Scheduler::armAfter(a, 15);
+  Scheduler::armAfter(b, 120);
+  Scheduler::armAfter(d, 120);  // same slot as b
+  CHECK_EQ(Scheduler::msUntilNext(1000), 15u);
+
+  s_now = 1014;
+  CHECK_EQ(Scheduler::tick(), 0u);
+  s_now = 1015;
+  CHECK_EQ(Scheduler::tick(), 1u);
+  runUntil(1119);
+  CHECK(s_fired == "a");
+  runUntil(1400);
+  CHECK_EQ(s_fired.size(), 4u);
+  CHECK(s_fired[0] == 'a' && s_fired[3] == 'c');
+  CHECK(!Scheduler::armed(b) && !Scheduler::armed(c));
+  CHECK_EQ(Scheduler::msUntilNext(777), 777u);
+}
+
+TEST(rearm_and_cancel) {
+  startAt(0);
+  const int a = timer('a'), b = timer('b');
+  Scheduler::armAfter(a, 50);
+  Scheduler::armAfter(a, 500);  // replaces the first deadline
+  Scheduler::armAfter(b, 50);
+  Scheduler::cancel(b);
+  runUntil(499);
+  CHECK(s_fired.empty());
+  runUntil(500);
+  CHECK(s_fired == "a");
+}
+
+TEST(deadline_beyond_one_wheel_turn) {
+  startAt(5);
+  const uint32_t turn = OTEL_SCHED_TICK_MS * OTEL_SCHED_WHEEL_SLOTS;
+  const int a = timer('a');
+  Scheduler::armAfter(a, 2 * turn + 25);  // passes its slot twice before it is due
+  runUntil(5 + 2 * turn + 24);
+  CHECK(s_fired.empty());
+  runUntil(5 + 2 * turn + 25);
+  CHECK(s_fired == "a");
+}
+
+TEST(late_tick_catches_up_once) {
+  startAt(0);
+  const uint32_t turn = OTEL_SCHED_TICK_MS * OTEL_SCHED_WHEEL_SLOTS;
+  const int a = timer('a'), b = timer('b');
+  Scheduler::armAfter(a, 30);
+  Scheduler::armAfter(b, turn - 10);
+  s_now = 5 * turn;  // asleep for several turns
+  CHECK_EQ(Scheduler::tick(), 2u);
+  CHECK_EQ(Scheduler::tick(), 0u);
+}
+
+TEST(clock_wraparound) {
+  startAt(0xFFFFFF00u);
+  const int a = timer('a'), p = timer('p');
+  Scheduler::armAfter(a, 0x180);  // due at 0x80, after the wrap
+  Scheduler::armEvery(p, 100);
+  runUntil(0x7F, 1);
+  CHECK(s_fired.find('a') == std::string::npos);
+  CHECK_EQ(std::count(s_fired.begin(), s_fired.end(), 'p'), 3);
+  runUntil(0x80, 1);
+  CHECK(s_fired.find('a') != std::string::npos);
+}
+
+TEST(periodic_skips_missed_periods) {
+  startAt(0);
+  const int p = timer('p');
+  Scheduler::armEvery(p, 100);
+  runUntil(1000);
+  CHECK_EQ(s_fired.size(), 10u);
+  s_now = 1550;  // five periods missed
+  CHECK_EQ(Scheduler::tick(), 1u);
+  CHECK_EQ(Scheduler::msUntilNext(1000), 100u);  // next at 1650, not 1100
+  Scheduler::cancel(p);
+  CHECK(!Scheduler::armed(p));
+}
+
+TEST(aligned_radio_windows) {
+  startAt(1010);
+  Scheduler::setAlignment(250);
+  const int a = timer('a'), b = timer('b'), c = timer('c');
+  Scheduler::armAfter(a, 10);   // 1020 -> 1250
+  Scheduler::armAfter(b, 200);  // 1210 -> 1250
+  Scheduler::armAfter(c, 260);  // 1270 -> 1500
+  CHECK_EQ(Scheduler::msUntilNext(10000), 240u);
+  runUntil(1249, 1);
+  CHECK(s_fired.empty());
+  s_now = 1250;
+  CHECK_EQ(Scheduler::tick(), 2u);  // one wake-up for both
+  runUntil(1499, 1);
+  CHECK_EQ(s_fired.size(), 2u);
+  runUntil(1500, 1);
+  CHECK_EQ(s_fired.size(), 3u);
+  Scheduler::setAlignment(0);
+}
+
+namespace {
+int s_sibling = Scheduler::kInvalidTimer;
+void cancelSibling(void*) { s_fired += 'x'; Scheduler::cancel(s_sibling); }
+} // namespace
+
+TEST(callback_cancels_sibling_in_same_tick) {
+  startAt(0);
+  const int x = Scheduler::create(cancelSibling);
+  s_sibling   = timer('y');
+  Scheduler::armAfter(s_sibling, 20);
+  Scheduler::armAfter(x, 10);
+  s_now = 30;
+  Scheduler::tick();
+  CHECK(s_fired == "x");
+}
+
+namespace {
+
+// Fails retryably and notes the virtual time of every attempt
+struct Unreachable : Exporter {
+  std::vector<uint32_t> attempts;
+  ExportResult exportRequest(OTelSignal, const char*, const String&) override {
+    attempts.push_back(s_now);
+    return ExportResult::RetryableFailure;
+  }
+};
+
+} // namespace
+
+// Runs last: the sender keeps its batch timers on the wheel
+TEST(retry_backoff_doubles) {
+  startAt(10000);
+  Unreachable down;
+  OTelSender::setExporter(OTelSignal::Logs, &down);
+  OTelSender::service();  // loop()-driven mode: sends queue for service()
+
+  JsonDocument doc;
+  doc["resourceLogs"].to<JsonArray>().add<JsonObject>()["x"] = 1;
+  OTelSender::sendJson("/v1/logs", doc);
+  const uint32_t failuresBefore = OTelSender::exportFailures();
+
+  // Batched first, then sent when the batch delay expires
+  OTelSender::service();
+  const uint32_t sent = s_now + OTEL_BATCH_DELAY_MS;
+  for (uint32_t end = sent + (OTEL_RETRY_BASE_MS << OTEL_RETRY_MAX) * 2; s_now < end;) {
+    s_now += OTEL_SCHED_TICK_MS;
+    OTelSender::service();
+  }
+
+  CHECK_EQ(down.attempts.size(), 1u + OTEL_RETRY_MAX);
+  CHECK_EQ(down.attempts[0], sent);
+  for (size_t i = 1; i < down.attempts.size(); ++i) {
+    CHECK_EQ(down.attempts[i] - down.attempts[i - 1], (uint32_t)OTEL_RETRY_BASE_MS << (i - 1));
+  }
+  CHECK_EQ(OTelSender::exportFailures(), failuresBefore + 1);
+}
@@ -0,0 +1,164 @@
+// Sender queue: overflow policies on the per-signal lanes, and flush() and
+// shutdown() deadlines on a virtual clock, driven from the test thread through
+// OTelSender::service() (no background worker)
+#include "otel_test.h"
+#include "OtelExporter.h"
+#include "OtelScheduler.h"
+#include <vector>
+
+using namespace OTel;
+
+namespace {
+
+otel_test::ExporterFixture exporter([] {
+  OTelSender::service();  // loop()-driven mode: sends queue until service()
+});
+
+void sendLog(int n, OTelPriority priority) {
+  JsonDocument doc;
+  doc["resourceLogs"].to<JsonArray>().add<JsonObject>()["n"] = n;
+  OTelSender::sendJson("/v1/logs", doc, priority);
+}
+
+// One record on each signal's path: three requests
+void sendEachSignal() {
+  JsonDocument doc;
+  doc["resourceSpans"].to<JsonArray>().add<JsonObject>()["n"] = 1;
+  OTelSender::sendJson("/v1/traces", doc);
+  sendLog(2, OTelPriority::Normal);
+  JsonDocument metrics;
+  metrics["resourceMetrics"].to<JsonArray>().add<JsonObject>()["n"] = 3;
+  OTelSender::sendJson("/v1/metrics", metrics);
+}
+
+uint32_t s_now = 0;
+uint32_t virtualClock() { return s_now; }
+
+// Every request takes `costMs` of virtual time, then lands in exporter()
+struct Slow : Exporter {
+  uint32_t costMs;
+  explicit Slow(uint32_t ms) : costMs(ms) {}
+  ExportResult exportRequest(OTelSignal signal, const char* path, const String& payload) override {
+    s_now += costMs;
+    return exporter().exportRequest(signal, path, payload);
+  }
+};
+
+// The "n" of every exported log record, in export order
+std::vector<int> exportedOrder() {
+  std::vector<int> out;
+  for (const String& p : exporter.requests()) {
+    for (int at = p.indexOf("\"n\":"); at >= 0; at = p.indexOf("\"n\":", at + 1)) {
+      out.push_back((int)p.substring(at + 4).toInt());
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+TEST(priority_eviction_keeps_arrival_order) {
+  exporter();
+  OTelSender::setQueuePolicy(OTelQueuePolicy::Priority);
+  const int room = OTEL_QUEUE_CAPACITY_LOGS - 1;
+  for (int i = 0; i < room; ++i) {
+    const OTelPriority p = i == 0 ? OTelPriority::High
+                         : (i == 1 || i == 3) ? OTelPriority::Low : OTelPriority::Normal;
+    sendLog(i, p);
+  }
+  const uint32_t lowDrops = OTelSender::droppedCount(OTelSignal::Logs, OTelPriority::Low);
+  sendLog(100, OTelPriority::Normal);  // evicts 1
+  sendLog(101, OTelPriority::High);    // evicts 3
+  sendLog(102, OTelPriority::Normal);  // evicts 2, the oldest Normal
+  sendLog(103, OTelPriority::Low);     // ranks below everything queued: rejected
+  CHECK_EQ(OTelSender::droppedCount(OTelSignal::Logs, OTelPriority::Low), lowDrops + 3);
+
+  std::vector<int> want = { 0 };
+  for (int i = 4; i < room; ++i) want.push_back(i);
+  want.push_back(100);
+  want.push_back(101);
+  want.push_back(102);
+  const std::vector<int> got = exportedOrder();
+  CHECK_EQ(got.size(), want.size());
+  CHECK(got == want);
+  OTelSender::setQueuePolicy(OTelQueuePolicy::DropNewest);
+}
+
+TEST(drop_oldest_and_drop_newest) {
+  exporter();
+  const int room = OTEL_QUEUE_CAPACITY_LOGS - 1;
+
+  OTelSender::setQueuePolicy(OTelQueuePolicy::DropOldest);
+  for (int i = 0; i < room + 2; ++i) sendLog(i, OTelPriority::Normal);
+  std::vector<int> got = exportedOrder();
+  CHECK_EQ(got.size(), (size_t)room);
+  CHECK(!got.empty() && got.front() == 2 && got.back() == room + 1);
+
+  OTelSender::setQueuePolicy(OTelQueuePolicy::DropNewest);
+  for (int i = 0; i < room + 2; ++i) sendLog(i, OTelPriority::Normal);
+  got = exportedOrder();
+  CHECK_EQ(got.size(), (size_t)room);
+  CHECK(!got.empty() && got.front() == 0 && got.back() == room - 1);
+}
+
+TEST(flush_leaves_what_misses_its_deadline_queued) {
+  exporter.requests();
+  MemoryExporter& m = exporter();
+  Scheduler::setClock(virtualClock);
+  s_now = 10000;
+  Slow slow(100);
+  OTelSender::setExporter(&slow);
+
+  // The second request ends past the deadline, so the third is not started
+  sendEachSignal();
+  OTelFlushResult r = OTelSender::flush(150);
+  CHECK(!r.complete);
+  CHECK_EQ(r.delivered, 2u);
+  CHECK_EQ(r.abandoned, 1u);
+  CHECK_EQ(m.size(), 2u);
+
+  r = OTelSender::flush(1000);
+  CHECK(r.complete);
+  CHECK_EQ(r.delivered, 1u);
+  CHECK_EQ(r.abandoned, 0u);
+  CHECK_EQ(m.size(), 3u);
+
+  m.clear();
+  OTelSender::setExporter(&m);
+  Scheduler::setClock(nullptr);
+}
+
+// Last: nothing can be sent after shutdown()
+TEST(shutdown_discards_what_is_left_and_drops_later_sends) {
+  exporter.requests();
+  MemoryExporter& m = exporter();
+  Scheduler::setClock(virtualClock);
+  s_now = 20000;
+  Slow slow(100);
+  OTelSender::setExporter(&slow);
+
+  // Batched (service() moved them out of the queue) and still queued
+  sendEachSignal();
+  OTelSender::service();
+  CHECK_EQ(m.size(), 0u);
+  sendLog(4, OTelPriority::Normal);
+  sendLog(5, OTelPriority::Normal);
+
+  // No time to send anything: all five are discarded
+  const OTelFlushResult r = OTelSender::shutdown(0);
+  CHECK(!r.complete);
+  CHECK_EQ(r.delivered, 0u);
+  CHECK_EQ(r.abandoned, 5u);
+  CHECK_EQ(m.size(), 0u);
+
+  const uint32_t drops = OTelSender::droppedCount(OTelSignal::Logs, OTelPriority::Normal);
+  sendLog(6, OTelPriority::Normal);
+  CHECK_EQ(OTelSender::droppedCount(OTelSignal::Logs, OTelPriority::Normal), drops + 1);
+  const OTelFlushResult after = OTelSender::flush(1000);
+  CHECK(after.complete);
+  CHECK_EQ(after.delivered, 0u);
+  CHECK_EQ(m.size(), 0u);
+
+  OTelSender::setExporter(&m);
+  Scheduler::setClock(nullptr);
+}
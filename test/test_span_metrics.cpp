@@ -0,0 +1,101 @@
+// Span metrics: calls and duration per (span name, status) for sampled and
+// unsampled spans, and the Span::setStatus() rules they are keyed on
+#include "otel_test.h"
+#include "OtelMetrics.h"
+#include "OtelExporter.h"
+#include <stdlib.h>
+
+using namespace OTel;
+
+namespace {
+
+otel_test::ExporterFixture exporter([] {
+  Metrics::setExportInterval(0);  // collect only on flush()
+  CHECK(Metrics::enableSpanMetrics());
+});
+
+using otel_test::metricJson;
+
+// The data point of `metric` for one (span name, status code), or ""
+String point(const String& metric, const char* span, const char* status) {
+  const String key = String("\"stringValue\":\"") + span +
+                     "\"}},{\"key\":\"status.code\",\"value\":{\"stringValue\":\"" + status + "\"}";
+  const String start("{\"startTimeUnixNano\"");
+  for (int at = metric.indexOf(start); at >= 0; ) {
+    const int next = metric.indexOf(start, at + 1);
+    const String p = next < 0 ? metric.substring(at) : metric.substring(at, next);
+    if (p.indexOf(key) >= 0) return p;
+    at = next;
+  }
+  return String();
+}
+
+double number(const String& p, const char* field) {
+  const int at = p.indexOf(String("\"") + field + "\":");
+  return at < 0 ? -1 : atof(p.c_str() + at + strlen(field) + 3);
+}
+
+// Ends a span named `name` with `status` under a remote parent that was not sampled
+void unsampled(const char* name, SpanStatus status) {
+  TraceContext remote;
+  remote.traceId = "0123456789abcdef0123456789abcdef";
+  remote.spanId  = "0123456789abcdef";
+  remote.sampled = false;
+  RemoteParentScope scope(remote);
+  Span s(name);
+  s.setStatus(status);
+}
+
+} // namespace
+
+TEST(calls_and_duration_per_name_and_status) {
+  exporter.exported();
+  { Span s("read"); s.setStatus(SpanStatus::Ok); delay(3); }
+  unsampled("read", SpanStatus::Ok);
+  { Span s("read"); s.setStatus(SpanStatus::Error, "i2c nack"); }
+  { Span s("read"); }
+  unsampled("write", SpanStatus::Error);
+
+  const String out = exporter.exported();
+  const String calls = metricJson(out, "traces.span.metrics.calls");
+  CHECK_CONTAINS(calls, "\"isMonotonic\":true");
+  CHECK_EQ(number(point(calls, "read", "STATUS_CODE_OK"), "asDouble"), 2);
+  CHECK_EQ(number(point(calls, "read", "STATUS_CODE_ERROR"), "asDouble"), 1);
+  CHECK_EQ(number(point(calls, "read", "STATUS_CODE_UNSET"), "asDouble"), 1);
+  CHECK_EQ(number(point(calls, "write", "STATUS_CODE_ERROR"), "asDouble"), 1);
+  CHECK(point(calls, "write", "STATUS_CODE_OK").length() == 0);
+
+  const String duration = metricJson(out, "traces.span.metrics.duration");
+  CHECK_CONTAINS(duration, "\"unit\":\"ms\"");
+  const String ok = point(duration, "read", "STATUS_CODE_OK");
+  CHECK_CONTAINS(ok, "\"count\":\"2\"");
+  CHECK(number(ok, "sum") >= 3);
+  CHECK(number(ok, "max") >= 3);
+  CHECK_CONTAINS(point(duration, "read", "STATUS_CODE_ERROR"), "\"count\":\"1\"");
+  CHECK_CONTAINS(point(duration, "write", "STATUS_CODE_ERROR"), "\"count\":\"1\"");
+}
+
+TEST(ok_is_final_and_error_keeps_its_message) {
+  exporter.exported();
+  {
+    Span s("commit");
+    s.setStatus(SpanStatus::Ok, "dropped");  // Ok carries no message
+    s.setStatus(SpanStatus::Error, "too late");
+  }
+  {
+    Span s("fetch");
+    s.setStatus(SpanStatus::Error, "timeout");
+    s.setStatus(SpanStatus::Unset);          // ignored
+  }
+  const String out = exporter.exported();
+  CHECK_CONTAINS(out, "\"name\":\"commit\"");
+  CHECK_CONTAINS(out, "\"status\":{\"code\":1}");
+  CHECK(out.indexOf(String("too late")) < 0 && out.indexOf(String("dropped")) < 0);
+  CHECK_CONTAINS(out, "\"status\":{\"code\":2,\"message\":\"timeout\"}");
+
+  const String calls = metricJson(out, "traces.span.metrics.calls");
+  CHECK_EQ(number(point(calls, "commit", "STATUS_CODE_OK"), "asDouble"), 1);
+  CHECK(point(calls, "commit", "STATUS_CODE_ERROR").length() == 0);
+  CHECK_EQ(number(point(calls, "fetch", "STATUS_CODE_ERROR"), "asDouble"), 1);
+  CHECK(point(calls, "fetch", "STATUS_CODE_UNSET").length() == 0);
+}
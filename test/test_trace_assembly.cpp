@@ -0,0 +1,177 @@
+// Trace assembly: whole local traces in one request, and the budget, timeout
+// and eviction paths that send held spans early (on a virtual clock)
+#include "otel_test.h"
+#include "OtelTracer.h"
+#include "OtelExporter.h"
+#include "OtelScheduler.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace OTel;
+
+namespace {
+
+std::atomic<uint32_t> s_now{0};
+uint32_t virtualClock() { return s_now.load(); }
+
+// The worker may expire traces too, so the sink is shared
+std::mutex                       s_sentMutex;
+std::vector<std::vector<String>> s_sent;
+void collect(HeldSpans& spans) {
+  std::lock_guard<std::mutex> lock(s_sentMutex);
+  s_sent.push_back(spans);
+}
+std::vector<std::vector<String>> sent() {
+  std::lock_guard<std::mutex> lock(s_sentMutex);
+  std::vector<std::vector<String>> out;
+  out.swap(s_sent);
+  return out;
+}
+
+otel_test::ExporterFixture exporter([] { Scheduler::setClock(virtualClock); });
+
+using otel_test::count;
+
+int at(const String& s, const char* name) { return s.indexOf(String("\"name\":\"") + name + "\""); }
+
+} // namespace
+
+TEST(local_trace_is_sent_in_one_request) {
+  exporter.requests();
+  Tracer::setTraceAssembly(true);
+  {
+    Span root("root");
+    { Span a("a"); { Span b("b"); } }
+    { Span c("c"); }
+  }
+  const std::vector<String> out = exporter.requests();
+  CHECK_EQ(out.size(), 1u);
+  if (out.size() == 1) {
+    const String& p = out[0];
+    CHECK_EQ(count(p, "\"spanId\""), 4);
+    // Held children in the order they ended, then the root
+    CHECK(at(p, "b") < at(p, "a"));
+    CHECK(at(p, "a") < at(p, "c"));
+    CHECK(at(p, "c") < at(p, "root"));
+  }
+  Tracer::setTraceAssembly(false);
+}
+
+TEST(remote_parent_still_assembles_the_local_part) {
+  exporter.requests();
+  Tracer::setTraceAssembly(true);
+  TraceContext remote;
+  remote.traceId = "0123456789abcdef0123456789abcdef";
+  remote.spanId  = "0123456789abcdef";
+  {
+    RemoteParentScope scope(remote);
+    Span server("server");
+    { Span db("db"); }
+  }
+  const std::vector<String> out = exporter.requests();
+  CHECK_EQ(out.size(), 1u);
+  if (out.size() == 1) {
+    CHECK_EQ(count(out[0], "\"spanId\""), 2);
+    CHECK_CONTAINS(out[0], "\"parentSpanId\":\"0123456789abcdef\"");
+  }
+  Tracer::setTraceAssembly(false);
+}
+
+TEST(budget_sends_held_spans_early) {
+  exporter.requests();
+  Tracer::setTraceAssembly(true);
+  const String pad(std::string(80, 'x'));
+  {
+    Span root("big");
+    for (int i = 0; i < 60; ++i) {
+      Span child("child");
+      child.setAttribute("pad", pad);
+    }
+  }
+  const std::vector<String> out = exporter.requests();
+  CHECK(out.size() > 1);
+  int spans = 0;
+  for (const String& p : out) {
+    spans += count(p, "\"spanId\"");
+    CHECK(p.length() <= OTEL_MAX_REQUEST_BYTES);
+  }
+  CHECK_EQ(spans, 61);
+  Tracer::setTraceAssembly(false);
+}
+
+TEST(flush_sends_the_children_of_an_open_root) {
+  exporter.requests();
+  Tracer::setTraceAssembly(true);
+  Span* root = new Span("runaway");
+  { Span child("child"); }
+  std::vector<String> out = exporter.requests();
+  CHECK_EQ(out.size(), 1u);
+  if (!out.empty()) CHECK(at(out[0], "child") >= 0 && at(out[0], "runaway") < 0);
+
+  delete root;
+  out = exporter.requests();
+  CHECK_EQ(out.size(), 1u);
+  if (!out.empty()) CHECK_EQ(count(out[0], "\"spanId\""), 1);
+  Tracer::setTraceAssembly(false);
+}
+
+TEST(release_returns_held_spans_in_order) {
+  exporter();
+  TraceAssembly::expire(true);
+  sent();
+  TraceAssembly::hold("t1", String("{\"n\":1}"), collect);
+  TraceAssembly::hold("t1", String("{\"n\":2}"), collect);
+  HeldSpans held;
+  TraceAssembly::release("t1", held);
+  CHECK_EQ(held.size(), 2u);
+  if (held.size() == 2) CHECK(held[0] == "{\"n\":1}" && held[1] == "{\"n\":2}");
+
+  HeldSpans none;
+  TraceAssembly::release("t1", none);  // forgotten
+  CHECK(none.empty());
+  CHECK(sent().empty());
+}
+
+TEST(timed_out_traces_are_sent) {
+  exporter();
+  TraceAssembly::expire(true);
+  sent();
+  s_now = 1000;
+  TraceAssembly::hold("slow", String("{\"n\":1}"), collect);
+  s_now = 1000 + OTEL_TRACE_ASSEMBLY_TIMEOUT_MS - 1;
+  TraceAssembly::expire(false);
+  CHECK(sent().empty());
+
+  s_now = 1000 + OTEL_TRACE_ASSEMBLY_TIMEOUT_MS;
+  TraceAssembly::expire(false);
+  const std::vector<std::vector<String>> out = sent();
+  CHECK_EQ(out.size(), 1u);
+  if (out.size() == 1) CHECK_EQ(out[0].size(), 1u);
+
+  HeldSpans held;
+  TraceAssembly::release("slow", held);  // the slot was freed
+  CHECK(held.empty());
+}
+
+TEST(new_trace_evicts_the_oldest) {
+  exporter();
+  TraceAssembly::expire(true);
+  sent();
+  for (int i = 0; i < OTEL_TRACE_ASSEMBLY_SLOTS; ++i) {
+    s_now = 2000 + (uint32_t)i;
+    TraceAssembly::hold(String("t") + String(i), String("{\"t\":") + String(i) + "}", collect);
+  }
+  CHECK(sent().empty());
+  s_now = 2100;
+  TraceAssembly::hold("newest", String("{\"t\":9}"), collect);
+  const std::vector<std::vector<String>> out = sent();
+  CHECK_EQ(out.size(), 1u);
+  if (out.size() == 1 && out[0].size() == 1) CHECK(out[0][0] == "{\"t\":0}");
+
+  HeldSpans held;
+  TraceAssembly::release("newest", held);
+  CHECK_EQ(held.size(), 1u);
+  TraceAssembly::expire(true);
+  CHECK_EQ(sent().size(), (size_t)OTEL_TRACE_ASSEMBLY_SLOTS - 1);
+}